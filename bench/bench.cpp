@@ -0,0 +1,191 @@
+/* 
+   EN: Benchmark runner for the host build of rStrings
+   RU: Запуск замеров производительности rStrings на хосте
+   --------------------------
+   Usage: rstrings_bench [--checks] [--min-ms N] [filter...]
+     (the TZ environment variable is respected, by default a zone with DST rules is used)
+     --checks  - run self-checks only
+     --min-ms  - minimal measurement time per case, milliseconds (default 200)
+     filter    - run only cases whose name contains one of the given substrings
+*/
+
+#include "bench.h"
+#include <atomic>
+#include <chrono>
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <vector>
+
+// -----------------------------------------------------------------------------------------------------------------------
+// ------------------------------------------------ Heap call counters ---------------------------------------------------
+// -----------------------------------------------------------------------------------------------------------------------
+
+static std::atomic<uint64_t> _mallocs(0);
+static std::atomic<uint64_t> _frees(0);
+static std::atomic<uint64_t> _bytes(0);
+
+extern "C" {
+  void* __real_malloc(size_t size);
+  void* __real_calloc(size_t count, size_t size);
+  void* __real_realloc(void* ptr, size_t size);
+  void  __real_free(void* ptr);
+
+  void* __wrap_malloc(size_t size)
+  {
+    _mallocs.fetch_add(1, std::memory_order_relaxed);
+    _bytes.fetch_add(size, std::memory_order_relaxed);
+    return __real_malloc(size);
+  }
+
+  void* __wrap_calloc(size_t count, size_t size)
+  {
+    _mallocs.fetch_add(1, std::memory_order_relaxed);
+    _bytes.fetch_add(count * size, std::memory_order_relaxed);
+    return __real_calloc(count, size);
+  }
+
+  void* __wrap_realloc(void* ptr, size_t size)
+  {
+    _mallocs.fetch_add(1, std::memory_order_relaxed);
+    _bytes.fetch_add(size, std::memory_order_relaxed);
+    return __real_realloc(ptr, size);
+  }
+
+  void __wrap_free(void* ptr)
+  {
+    if (ptr) _frees.fetch_add(1, std::memory_order_relaxed);
+    __real_free(ptr);
+  }
+}
+
+namespace bench {
+
+HeapCounters heapCounters()
+{
+  HeapCounters ret;
+  ret.mallocs = _mallocs.load(std::memory_order_relaxed);
+  ret.frees = _frees.load(std::memory_order_relaxed);
+  ret.bytes = _bytes.load(std::memory_order_relaxed);
+  return ret;
+}
+
+// -----------------------------------------------------------------------------------------------------------------------
+// ---------------------------------------------------- Registry ---------------------------------------------------------
+// -----------------------------------------------------------------------------------------------------------------------
+
+struct CaseItem {
+  const char* name;
+  CaseFunc func;
+};
+
+struct CheckItem {
+  const char* name;
+  CheckFunc func;
+};
+
+static std::vector<CaseItem>& cases() { static std::vector<CaseItem> items; return items; }
+static std::vector<CheckItem>& checks() { static std::vector<CheckItem> items; return items; }
+
+Registrar::Registrar(const char* name, CaseFunc func) { cases().push_back({name, func}); }
+Registrar::Registrar(const char* name, CheckFunc func) { checks().push_back({name, func}); }
+
+bool fail(const char* check, const char* format, ...)
+{
+  va_list args;
+  va_start(args, format);
+  fprintf(stderr, "CHECK FAILED [%s]: ", check);
+  vfprintf(stderr, format, args);
+  fprintf(stderr, "\n");
+  va_end(args);
+  return false;
+}
+
+} // namespace bench
+
+// -----------------------------------------------------------------------------------------------------------------------
+// ----------------------------------------------------- Runner ----------------------------------------------------------
+// -----------------------------------------------------------------------------------------------------------------------
+
+static bool matchFilter(const char* name, const std::vector<const char*>& filters)
+{
+  if (filters.empty()) return true;
+  for (const char* filter: filters) {
+    if (strstr(name, filter)) return true;
+  };
+  return false;
+}
+
+static double runCase(bench::CaseFunc func, uint64_t iterations, bench::HeapCounters* heap, uint64_t* bytes)
+{
+  bench::State state(iterations);
+  bench::HeapCounters before = bench::heapCounters();
+  auto start = std::chrono::steady_clock::now();
+  func(state);
+  auto stop = std::chrono::steady_clock::now();
+  bench::HeapCounters after = bench::heapCounters();
+  heap->mallocs = after.mallocs - before.mallocs;
+  heap->frees = after.frees - before.frees;
+  heap->bytes = after.bytes - before.bytes;
+  *bytes = state.bytesProcessed();
+  return std::chrono::duration<double, std::nano>(stop - start).count();
+}
+
+int main(int argc, char** argv)
+{
+  bool checksOnly = false;
+  double minNs = 200e6;
+  std::vector<const char*> filters;
+  for (int i = 1; i < argc; i++) {
+    if (strcmp(argv[i], "--checks") == 0) {
+      checksOnly = true;
+    } else if ((strcmp(argv[i], "--min-ms") == 0) && (i + 1 < argc)) {
+      minNs = atof(argv[++i]) * 1e6;
+    } else {
+      filters.push_back(argv[i]);
+    };
+  };
+
+  // Time zone with DST rules, so that localtime_r does real work as on a device
+  setenv("TZ", "EET-2EEST,M3.5.0/3,M10.5.0/4", 0);
+  tzset();
+
+  // Self-checks always run first: a fast but wrong kernel is not a result
+  int failed = 0;
+  for (const bench::CheckItem& item: bench::checks()) {
+    if (!matchFilter(item.name, filters) && !checksOnly) continue;
+    bool ok = item.func();
+    printf("check %-48s %s\n", item.name, ok ? "ok" : "FAILED");
+    if (!ok) failed++;
+  };
+  if (failed > 0) {
+    fprintf(stderr, "%d self-check(s) failed\n", failed);
+    return 1;
+  };
+  if (checksOnly) return 0;
+
+  printf("%-48s %12s %12s %10s %10s %10s\n", "benchmark", "iterations", "ns/op", "malloc/op", "bytes/op", "MB/s");
+  for (const bench::CaseItem& item: bench::cases()) {
+    if (!matchFilter(item.name, filters)) continue;
+    bench::HeapCounters heap;
+    uint64_t bytes;
+    // Calibrate: grow the iteration count until the case runs long enough
+    uint64_t iterations = 1;
+    double ns = runCase(item.func, iterations, &heap, &bytes);
+    while (ns < minNs && iterations < (1ULL << 40)) {
+      double scale = (ns > 0) ? (minNs / ns) * 1.2 : 100.0;
+      if (scale > 100.0) scale = 100.0;
+      if (scale < 2.0) scale = 2.0;
+      iterations = (uint64_t)(iterations * scale);
+      ns = runCase(item.func, iterations, &heap, &bytes);
+    };
+    double perOp = ns / iterations;
+    double mbs = (bytes > 0) ? (double)bytes * iterations / (ns / 1e9) / 1e6 : 0.0;
+    printf("%-48s %12llu %12.1f %10.2f %10.1f %10.1f\n", item.name, (unsigned long long)iterations, perOp,
+      (double)heap.mallocs / iterations, (double)heap.bytes / iterations, mbs);
+    fflush(stdout);
+  };
+  return 0;
+}
@@ -0,0 +1,72 @@
+/* 
+   EN: Minimal benchmark harness for the host build of rStrings
+   RU: Минимальный набор инструментов для замеров производительности rStrings на хосте
+   --------------------------
+   Every case reports ns/op, malloc calls/op and bytes/op. Heap calls are counted by wrapping
+   malloc/calloc/realloc/free at link time (-Wl,--wrap=...), so only rStrings and bench code is seen.
+*/
+
+#ifndef __R_STRINGS_BENCH_H__
+#define __R_STRINGS_BENCH_H__
+
+#include <stddef.h>
+#include <stdint.h>
+
+namespace bench {
+
+// Heap counters, updated by the link-time malloc wrappers
+struct HeapCounters {
+  uint64_t mallocs;
+  uint64_t frees;
+  uint64_t bytes;
+};
+HeapCounters heapCounters();
+
+class State {
+  public:
+    explicit State(uint64_t iterations): _left(iterations), _total(iterations) {};
+    // Returns true while the case should run one more iteration
+    inline bool next() { return _left-- > 0; };
+    inline uint64_t iterations() const { return _total; };
+    // Optional: amount of payload bytes processed per iteration (reported as MB/s)
+    inline void setBytesProcessed(uint64_t bytes) { _bytes = bytes; };
+    inline uint64_t bytesProcessed() const { return _bytes; };
+  private:
+    uint64_t _left;
+    uint64_t _total;
+    uint64_t _bytes = 0;
+};
+
+typedef void (*CaseFunc)(State& state);
+typedef bool (*CheckFunc)();
+
+// Registration of benchmarks and self-checks (run before any benchmark)
+struct Registrar {
+  Registrar(const char* name, CaseFunc func);
+  Registrar(const char* name, CheckFunc func);
+};
+
+// Prevents the compiler from optimizing away a computed value
+template <typename T>
+inline void doNotOptimize(T const& value) { asm volatile("" : : "r,m"(value) : "memory"); }
+inline void clobberMemory() { asm volatile("" : : : "memory"); }
+
+// Reports a failed self-check with a reason
+bool fail(const char* check, const char* format, ...) __attribute__((format(printf, 2, 3)));
+
+} // namespace bench
+
+#define BENCH_CONCAT_(a, b) a##b
+#define BENCH_CONCAT(a, b) BENCH_CONCAT_(a, b)
+
+#define BENCH(name) \
+  static void name(bench::State& state); \
+  static bench::Registrar BENCH_CONCAT(bench_reg_, name)(#name, name); \
+  static void name(bench::State& state)
+
+#define BENCH_CHECK(name) \
+  static bool name(); \
+  static bench::Registrar BENCH_CONCAT(bench_chk_, name)(#name, name); \
+  static bool name()
+
+#endif // __R_STRINGS_BENCH_H__
@@ -0,0 +1,75 @@
+/* 
+   EN: Allocator backend and allocation statistics
+   RU: Подключаемый распределитель памяти и статистика выделений
+*/
+
+#include "bench.h"
+#include "rStrings.h"
+#include <stdlib.h>
+#include <string.h>
+
+// One typical publish cycle of a sensor: topics, values and a timestamp, everything released at the end
+static void publishCycle()
+{
+  char* items[8];
+  items[0] = mqttGetTopicDevice2(true, false, "heater", "status");
+  items[1] = mqttGetTopicDevice2(true, false, "heater", "temperature");
+  items[2] = mqttGetTopicLocation2(true, false, "outdoor", "humidity");
+  items[3] = malloc_stringf("%.2f", 21.5);
+  items[4] = malloc_stringf("%.2f", 45.25);
+  items[5] = malloc_timespan_dhms(1234567);
+  items[6] = malloc_string("ok");
+  items[7] = concat_strings_div(malloc_string("mode=auto"), malloc_string("state=on"), ";");
+  for (size_t i = 0; i < sizeof(items) / sizeof(items[0]); i++) {
+    bench::doNotOptimize(items[i]);
+    rs_free(items[i]);
+  };
+}
+
+BENCH_CHECK(check_alloc_stats)
+{
+  rs_reset_alloc_stats();
+  rs_alloc_stats_t before, after;
+  rs_get_alloc_stats(&before);
+  publishCycle();
+  rs_get_alloc_stats(&after);
+  // Only what the allocator cannot change: concat_strings_div may extend its first part in place or reallocate it,
+  // exact call counts are checked by check_alloc_custom_backend. Every block of the cycle is released
+  if (after.frees - before.frees != 9) return bench::fail("check_alloc_stats", "frees = %llu", (unsigned long long)(after.frees - before.frees));
+  if (after.calls - before.calls < after.frees - before.frees) return bench::fail("check_alloc_stats", "calls = %llu", (unsigned long long)(after.calls - before.calls));
+  if (after.current != before.current) return bench::fail("check_alloc_stats", "current %zu -> %zu", before.current, after.current);
+  if (after.peak <= before.current) return bench::fail("check_alloc_stats", "peak was not raised");
+  if (after.failures != 0) return bench::fail("check_alloc_stats", "failures = %u", after.failures);
+  return true;
+}
+
+// Counting allocator on top of the default one: verifies that every allocation goes through the backend
+struct CountingCtx {
+  size_t allocs;
+  size_t frees;
+};
+
+static void* counting_alloc(void* ctx, size_t size) { ((CountingCtx*)ctx)->allocs++; return malloc(size); }
+static void* counting_realloc(void* ctx, void* ptr, size_t size) { ((CountingCtx*)ctx)->allocs++; return realloc(ptr, size); }
+static void  counting_free(void* ctx, void* ptr) { ((CountingCtx*)ctx)->frees++; free(ptr); }
+
+BENCH_CHECK(check_alloc_custom_backend)
+{
+  CountingCtx ctx = { 0, 0 };
+  rs_allocator_t allocator = { counting_alloc, counting_realloc, counting_free, nullptr, &ctx };
+  rs_set_allocator(&allocator);
+  publishCycle();
+  rs_set_allocator(nullptr);
+  // Without a size callback concat_strings_div cannot see spare room of the first part and reallocates it once
+  if (ctx.allocs != 10 || ctx.frees != 9) {
+    return bench::fail("check_alloc_custom_backend", "allocs = %zu, frees = %zu", ctx.allocs, ctx.frees);
+  };
+  return rs_get_allocator() == rs_default_allocator();
+}
+
+BENCH(publish_cycle_heap)
+{
+  while (state.next()) {
+    publishCycle();
+  };
+}
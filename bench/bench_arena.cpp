@@ -0,0 +1,96 @@
+/* 
+   EN: Arena (bump) allocation versus per-string heap allocation
+   RU: Выделение строк из арены в сравнении с выделением каждой строки в куче
+*/
+
+#include "bench.h"
+#include "rStrings.h"
+#include "rStringsArena.h"
+#include <stdlib.h>
+#include <string.h>
+
+// The same publish cycle as publish_cycle_heap (bench_alloc.cpp), built in an arena that is reset once per cycle
+static void publishCycleArena(rs_arena_t* arena)
+{
+  char* items[8];
+  items[0] = mqttGetTopicDevice2_arena(arena, true, false, "heater", "status");
+  items[1] = mqttGetTopicDevice2_arena(arena, true, false, "heater", "temperature");
+  items[2] = mqttGetTopicLocation2_arena(arena, true, false, "outdoor", "humidity");
+  items[3] = malloc_stringf_arena(arena, "%.2f", 21.5);
+  items[4] = malloc_stringf_arena(arena, "%.2f", 45.25);
+  items[5] = malloc_timespan_dhms_arena(arena, 1234567);
+  items[6] = malloc_string_arena(arena, "ok");
+  items[7] = malloc_stringf_arena(arena, "%s;%s", "mode=auto", "state=on");
+  bench::doNotOptimize(items);
+  rs_arena_reset(arena);
+}
+
+BENCH(publish_cycle_arena)
+{
+  char buffer[512];
+  rs_arena_t arena;
+  rs_arena_init(&arena, buffer, sizeof(buffer));
+  while (state.next()) {
+    publishCycleArena(&arena);
+  };
+}
+
+BENCH(arena_mqttGetTopicDevice2)
+{
+  char buffer[256];
+  rs_arena_t arena;
+  rs_arena_init(&arena, buffer, sizeof(buffer));
+  while (state.next()) {
+    char* s = mqttGetTopicDevice2_arena(&arena, true, false, "heater", "status");
+    bench::doNotOptimize(s);
+    rs_arena_reset(&arena);
+  };
+}
+
+BENCH_CHECK(check_arena_matches_heap)
+{
+  char buffer[512];
+  rs_arena_t arena;
+  rs_arena_init(&arena, buffer, sizeof(buffer));
+  const char* segments[] = { "1", "2", nullptr, "4", "5", "6", "7" };
+  struct { char* heap; char* arena; } pairs[] = {
+    { mqttGetTopicLocation(true, true, "a", "b", "c"), mqttGetTopicLocation_arena(&arena, true, true, "a", "b", "c") },
+    { mqttGetTopicSpecial5(false, false, "s", "1", "2", "3", "4", "5"), mqttGetTopicSpecial5_arena(&arena, false, false, "s", "1", "2", "3", "4", "5") },
+    { mqttGetTopicSpecial2(true, false, nullptr, "1", "2"), mqttGetTopicSpecial2_arena(&arena, true, false, nullptr, "1", "2") },
+    { mqttGetTopicDevice4(false, true, "1", "2", "3", "4"), mqttGetTopicDevice4_arena(&arena, false, true, "1", "2", "3", "4") },
+    // NULL segments are skipped
+    { mqttGetTopicDevice2(true, false, "a", nullptr), mqttGetTopicDevice2_arena(&arena, true, false, "a", nullptr) },
+    { mqttGetTopicSpecial3(true, true, "s", nullptr, "2", nullptr), mqttGetTopicSpecial3_arena(&arena, true, true, "s", nullptr, "2", nullptr) },
+    { mqttGetTopic(false, true, MQTT_HEADER_DEVICE, nullptr, segments, 7), mqttGetTopic_arena(&arena, false, true, MQTT_HEADER_DEVICE, nullptr, segments, 7) },
+    { malloc_timespan_hms(86399), malloc_timespan_hms_arena(&arena, 86399) },
+    { malloc_stringl("heater/status", 6), malloc_stringl_arena(&arena, "heater/status", 6) },
+    { malloc_stringl("ok", 10), malloc_stringl_arena(&arena, "ok", 10) },
+  };
+  bool ok = true;
+  for (size_t i = 0; i < sizeof(pairs) / sizeof(pairs[0]); i++) {
+    if (!pairs[i].heap || !pairs[i].arena || strcmp(pairs[i].heap, pairs[i].arena) != 0) {
+      ok = bench::fail("check_arena_matches_heap", "#%zu: \"%s\" != \"%s\"", i, pairs[i].heap, pairs[i].arena);
+    };
+    free(pairs[i].heap);
+  };
+  return ok;
+}
+
+BENCH_CHECK(check_arena_exhausted)
+{
+  alignas(sizeof(void*)) char buffer[16];
+  rs_arena_t arena;
+  rs_arena_init(&arena, buffer, sizeof(buffer));
+  char* s1 = malloc_string_arena(&arena, "0123456789");
+  char* s2 = malloc_stringf_arena(&arena, "%s", "0123456789");
+  if (!s1 || s2 || arena.failures != 1 || arena.used != 11) return bench::fail("check_arena_exhausted", "used = %zu", arena.used);
+  rs_arena_reset(&arena);
+  if (malloc_stringf_arena(&arena, "%s", "0123456789") != buffer) return bench::fail("check_arena_exhausted", "reset");
+  // A block that does not fit leaves the alignment padding unused
+  rs_arena_reset(&arena);
+  malloc_string_arena(&arena, "x");
+  if (rs_arena_alloc(&arena, 15) || (arena.used != 2) || !rs_arena_alloc(&arena, 16 - sizeof(void*)) || (arena.used != 16)) {
+    return bench::fail("check_arena_exhausted", "aligned: used = %zu", arena.used);
+  };
+  return true;
+}
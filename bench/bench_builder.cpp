@@ -0,0 +1,150 @@
+/*
+   EN: String builder and concatenation: checks and benchmarks
+   RU: Построитель строк и конкатенация: проверки и замеры
+*/
+
+#include "bench.h"
+#include "rStrings.h"
+#include "rStringsBuilder.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+
+static const char* const params[] = { "status", "temperature", "humidity", "mode", "state", "config" };
+static const size_t paramsCount = sizeof(params) / sizeof(params[0]);
+
+BENCH_CHECK(check_builder_append)
+{
+  rs_builder_t builder;
+  rs_builder_init(&builder, 0);
+  rs_builder_append(&builder, "t=");
+  rs_builder_append_int(&builder, -2150);
+  rs_builder_append_char(&builder, ';');
+  rs_builder_append_sep(&builder, ";", "mode=auto");
+  // Longer than any spare room: formatted a second time after growing
+  rs_builder_append_fmt(&builder, ";%s=%d", "a_rather_long_parameter_name_to_force_the_buffer_to_grow_twice", 42);
+  rs_builder_append_char(&builder, ';');
+  rs_builder_append_time(&builder, "%d.%m.%Y %H:%M", 1700000000);
+  const char* expected = "t=-2150;;mode=auto;a_rather_long_parameter_name_to_force_the_buffer_to_grow_twice=42;";
+  char timestr[32];
+  time_t value = 1700000000;
+  time2str("%d.%m.%Y %H:%M", &value, timestr, sizeof(timestr));
+  std::string full = std::string(expected) + timestr;
+  if ((builder.len != full.size()) || (strcmp(builder.data, full.c_str()) != 0)) {
+    return bench::fail("check_builder_append", "\"%s\" != \"%s\"", builder.data, full.c_str());
+  };
+  char* s = rs_builder_detach_fit(&builder);
+  bool ok = (strcmp(s, full.c_str()) == 0) && (builder.data == nullptr) && (builder.len == 0);
+  rs_free(s);
+  if (!ok) return bench::fail("check_builder_append", "detach");
+
+  // Separator only between items, empty result is an empty string
+  rs_builder_init(&builder, 16);
+  for (size_t i = 0; i < 3; i++) rs_builder_append_sep(&builder, ", ", params[i]);
+  ok = strcmp(builder.data, "status, temperature, humidity") == 0;
+  rs_builder_free(&builder);
+  char* empty = rs_builder_detach(&builder);
+  ok = ok && empty && (empty[0] == '\0');
+  rs_free(empty);
+  return ok ? true : bench::fail("check_builder_append", "separators / empty detach");
+}
+
+static void* failing_alloc(void*, size_t) { return nullptr; }
+static void* failing_realloc(void*, void*, size_t) { return nullptr; }
+static void  failing_free(void*, void* ptr) { free(ptr); }
+
+BENCH_CHECK(check_builder_failure)
+{
+  rs_allocator_t allocator = { failing_alloc, failing_realloc, failing_free, nullptr, nullptr };
+  rs_set_allocator(&allocator);
+  rs_builder_t builder;
+  rs_builder_init(&builder, 0);
+  bool appended = rs_builder_append(&builder, "data");
+  bool failed = builder.failed;
+  bool later = rs_builder_append_char(&builder, 'x');
+  char* s = rs_builder_detach(&builder);
+  rs_set_allocator(nullptr);
+  if (appended || !failed || later || s) {
+    return bench::fail("check_builder_failure", "appended %d, failed %d, later %d, result %p", appended, failed, later, s);
+  };
+  return true;
+}
+
+// Times longer than CONFIG_FORMAT_STRFTIME_BUFFER_SIZE are formatted with more room, not dropped
+BENCH_CHECK(check_builder_time)
+{
+  std::string format, expected;
+  rs_builder_t builder;
+  rs_builder_init(&builder, 0);
+  for (int i = 0; i < 15; i++) {
+    format += "%d.%m.%Y %H:%M ";
+    rs_builder_append_time(&builder, "%d.%m.%Y %H:%M ", 1634400000);
+  };
+  expected = builder.data;
+  rs_builder_free(&builder);
+  rs_builder_init(&builder, 0);
+  bool ok = rs_builder_append_time(&builder, format.c_str(), 1634400000) && (expected.size() > 64) && (expected == builder.data);
+  if (!ok) bench::fail("check_builder_time", "\"%s\" != \"%s\"", builder.data, expected.c_str());
+  rs_builder_free(&builder);
+  return ok;
+}
+
+BENCH_CHECK(check_concat_chain)
+{
+  std::string expected;
+  char* s = nullptr;
+  for (size_t i = 0; i < 200; i++) {
+    s = concat_strings_div(s, malloc_string(params[i % paramsCount]), ",");
+    if (!expected.empty()) expected += ",";
+    expected += params[i % paramsCount];
+  };
+  s = concat_strings(s, malloc_string("!"));
+  s = concat_strings(s, nullptr);
+  expected += "!";
+  bool ok = s && (strcmp(s, expected.c_str()) == 0);
+  if (!ok) bench::fail("check_concat_chain", "\"%s\"", s ? s : "NULL");
+  rs_free(s);
+  return ok;
+}
+
+// A long diagnostic payload: 64 items, with concat_strings_div and with the builder
+BENCH(concat_strings_div_chain_64)
+{
+  while (state.next()) {
+    char* s = nullptr;
+    for (size_t i = 0; i < 64; i++) {
+      s = concat_strings_div(s, malloc_string(params[i % paramsCount]), ",");
+    };
+    bench::doNotOptimize(s);
+    rs_free(s);
+  };
+}
+
+BENCH(builder_chain_64)
+{
+  while (state.next()) {
+    rs_builder_t builder;
+    rs_builder_init(&builder, 0);
+    for (size_t i = 0; i < 64; i++) {
+      rs_builder_append_sep(&builder, ",", params[i % paramsCount]);
+    };
+    char* s = rs_builder_detach(&builder);
+    bench::doNotOptimize(s);
+    rs_free(s);
+  };
+}
+
+BENCH(builder_payload_fmt)
+{
+  while (state.next()) {
+    rs_builder_t builder;
+    rs_builder_init(&builder, 128);
+    for (size_t i = 0; i < 8; i++) {
+      rs_builder_append_fmt(&builder, "%s=%d;", params[i % paramsCount], (int)i * 10);
+    };
+    char* s = rs_builder_detach(&builder);
+    bench::doNotOptimize(s);
+    rs_free(s);
+  };
+}
@@ -0,0 +1,313 @@
+/* 
+   EN: Baseline benchmarks for every public rStrings entry point
+   RU: Базовые замеры для всех публичных функций rStrings
+*/
+
+#include "bench.h"
+#include "rStrings.h"
+#include <stdlib.h>
+#include <string.h>
+
+// Realistic inputs: sensor and parameter names, timestamps around "now", uptimes from minutes to years
+static const char* const sensors[] = { "heater", "boiler", "outdoor", "greenhouse", "water_tank", "pump" };
+static const char* const params[] = { "status", "temperature", "humidity", "mode", "state", "config" };
+static const size_t sensorsCount = sizeof(sensors) / sizeof(sensors[0]);
+static const size_t paramsCount = sizeof(params) / sizeof(params[0]);
+static const time_t timestamp = 1700000000;
+static const time_t uptimes[] = { 59, 3599, 86399, 1234567, 31536000, 315360000 };
+static const size_t uptimesCount = sizeof(uptimes) / sizeof(uptimes[0]);
+
+// -----------------------------------------------------------------------------------------------------------------------
+// -------------------------------------------------- Format strings -----------------------------------------------------
+// -----------------------------------------------------------------------------------------------------------------------
+
+BENCH(malloc_string_short)
+{
+  size_t i = 0;
+  while (state.next()) {
+    char* s = malloc_string(sensors[i++ % sensorsCount]);
+    bench::doNotOptimize(s);
+    free(s);
+  };
+}
+
+BENCH(malloc_string_payload)
+{
+  static const char* payload = "{\"temperature\":21.50,\"humidity\":45.20,\"pressure\":1013.25,\"status\":\"ok\"}";
+  while (state.next()) {
+    char* s = malloc_string(payload);
+    bench::doNotOptimize(s);
+    free(s);
+  };
+}
+
+BENCH(malloc_stringl_prefix)
+{
+  static const char* source = "local/village/boiler_room/heater/status";
+  while (state.next()) {
+    char* s = malloc_stringl(source, 25);
+    bench::doNotOptimize(s);
+    free(s);
+  };
+}
+
+BENCH(malloc_stringf_float_value)
+{
+  double value = -12.75;
+  while (state.next()) {
+    char* s = malloc_stringf("%.2f", value);
+    bench::doNotOptimize(s);
+    free(s);
+    value += 0.01;
+  };
+}
+
+BENCH(malloc_stringf_int_value)
+{
+  int32_t value = -40;
+  while (state.next()) {
+    char* s = malloc_stringf("%d", value);
+    bench::doNotOptimize(s);
+    free(s);
+    if (++value > 125) value = -40;
+  };
+}
+
+BENCH(malloc_stringf_json_payload)
+{
+  double t = 21.5, h = 45.2;
+  while (state.next()) {
+    char* s = malloc_stringf("{\"temperature\":%.2f,\"humidity\":%.2f,\"status\":\"%s\",\"uptime\":%u}", t, h, "ok", 123456u);
+    bench::doNotOptimize(s);
+    free(s);
+  };
+}
+
+BENCH(format_string_value)
+{
+  char buffer[32];
+  double value = 21.5;
+  while (state.next()) {
+    uint16_t len = format_string(buffer, sizeof(buffer), "%.1f", value);
+    bench::doNotOptimize(len);
+    bench::clobberMemory();
+  };
+}
+
+BENCH(format_string_topic)
+{
+  char buffer[96];
+  while (state.next()) {
+    uint16_t len = format_string(buffer, sizeof(buffer), "%s/%s/%s", "local/village", "heater", "status");
+    bench::doNotOptimize(len);
+    bench::clobberMemory();
+  };
+}
+
+// -----------------------------------------------------------------------------------------------------------------------
+// -------------------------------------------------- Integer to string --------------------------------------------------
+// -----------------------------------------------------------------------------------------------------------------------
+
+BENCH(i64toa_small_dec)
+{
+  char buffer[72];
+  int64_t value = -500;
+  while (state.next()) {
+    bench::doNotOptimize(_i64toa(value, buffer, 10));
+    if (++value > 500) value = -500;
+  };
+}
+
+BENCH(i64toa_large_dec)
+{
+  char buffer[72];
+  int64_t value = -9000000000000000000LL;
+  while (state.next()) {
+    bench::doNotOptimize(_i64toa(value, buffer, 10));
+    value += 1234567890123LL;
+  };
+}
+
+BENCH(ui64toa_counter_dec)
+{
+  char buffer[72];
+  uint64_t value = 1000000;
+  while (state.next()) {
+    bench::doNotOptimize(_ui64toa(value++, buffer, 10));
+  };
+}
+
+BENCH(ui64toa_id_hex)
+{
+  char buffer[72];
+  uint64_t value = 0x24A160DEADBEEFULL;
+  while (state.next()) {
+    bench::doNotOptimize(_ui64toa(value++, buffer, 16));
+  };
+}
+
+BENCH(ui64toa_mask_bin)
+{
+  char buffer[72];
+  uint64_t value = 0xA5A5ULL;
+  while (state.next()) {
+    bench::doNotOptimize(_ui64toa(value++, buffer, 2));
+  };
+}
+
+// -----------------------------------------------------------------------------------------------------------------------
+// ------------------------------------------------------- Time ----------------------------------------------------------
+// -----------------------------------------------------------------------------------------------------------------------
+
+BENCH(time2str_datetime_now)
+{
+  char buffer[32];
+  time_t value = timestamp;
+  while (state.next()) {
+    size_t len = time2str("%d.%m.%Y %H:%M:%S", &value, buffer, sizeof(buffer));
+    bench::doNotOptimize(len);
+    value++;
+  };
+}
+
+BENCH(time2str_time_now)
+{
+  char buffer[16];
+  time_t value = timestamp;
+  while (state.next()) {
+    size_t len = time2str("%H:%M:%S", &value, buffer, sizeof(buffer));
+    bench::doNotOptimize(len);
+    value++;
+  };
+}
+
+BENCH(time2str_empty_zero)
+{
+  char buffer[32];
+  time_t value = 0;
+  while (state.next()) {
+    size_t len = time2str_empty("%d.%m.%Y %H:%M:%S", &value, buffer, sizeof(buffer));
+    bench::doNotOptimize(len);
+  };
+}
+
+BENCH(time2str_empty_random)
+{
+  char buffer[32];
+  time_t value = timestamp;
+  while (state.next()) {
+    size_t len = time2str_empty("%d.%m.%Y %H:%M", &value, buffer, sizeof(buffer));
+    bench::doNotOptimize(len);
+    value += 7919;
+  };
+}
+
+BENCH(malloc_timespan_hms)
+{
+  size_t i = 0;
+  while (state.next()) {
+    char* s = malloc_timespan_hms(uptimes[i++ % uptimesCount]);
+    bench::doNotOptimize(s);
+    free(s);
+  };
+}
+
+BENCH(malloc_timespan_dhms)
+{
+  size_t i = 0;
+  while (state.next()) {
+    char* s = malloc_timespan_dhms(uptimes[i++ % uptimesCount]);
+    bench::doNotOptimize(s);
+    free(s);
+  };
+}
+
+// -----------------------------------------------------------------------------------------------------------------------
+// --------------------------------------------------- Concatenation -----------------------------------------------------
+// -----------------------------------------------------------------------------------------------------------------------
+
+BENCH(concat_strings_pair)
+{
+  while (state.next()) {
+    char* s = concat_strings(malloc_string("temperature="), malloc_string("21.50"));
+    bench::doNotOptimize(s);
+    free(s);
+  };
+}
+
+BENCH(concat_strings_div_chain_16)
+{
+  while (state.next()) {
+    char* s = nullptr;
+    for (size_t i = 0; i < 16; i++) {
+      s = concat_strings_div(s, malloc_string(params[i % paramsCount]), ",");
+    };
+    bench::doNotOptimize(s);
+    free(s);
+  };
+}
+
+// -----------------------------------------------------------------------------------------------------------------------
+// ---------------------------------------------------- Topics -----------------------------------------------------------
+// -----------------------------------------------------------------------------------------------------------------------
+
+#define BENCH_TOPIC(name, expr) \
+  BENCH(name) \
+  { \
+    size_t i = 0; \
+    while (state.next()) { \
+      const char* s1 = sensors[i % sensorsCount]; \
+      const char* p1 = params[i % paramsCount]; \
+      (void)s1; (void)p1; \
+      char* s = expr; \
+      bench::doNotOptimize(s); \
+      free(s); \
+      i++; \
+    }; \
+  }
+
+BENCH_TOPIC(mqttGetSubTopic, mqttGetSubTopic("local/village/boiler_room", s1))
+BENCH_TOPIC(mqttGetTopicLocation1, mqttGetTopicLocation1(true, false, s1))
+BENCH_TOPIC(mqttGetTopicLocation2, mqttGetTopicLocation2(true, false, s1, p1))
+BENCH_TOPIC(mqttGetTopicLocation3, mqttGetTopicLocation3(false, true, s1, p1, "value"))
+BENCH_TOPIC(mqttGetTopicLocation, mqttGetTopicLocation(true, true, s1, p1, nullptr))
+BENCH_TOPIC(mqttGetTopicSpecial1, mqttGetTopicSpecial1(true, false, "climate", s1))
+BENCH_TOPIC(mqttGetTopicSpecial2, mqttGetTopicSpecial2(true, false, "climate", s1, p1))
+BENCH_TOPIC(mqttGetTopicSpecial3, mqttGetTopicSpecial3(true, true, "climate", s1, p1, "value"))
+BENCH_TOPIC(mqttGetTopicSpecial4, mqttGetTopicSpecial4(false, false, "climate", s1, p1, "value", "min"))
+BENCH_TOPIC(mqttGetTopicSpecial5, mqttGetTopicSpecial5(true, false, "climate", s1, p1, "value", "min", "daily"))
+BENCH_TOPIC(mqttGetTopicSpecial_nospecial, mqttGetTopicSpecial(true, false, nullptr, s1, p1, nullptr))
+BENCH_TOPIC(mqttGetTopicDevice1, mqttGetTopicDevice1(true, false, s1))
+BENCH_TOPIC(mqttGetTopicDevice2, mqttGetTopicDevice2(true, false, s1, p1))
+BENCH_TOPIC(mqttGetTopicDevice3, mqttGetTopicDevice3(true, true, s1, p1, "value"))
+BENCH_TOPIC(mqttGetTopicDevice4, mqttGetTopicDevice4(false, false, s1, p1, "value", "min"))
+BENCH_TOPIC(mqttGetTopicDevice5, mqttGetTopicDevice5(true, false, s1, p1, "value", "min", "daily"))
+BENCH_TOPIC(mqttGetTopicDevice, mqttGetTopicDevice(false, true, s1, p1, "value"))
+
+// Sanity of the topic layout used by all benchmarks above
+BENCH_CHECK(check_topic_layout)
+{
+  char* s = mqttGetTopicDevice2(true, false, "heater", "status");
+  bool ok = s && (strcmp(s, "kotyara12/village/boiler_room/heater/status") == 0);
+  if (!ok) bench::fail("check_topic_layout", "got \"%s\"", s ? s : "(null)");
+  free(s);
+  return ok;
+}
+
+// Strings longer than the scratch buffer of malloc_stringf take the measuring path
+BENCH_CHECK(check_stringf_long_and_truncated)
+{
+  char source[400];
+  memset(source, 'a', sizeof(source) - 1);
+  source[sizeof(source) - 1] = '\0';
+  char* s = malloc_stringf("<%s>", source);
+  bool ok = s && (strlen(s) == sizeof(source) + 1) && (s[0] == '<') && (s[sizeof(source)] == '>');
+  free(s);
+  char buffer[8];
+  uint16_t len = format_string(buffer, sizeof(buffer), "%s", "0123456789");
+  ok = ok && (len == 10) && (strcmp(buffer, "0123456") == 0);
+  char* l = malloc_stringl("abc", 10);
+  ok = ok && l && (strcmp(l, "abc") == 0);
+  free(l);
+  return ok ? true : bench::fail("check_stringf_long_and_truncated", "len = %u, buffer = \"%s\"", len, buffer);
+}
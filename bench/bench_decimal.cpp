@@ -0,0 +1,152 @@
+/* 
+   EN: printf-free decimal formatting: checks against snprintf and benchmarks
+   RU: Форматирование десятичных значений без printf: сверка с snprintf и замеры
+*/
+
+#include "bench.h"
+#include "rStrings.h"
+#include <math.h>
+#include <random>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// True if the decimal expansion of value after precision digits is close to a tie (xxx5000... or xxx4999...)
+static bool nearTie(double value, int precision)
+{
+  char exact[96];
+  snprintf(exact, sizeof(exact), "%.40f", fabs(value));
+  const char* point = strchr(exact, '.');
+  const char* rest = point + 1 + precision;
+  return (strncmp(rest, "5000000", 7) == 0) || (strncmp(rest, "4999999", 7) == 0);
+}
+
+BENCH_CHECK(check_double_vs_snprintf)
+{
+  std::mt19937_64 random(42);
+  std::uniform_real_distribution<double> ranges[] = {
+    std::uniform_real_distribution<double>(-50.0, 125.0),       // temperatures
+    std::uniform_real_distribution<double>(0.0, 100.0),         // humidity
+    std::uniform_real_distribution<double>(900.0, 1100.0),      // pressure
+    std::uniform_real_distribution<double>(-1e12, 1e12),        // counters
+    std::uniform_real_distribution<double>(-1e-3, 1e-3),        // tiny values
+  };
+  char actual[RS_DECIMAL_BUFFER_SIZE], expected[RS_DECIMAL_BUFFER_SIZE * 2];
+  for (auto& range: ranges) {
+    for (int i = 0; i < 100000; i++) {
+      double value = range(random);
+      int precision = i % 7;
+      if (nearTie(value, precision)) continue;
+      size_t len = double_to_str(value, precision, actual, sizeof(actual));
+      snprintf(expected, sizeof(expected), "%.*f", precision, value);
+      if ((len != strlen(expected)) || (strcmp(actual, expected) != 0)) {
+        return bench::fail("check_double_vs_snprintf", "%.17g / %d: \"%s\" != \"%s\"", value, precision, actual, expected);
+      };
+    };
+  };
+  return true;
+}
+
+BENCH_CHECK(check_decimal_special_cases)
+{
+  struct { double value; uint8_t precision; rs_rounding_t rounding; const char* expected; } cases[] = {
+    { 0.15, 1, RS_ROUND_HALF_UP, "0.2" },
+    { 2.5, 0, RS_ROUND_HALF_EVEN, "2" },
+    { 3.5, 0, RS_ROUND_HALF_EVEN, "4" },
+    { 2.25, 1, RS_ROUND_HALF_EVEN, "2.2" },
+    { -2.5, 0, RS_ROUND_HALF_UP, "-3" },
+    { 2.349, 2, RS_ROUND_DOWN, "2.34" },
+    { -2.349, 2, RS_ROUND_DOWN, "-2.34" },
+    { 9.999, 2, RS_ROUND_HALF_UP, "10.00" },
+    { -0.001, 2, RS_ROUND_HALF_UP, "-0.00" },
+    { 0.0, 3, RS_ROUND_HALF_UP, "0.000" },
+    { 1.5e20, 2, RS_ROUND_HALF_UP, "1.50e+20" },
+    { -9.996e25, 2, RS_ROUND_HALF_UP, "-1.00e+26" },
+    { 123456789012345.0, 0, RS_ROUND_HALF_UP, "123456789012345" },
+    { NAN, 2, RS_ROUND_HALF_UP, "NaN" },
+    { -INFINITY, 2, RS_ROUND_HALF_UP, "-Inf" },
+  };
+  char buffer[RS_DECIMAL_BUFFER_SIZE];
+  for (auto& item: cases) {
+    rs_decimal_format_t format = { item.precision, item.rounding, '.', "NaN", "Inf" };
+    double_to_str_ex(item.value, &format, buffer, sizeof(buffer));
+    if (strcmp(buffer, item.expected) != 0) {
+      return bench::fail("check_decimal_special_cases", "%g / %u: \"%s\" != \"%s\"", item.value, item.precision, buffer, item.expected);
+    };
+  };
+  rs_decimal_format_t comma = { 1, RS_ROUND_HALF_UP, ',', nullptr, nullptr };
+  double_to_str_ex(21.55, &comma, buffer, sizeof(buffer));
+  if (strcmp(buffer, "21,6") != 0) return bench::fail("check_decimal_special_cases", "comma: \"%s\"", buffer);
+  // Too small buffer gives an empty string
+  if ((double_to_str(21.5, 2, buffer, 5) != 0) || (buffer[0] != '\0')) return bench::fail("check_decimal_special_cases", "overflow");
+  return true;
+}
+
+BENCH_CHECK(check_fixed_to_str)
+{
+  struct { int64_t value; uint8_t scale; uint8_t precision; rs_rounding_t rounding; const char* expected; } cases[] = {
+    { 2150, 2, 2, RS_ROUND_HALF_UP, "21.50" },
+    { 2150, 2, 1, RS_ROUND_HALF_UP, "21.5" },
+    { 2155, 2, 1, RS_ROUND_HALF_UP, "21.6" },
+    { 2145, 2, 1, RS_ROUND_HALF_EVEN, "21.4" },
+    { 2155, 2, 1, RS_ROUND_HALF_EVEN, "21.6" },
+    { -2155, 2, 1, RS_ROUND_HALF_UP, "-21.6" },
+    { -2159, 2, 1, RS_ROUND_DOWN, "-21.5" },
+    { 9999, 2, 1, RS_ROUND_HALF_UP, "100.0" },
+    { 5, 1, 0, RS_ROUND_HALF_EVEN, "0" },
+    { 15, 1, 0, RS_ROUND_HALF_EVEN, "2" },
+    { 7, 0, 3, RS_ROUND_HALF_UP, "7.000" },
+    { INT64_MIN, 18, 18 > RS_DECIMAL_MAX_PRECISION ? RS_DECIMAL_MAX_PRECISION : 18, RS_ROUND_DOWN, "-9.22337203685477580" },
+  };
+  char buffer[RS_DECIMAL_BUFFER_SIZE];
+  for (auto& item: cases) {
+    rs_decimal_format_t format = { item.precision, item.rounding, '.', nullptr, nullptr };
+    fixed_to_str(item.value, item.scale, &format, buffer, sizeof(buffer));
+    if (strcmp(buffer, item.expected) != 0) {
+      return bench::fail("check_fixed_to_str", "%lld / %u / %u: \"%s\" != \"%s\"", (long long)item.value, item.scale, item.precision, buffer, item.expected);
+    };
+  };
+  char* s = malloc_fixed(-40, 1, 1);
+  bool ok = s && (strcmp(s, "-4.0") == 0);
+  free(s);
+  return ok;
+}
+
+BENCH(double_to_str_temperature)
+{
+  char buffer[RS_DECIMAL_BUFFER_SIZE];
+  double value = -12.75;
+  while (state.next()) {
+    bench::doNotOptimize(double_to_str(value, 2, buffer, sizeof(buffer)));
+    value += 0.01;
+  };
+}
+
+BENCH(snprintf_temperature)
+{
+  char buffer[RS_DECIMAL_BUFFER_SIZE];
+  double value = -12.75;
+  while (state.next()) {
+    bench::doNotOptimize(snprintf(buffer, sizeof(buffer), "%.2f", value));
+    value += 0.01;
+  };
+}
+
+BENCH(fixed_to_str_temperature)
+{
+  char buffer[RS_DECIMAL_BUFFER_SIZE];
+  int64_t value = -1275;
+  while (state.next()) {
+    bench::doNotOptimize(fixed_to_str(value++, 2, nullptr, buffer, sizeof(buffer)));
+  };
+}
+
+BENCH(malloc_double_value)
+{
+  double value = 21.5;
+  while (state.next()) {
+    char* s = malloc_double(value, 2);
+    bench::doNotOptimize(s);
+    free(s);
+  };
+}
@@ -0,0 +1,137 @@
+/*
+   EN: Runtime topic headers: checks, switching under load and benchmarks
+   RU: Заголовки топиков во время работы: проверки, переключение под нагрузкой и замеры
+*/
+
+#include "bench.h"
+#include "rStrings.h"
+#include "rStringsTopics.h"
+#include "rStringsArena.h"
+#include "rStringsSink.h"
+#include <atomic>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <thread>
+#include <vector>
+
+static bool startsWith(const char* topic, const char* header)
+{
+  return strncmp(topic, header, strlen(header)) == 0;
+}
+
+BENCH_CHECK(check_headers_set_reset)
+{
+  std::string defaultLoc = mqttGetTopicHeader(true, true, MQTT_HEADER_LOCATION);
+  std::string defaultPub = mqttGetTopicHeader(true, false, MQTT_HEADER_DEVICE);
+  uint32_t generation = mqttGetTopicHeadersGeneration();
+  mqttInternInvalidate();
+  const char* parts[] = { "heater", "status" };
+  const char* before = mqttInternTopic(true, true, MQTT_HEADER_DEVICE, nullptr, parts, 2);
+
+  bool ok = mqttSetTopicHeaders(true, true, "home/", "cottage", "gateway")
+         && mqttSetTopicHeaders(false, false, "", nullptr, "backup_gw");
+  char* location = mqttGetTopicSpecial2(true, true, "config", "heater", "mode");
+  char* device = mqttGetTopicDevice2(true, true, "heater", "status");
+  char* backup = mqttGetTopicDevice1(false, false, "status");
+  const char* after = mqttInternTopic(true, true, MQTT_HEADER_DEVICE, nullptr, parts, 2);
+  ok = ok && (strcmp(location, "home/cottage/config/heater/mode") == 0)
+          && (strcmp(device, "home/cottage/gateway/heater/status") == 0)
+          && (strcmp(backup, "backup_gw/status") == 0)
+          && (mqttGetTopicHeadersGeneration() == generation + 2)
+          // Other headers are kept
+          && (defaultPub == mqttGetTopicHeader(true, false, MQTT_HEADER_DEVICE))
+          // Interned topics of the old headers are not returned
+          && before && after && (before != after) && (strcmp(after, device) == 0);
+  if (!ok) bench::fail("check_headers_set_reset", "\"%s\", \"%s\", \"%s\"", location, device, backup);
+
+  // Incoming topics are parsed with the new headers
+  static const char* const specials[] = { "config" };
+  mqtt_topic_parts_t topic;
+  ok = ok && mqttParseTopic(location, strlen(location), specials, 1, &topic)
+          && topic.primary && topic.local && (topic.kind == MQTT_HEADER_LOCATION) && (topic.special == 0)
+          && mqttParseTopic(backup, strlen(backup), nullptr, 0, &topic)
+          && !topic.primary && !topic.local && (topic.kind == MQTT_HEADER_DEVICE);
+  if (!ok) bench::fail("check_headers_set_reset", "parsing");
+  free(location);
+  free(device);
+  free(backup);
+
+  // Too long headers are rejected, the headers stay as they were
+  std::string huge(400, 'x');
+  if (mqttSetTopicHeaders(true, true, huge.c_str(), nullptr, nullptr) || !startsWith("home/cottage/", mqttGetTopicHeader(true, true, MQTT_HEADER_LOCATION))) {
+    ok = bench::fail("check_headers_set_reset", "overflow accepted");
+  };
+
+  mqttResetTopicHeaders();
+  mqttInternInvalidate();
+  if (defaultLoc != mqttGetTopicHeader(true, true, MQTT_HEADER_LOCATION)) ok = bench::fail("check_headers_set_reset", "reset");
+  return ok;
+}
+
+// Publishing tasks build topics while another task keeps changing the location
+BENCH_CHECK(check_headers_switch_under_load)
+{
+  std::atomic<bool> stop(false);
+  std::atomic<size_t> errors(0), built(0);
+  std::vector<std::thread> threads;
+  mqttSetTopicHeaders(true, false, "site_a/", "house", "dev");
+  for (int t = 0; t < 4; t++) {
+    threads.emplace_back([&]() {
+      char buffer[96], arenaBuffer[96], sinkBuffer[96];
+      const char* segments[] = { "heater", "temperature", "value" };
+      rs_arena_t arena;
+      rs_arena_init(&arena, arenaBuffer, sizeof(arenaBuffer));
+      rs_sink_buffer_t target;
+      rs_sink_t sink;
+      // Whole topics are compared: a torn header would differ from both
+      auto valid = [](const char* topic) {
+        return topic && ((strcmp(topic, "site_a/house/dev/heater/temperature/value") == 0)
+                      || (strcmp(topic, "site_bb/barn_long_name/device/heater/temperature/value") == 0));
+      };
+      while (!stop.load()) {
+        char* topic = mqttGetTopicDevice3(true, false, "heater", "temperature", "value");
+        mqttFormatTopic(true, false, MQTT_HEADER_DEVICE, nullptr, segments, 3, buffer, sizeof(buffer));
+        rs_arena_reset(&arena);
+        char* arenaTopic = mqttGetTopicDevice3_arena(&arena, true, false, "heater", "temperature", "value");
+        rs_sink_init_buffer(&sink, &target, sinkBuffer, sizeof(sinkBuffer));
+        mqttSinkTopic(&sink, true, false, MQTT_HEADER_DEVICE, nullptr, segments, 3);
+        if (!(valid(topic) && valid(buffer) && valid(arenaTopic) && valid(sinkBuffer)) && (errors++ == 0)) {
+          bench::fail("check_headers_switch_under_load", "\"%s\", \"%s\", \"%s\", \"%s\"", 
+            topic ? topic : "NULL", buffer, arenaTopic ? arenaTopic : "NULL", sinkBuffer);
+        };
+        built++;
+        free(topic);
+      };
+    });
+  };
+  for (int i = 0; i < 20000; i++) {
+    if (i & 1) {
+      mqttSetTopicHeaders(true, false, "site_a/", "house", "dev");
+    } else {
+      mqttSetTopicHeaders(true, false, "site_bb/", "barn_long_name", "device");
+    };
+  };
+  stop = true;
+  for (auto& thread: threads) thread.join();
+  mqttResetTopicHeaders();
+  return errors == 0 ? true : bench::fail("check_headers_switch_under_load", "%zu of %zu topics are broken", errors.load(), built.load());
+}
+
+BENCH(mqttGetTopicHeader_runtime)
+{
+  size_t i = 0;
+  while (state.next()) {
+    bench::doNotOptimize(mqttGetTopicHeader(i & 1, i & 2, (mqtt_header_t)((i >> 2) & 1)));
+    i++;
+  };
+}
+
+BENCH(mqttSetTopicHeaders_switch)
+{
+  size_t i = 0;
+  while (state.next()) {
+    bench::doNotOptimize(mqttSetTopicHeaders(false, true, "local/", (i++ & 1) ? "village" : "town", "boiler_room"));
+  };
+  mqttResetTopicHeaders();
+}
@@ -0,0 +1,162 @@
+/* 
+   EN: Integer to string kernels: differential checks against snprintf and a naive reference, benchmarks
+   RU: Преобразование целых чисел в строку: сверка с snprintf и эталонной реализацией, замеры
+*/
+
+#include "bench.h"
+#include "rStrings.h"
+#include <inttypes.h>
+#include <random>
+#include <stdio.h>
+#include <string.h>
+
+// Reference: one digit per division, then reversed, sign + magnitude
+static size_t referenceToStr(int64_t value, bool isSigned, char* buffer, uint8_t radix)
+{
+  bool negative = isSigned && (value < 0);
+  uint64_t val = negative ? 0 - (uint64_t)value : (uint64_t)value;
+  char temp[70];
+  size_t len = 0;
+  do {
+    temp[len++] = "0123456789abcdef"[val % radix];
+    val /= radix;
+  } while (val != 0);
+  size_t pos = 0;
+  if (negative) buffer[pos++] = '-';
+  while (len > 0) buffer[pos++] = temp[--len];
+  buffer[pos] = '\0';
+  return pos;
+}
+
+// snprintf view of the same value for the radixes it supports
+static bool snprintfToStr(int64_t value, bool isSigned, char* buffer, uint8_t radix)
+{
+  const char* fmt = (radix == 10) ? "%s%" PRIu64 : (radix == 16) ? "%s%" PRIx64 : (radix == 8) ? "%s%" PRIo64 : nullptr;
+  if (fmt == nullptr) return false;
+  bool negative = isSigned && (value < 0);
+  snprintf(buffer, 70, fmt, negative ? "-" : "", negative ? 0 - (uint64_t)value : (uint64_t)value);
+  return true;
+}
+
+static bool verifyValue(uint64_t raw, uint8_t radix, uint64_t* checked)
+{
+  char actual[RS_INT64_BUFFER_SIZE + 8], expected[72], printed[72];
+  for (int isSigned = 0; isSigned < 2; isSigned++) {
+    memset(actual, 0x55, sizeof(actual));
+    size_t len = isSigned ? i64_to_str((int64_t)raw, actual, radix) : ui64_to_str(raw, actual, radix);
+    size_t elen = referenceToStr((int64_t)raw, isSigned, expected, radix);
+    if ((len != elen) || (strcmp(actual, expected) != 0) || (len >= RS_INT64_BUFFER_SIZE)) {
+      return bench::fail("check_itoa_differential", "%s %" PRIu64 " radix %u: \"%s\" (%zu) != \"%s\" (%zu)",
+        isSigned ? "signed" : "unsigned", raw, radix, actual, len, expected, elen);
+    };
+    if (snprintfToStr((int64_t)raw, isSigned, printed, radix) && (strcmp(actual, printed) != 0)) {
+      return bench::fail("check_itoa_differential", "%" PRIu64 " radix %u: \"%s\" != snprintf \"%s\"", raw, radix, actual, printed);
+    };
+    // legacy wrappers return the same text
+    char* legacy = isSigned ? _i64toa((int64_t)raw, printed, radix) : _ui64toa(raw, printed, radix);
+    if ((legacy != printed) || (strcmp(legacy, expected) != 0)) {
+      return bench::fail("check_itoa_differential", "legacy %" PRIu64 " radix %u: \"%s\"", raw, radix, legacy);
+    };
+    (*checked)++;
+  };
+  return true;
+}
+
+BENCH_CHECK(check_itoa_differential)
+{
+  uint64_t checked = 0;
+  for (uint8_t radix = 2; radix <= 16; radix++) {
+    // Every value around zero
+    for (int64_t v = -(1 << 17); v <= (1 << 17); v++) {
+      if (!verifyValue((uint64_t)v, radix, &checked)) return false;
+    };
+    // Every power of the radix and its neighbours, also as negative numbers
+    uint64_t p = 1;
+    while (true) {
+      for (int64_t d = -2; d <= 2; d++) {
+        if (!verifyValue(p + d, radix, &checked)) return false;
+        if (!verifyValue(0 - (p + d), radix, &checked)) return false;
+      };
+      if (p > UINT64_MAX / radix) break;
+      p *= radix;
+    };
+    // Every power of two and its neighbours (32/64-bit boundaries)
+    for (int bit = 0; bit < 64; bit++) {
+      for (int64_t d = -1; d <= 1; d++) {
+        if (!verifyValue((1ULL << bit) + d, radix, &checked)) return false;
+      };
+    };
+    const uint64_t edges[] = { 0, UINT64_MAX, (uint64_t)INT64_MAX, (uint64_t)INT64_MIN, UINT32_MAX, (uint64_t)UINT32_MAX + 1 };
+    for (uint64_t edge: edges) {
+      if (!verifyValue(edge, radix, &checked)) return false;
+    };
+    // Random values of random magnitude
+    std::mt19937_64 random(radix);
+    for (int i = 0; i < 100000; i++) {
+      uint64_t v = random() >> (random() % 64);
+      if (!verifyValue(v, radix, &checked)) return false;
+    };
+  };
+  // Wrong radix gives an empty string
+  char buffer[RS_INT64_BUFFER_SIZE];
+  if ((i64_to_str(5, buffer, 1) != 0) || (buffer[0] != '\0') || (ui64_to_str(5, buffer, 17) != 0)) {
+    return bench::fail("check_itoa_differential", "wrong radix accepted");
+  };
+  return checked > 0;
+}
+
+BENCH(i64_to_str_small_dec)
+{
+  char buffer[RS_INT64_BUFFER_SIZE];
+  int64_t value = -500;
+  while (state.next()) {
+    bench::doNotOptimize(i64_to_str(value, buffer, 10));
+    if (++value > 500) value = -500;
+  };
+}
+
+BENCH(i64_to_str_large_dec)
+{
+  char buffer[RS_INT64_BUFFER_SIZE];
+  int64_t value = -9000000000000000000LL;
+  while (state.next()) {
+    bench::doNotOptimize(i64_to_str(value, buffer, 10));
+    value += 1234567890123LL;
+  };
+}
+
+BENCH(ui64_to_str_counter_dec)
+{
+  char buffer[RS_INT64_BUFFER_SIZE];
+  uint64_t value = 1000000;
+  while (state.next()) {
+    bench::doNotOptimize(ui64_to_str(value++, buffer, 10));
+  };
+}
+
+BENCH(ui64_to_str_id_hex)
+{
+  char buffer[RS_INT64_BUFFER_SIZE];
+  uint64_t value = 0x24A160DEADBEEFULL;
+  while (state.next()) {
+    bench::doNotOptimize(ui64_to_str(value++, buffer, 16));
+  };
+}
+
+BENCH(ui64_to_str_mask_bin)
+{
+  char buffer[RS_INT64_BUFFER_SIZE];
+  uint64_t value = 0xA5A5ULL;
+  while (state.next()) {
+    bench::doNotOptimize(ui64_to_str(value++, buffer, 2));
+  };
+}
+
+BENCH(snprintf_counter_dec)
+{
+  char buffer[RS_INT64_BUFFER_SIZE];
+  uint64_t value = 1000000;
+  while (state.next()) {
+    bench::doNotOptimize(snprintf(buffer, sizeof(buffer), "%" PRIu64, value++));
+  };
+}
@@ -0,0 +1,197 @@
+/*
+   EN: JSON writer: checks of the output, overflow and misuse, and a telemetry payload against heap string chains
+   RU: Запись JSON: проверки вывода, переполнения и ошибок вызова, и данные телеметрии против цепочек строк в куче
+*/
+
+#include "bench.h"
+#include "rStrings.h"
+#include "rStringsJson.h"
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static const time_t payloadTime = 1634400000;
+
+// A typical telemetry payload of one publish cycle
+static bool payloadWrite(rs_json_t* json, int seq)
+{
+  rs_json_object_begin(json, nullptr);
+    rs_json_string(json, "device", "greenhouse \"north\"\n");
+    rs_json_int(json, "seq", seq);
+    rs_json_time(json, "time", "%d.%m.%Y %H:%M:%S", payloadTime);
+    rs_json_object_begin(json, "climate");
+      rs_json_double(json, "temperature", 21.456, 2);
+      rs_json_fixed(json, "humidity", 6350, 1);
+      rs_json_bool(json, "heater", true);
+      rs_json_double(json, "dew_point", NAN, 2);
+    rs_json_object_end(json);
+    rs_json_array_begin(json, "relays");
+      rs_json_uint(json, nullptr, 18446744073709551615ULL);
+      rs_json_int(json, nullptr, -42);
+      rs_json_null(json, nullptr);
+      rs_json_array_begin(json, nullptr);
+      rs_json_array_end(json);
+      rs_json_object_begin(json, nullptr);
+      rs_json_object_end(json);
+    rs_json_array_end(json);
+    rs_json_raw(json, "extra", "{\"a\":1}");
+  rs_json_object_end(json);
+  return rs_json_finish(json);
+}
+
+static const char* payloadExpected(char* buffer, size_t size, int seq)
+{
+  char time[64];
+  time_t value = payloadTime;
+  time2str("%d.%m.%Y %H:%M:%S", &value, time, sizeof(time));
+  snprintf(buffer, size, "{\"device\":\"greenhouse \\\"north\\\"\\n\",\"seq\":%d,\"time\":\"%s\","
+    "\"climate\":{\"temperature\":21.46,\"humidity\":635.0,\"heater\":true,\"dew_point\":null},"
+    "\"relays\":[18446744073709551615,-42,null,[],{}],\"extra\":{\"a\":1}}", seq, time);
+  return buffer;
+}
+
+BENCH_CHECK(check_json_output)
+{
+  bool ok = true;
+  char expected[512], buffer[512];
+  payloadExpected(expected, sizeof(expected), 7);
+
+  rs_sink_buffer_t target;
+  rs_sink_t sink;
+  rs_json_t json;
+  rs_sink_init_buffer(&sink, &target, buffer, sizeof(buffer));
+  rs_json_init(&json, &sink);
+  if (!payloadWrite(&json, 7) || (strcmp(buffer, expected) != 0) || (sink.written != strlen(expected))) {
+    ok = bench::fail("check_json_output", "buffer: \"%s\" != \"%s\"", buffer, expected);
+  };
+
+  rs_builder_t builder;
+  rs_builder_init(&builder, 0);
+  rs_sink_init_builder(&sink, &builder);
+  rs_json_init(&json, &sink);
+  bool done = payloadWrite(&json, 7);
+  char* str = rs_builder_detach(&builder);
+  if (!done || (str == nullptr) || (strcmp(str, expected) != 0)) ok = bench::fail("check_json_output", "builder: \"%s\"", str ? str : "(null)");
+  rs_free(str);
+
+  // Control characters
+  rs_sink_init_buffer(&sink, &target, buffer, sizeof(buffer));
+  rs_json_init(&json, &sink);
+  rs_json_stringl(&json, nullptr, "a\0b\x1f\t\\/\xd0\x96", 9);
+  if (!rs_json_finish(&json) || (strcmp(buffer, "\"a\\u0000b\\u001f\\t\\\\/\xd0\x96\"") != 0)) {
+    ok = bench::fail("check_json_output", "escape: %s", buffer);
+  };
+  return ok;
+}
+
+BENCH_CHECK(check_json_overflow)
+{
+  bool ok = true;
+  char expected[512], buffer[512];
+  size_t len = strlen(payloadExpected(expected, sizeof(expected), 123));
+  for (size_t size = 1; size <= len + 1; size++) {
+    rs_sink_buffer_t target;
+    rs_sink_t sink;
+    rs_json_t json;
+    rs_sink_init_buffer(&sink, &target, buffer, size);
+    rs_json_init(&json, &sink);
+    bool done = payloadWrite(&json, 123);
+    if ((done != (size == len + 1)) || (strncmp(buffer, expected, size - 1) != 0) || (strlen(buffer) != size - 1)) {
+      ok = bench::fail("check_json_overflow", "size %u: %s, \"%s\"", (unsigned)size, done ? "done" : "failed", buffer);
+    };
+  };
+  return ok;
+}
+
+BENCH_CHECK(check_json_misuse)
+{
+  char buffer[64];
+  rs_sink_buffer_t target;
+  rs_sink_t sink;
+  rs_json_t json;
+  bool ok = true;
+
+  rs_sink_init_buffer(&sink, &target, buffer, sizeof(buffer));
+  rs_json_init(&json, &sink);
+  rs_json_object_begin(&json, nullptr);
+  if (rs_json_int(&json, nullptr, 1) || rs_json_finish(&json)) ok = bench::fail("check_json_misuse", "value without a key");
+
+  rs_sink_init_buffer(&sink, &target, buffer, sizeof(buffer));
+  rs_json_init(&json, &sink);
+  rs_json_array_begin(&json, nullptr);
+  if (rs_json_int(&json, "key", 1) || rs_json_finish(&json)) ok = bench::fail("check_json_misuse", "key in an array");
+
+  rs_sink_init_buffer(&sink, &target, buffer, sizeof(buffer));
+  rs_json_init(&json, &sink);
+  rs_json_array_begin(&json, nullptr);
+  if (rs_json_object_end(&json) || rs_json_finish(&json)) ok = bench::fail("check_json_misuse", "wrong container closed");
+
+  rs_sink_init_buffer(&sink, &target, buffer, sizeof(buffer));
+  rs_json_init(&json, &sink);
+  rs_json_array_begin(&json, nullptr);
+  if (rs_json_finish(&json)) ok = bench::fail("check_json_misuse", "open container");
+  return ok;
+}
+
+// -----------------------------------------------------------------------------------------------------------------------
+// ---------------------------------------------------- Benchmarks -------------------------------------------------------
+// -----------------------------------------------------------------------------------------------------------------------
+
+// The same payload as chains of heap strings
+static char* payloadHeap(int seq)
+{
+  time_t value = payloadTime;
+  char time[64];
+  time2str("%d.%m.%Y %H:%M:%S", &value, time, sizeof(time));
+  char* climate = malloc_stringf("{\"temperature\":%.2f,\"humidity\":%.1f,\"heater\":%s,\"dew_point\":null}",
+    21.456, 635.0, "true");
+  char* relays = malloc_stringf("[%llu,%d,null,[],{}]", 18446744073709551615ULL, -42);
+  char* head = malloc_stringf("{\"device\":\"%s\",\"seq\":%d,\"time\":\"%s\",\"climate\":", "greenhouse \\\"north\\\"\\n", seq, time);
+  char* ret = concat_strings(head, climate);
+  ret = concat_strings(ret, malloc_string(",\"relays\":"));
+  ret = concat_strings(ret, relays);
+  return concat_strings(ret, malloc_string(",\"extra\":{\"a\":1}}"));
+}
+
+BENCH(json_payload_heap_strings)
+{
+  int seq = 0;
+  while (state.next()) {
+    char* payload = payloadHeap(seq++);
+    bench::doNotOptimize(payload);
+    free(payload);
+  };
+}
+
+BENCH(json_payload_writer_buffer)
+{
+  char buffer[512];
+  int seq = 0;
+  while (state.next()) {
+    rs_sink_buffer_t target;
+    rs_sink_t sink;
+    rs_json_t json;
+    rs_sink_init_buffer(&sink, &target, buffer, sizeof(buffer));
+    rs_json_init(&json, &sink);
+    payloadWrite(&json, seq++);
+    bench::doNotOptimize(buffer);
+  };
+}
+
+BENCH(json_payload_writer_builder)
+{
+  int seq = 0;
+  while (state.next()) {
+    rs_builder_t builder;
+    rs_builder_init(&builder, 256);
+    rs_sink_t sink;
+    rs_json_t json;
+    rs_sink_init_builder(&sink, &builder);
+    rs_json_init(&json, &sink);
+    payloadWrite(&json, seq++);
+    char* payload = rs_builder_detach(&builder);
+    bench::doNotOptimize(payload);
+    rs_free(payload);
+  };
+}
@@ -0,0 +1,139 @@
+/*
+   EN: Parsing incoming topics: round trip with the topic builders and benchmarks
+   RU: Разбор входящих топиков: обратное преобразование для генераторов топиков и замеры
+*/
+
+#include "bench.h"
+#include "rStrings.h"
+#include "rStringsTopics.h"
+#include <random>
+#include <stdlib.h>
+#include <string.h>
+
+static const char* const specials[] = { "config", "system", "security" };
+static const uint8_t specialsCount = sizeof(specials) / sizeof(specials[0]);
+static const char* const words[] = { "heater", "status", "temperature", "boiler", "pump", "a", "set" };
+
+static bool checkParts(const char* check, const char* topic, const mqtt_topic_parts_t& parts, const char* header,
+  int special, const char* const* segments, uint8_t count)
+{
+  // The reported header must be the one used (equal headers of other brokers are allowed)
+  const char* reported = mqttGetTopicHeader(parts.primary, parts.local, parts.kind);
+  if ((strcmp(reported, header) != 0) || (parts.header_len != strlen(header))) {
+    return bench::fail(check, "\"%s\": header \"%s\" != \"%s\"", topic, reported, header);
+  };
+  if ((parts.special != special) || (parts.count != count) || parts.truncated) {
+    return bench::fail(check, "\"%s\": special %d / %d, count %u / %u", topic, parts.special, special, parts.count, count);
+  };
+  for (uint8_t i = 0; i < count; i++) {
+    if (!mqttSegmentEquals(topic, parts.segments[i], segments[i])) {
+      return bench::fail(check, "\"%s\": segment %u != \"%s\"", topic, i, segments[i]);
+    };
+  };
+  return true;
+}
+
+BENCH_CHECK(check_parse_round_trip)
+{
+  std::mt19937 random(42);
+  for (int i = 0; i < 20000; i++) {
+    bool primary = random() % 2;
+    bool local = random() % 2;
+    int mode = random() % 3;
+    const char* t[3] = { words[random() % 7], words[random() % 7], words[random() % 7] };
+    char* topic = nullptr;
+    const char* header = nullptr;
+    int special = -1;
+    switch (mode) {
+      case 0:
+        topic = mqttGetTopicLocation3(primary, local, t[0], t[1], t[2]);
+        header = mqttGetTopicHeader(primary, local, MQTT_HEADER_LOCATION);
+        break;
+      case 1:
+        special = random() % specialsCount;
+        topic = mqttGetTopicSpecial3(primary, local, specials[special], t[0], t[1], t[2]);
+        header = mqttGetTopicHeader(primary, local, MQTT_HEADER_LOCATION);
+        break;
+      default:
+        topic = mqttGetTopicDevice3(primary, local, t[0], t[1], t[2]);
+        header = mqttGetTopicHeader(primary, local, MQTT_HEADER_DEVICE);
+        break;
+    };
+    mqtt_topic_parts_t parts;
+    bool ok = mqttParseTopic(topic, strlen(topic), specials, specialsCount, &parts)
+      && checkParts("check_parse_round_trip", topic, parts, header, special, t, 3);
+    free(topic);
+    if (!ok) return false;
+  };
+  return true;
+}
+
+BENCH_CHECK(check_parse_cases)
+{
+  mqtt_topic_parts_t parts;
+  const char* foreign = "other/house/heater";
+  if (mqttParseTopic(foreign, strlen(foreign), specials, specialsCount, &parts)) {
+    return bench::fail("check_parse_cases", "foreign topic was parsed");
+  };
+  // Device topics are never split into a special segment
+  char* device = mqttGetTopicDevice2(true, false, "config", "mode");
+  const char* deviceSegments[] = { "config", "mode" };
+  bool ok = mqttParseTopic(device, strlen(device), specials, specialsCount, &parts)
+    && checkParts("check_parse_cases", device, parts, mqttGetTopicHeader(true, false, MQTT_HEADER_DEVICE), -1, deviceSegments, 2);
+  free(device);
+  if (!ok) return false;
+  // Long topics: the last view holds the rest, the buffer is not zero terminated
+  char* deep = mqttGetTopicLocation1(true, true, "a/b/c/d/e/f/g/h/i/j");
+  size_t len = strlen(deep);
+  char buffer[64];
+  memcpy(buffer, deep, len);
+  buffer[len] = '#';
+  ok = mqttParseTopic(buffer, len, nullptr, 0, &parts) && parts.truncated && (parts.count == MQTT_TOPIC_MAX_SEGMENTS);
+  char rest[16];
+  ok = ok && (mqttSegmentCopy(buffer, parts.segments[MQTT_TOPIC_MAX_SEGMENTS - 1], rest, sizeof(rest)) == 5) && (strcmp(rest, "h/i/j") == 0);
+  free(deep);
+  if (!ok) return bench::fail("check_parse_cases", "truncated topic");
+  // The index of the special segment must fit into int8_t
+  const char* many[INT8_MAX + 1];
+  for (size_t i = 0; i <= INT8_MAX; i++) many[i] = "config";
+  char* special = mqttGetTopicSpecial1(true, false, "config", "mode");
+  ok = mqttParseTopic(special, strlen(special), many, INT8_MAX, &parts) && (parts.special == 0)
+    && !mqttParseTopic(special, strlen(special), many, INT8_MAX + 1, &parts);
+  free(special);
+  return ok ? true : bench::fail("check_parse_cases", "too many specials");
+}
+
+BENCH(parse_topic_special)
+{
+  char* topic = mqttGetTopicSpecial2(true, false, "config", "heater", "mode");
+  size_t len = strlen(topic);
+  mqtt_topic_parts_t parts;
+  while (state.next()) {
+    bench::doNotOptimize(mqttParseTopic(topic, len, specials, specialsCount, &parts));
+    bench::clobberMemory();
+  };
+  free(topic);
+}
+
+// The code being replaced: copy, split with strtok_r and duplicate every segment
+BENCH(parse_topic_strtok_strdup)
+{
+  char* topic = mqttGetTopicSpecial2(true, false, "config", "heater", "mode");
+  const char* header = mqttGetTopicHeader(true, false, MQTT_HEADER_LOCATION);
+  size_t header_len = strlen(header);
+  while (state.next()) {
+    char* copy = strdup(topic);
+    char* items[MQTT_TOPIC_MAX_SEGMENTS];
+    size_t count = 0;
+    if (strncmp(copy, header, header_len) == 0) {
+      char* save = nullptr;
+      for (char* item = strtok_r(copy + header_len, "/", &save); item && (count < MQTT_TOPIC_MAX_SEGMENTS); item = strtok_r(nullptr, "/", &save)) {
+        items[count++] = strdup(item);
+      };
+    };
+    bench::doNotOptimize(items);
+    for (size_t i = 0; i < count; i++) free(items[i]);
+    free(copy);
+  };
+  free(topic);
+}
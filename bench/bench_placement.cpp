@@ -0,0 +1,132 @@
+/*
+   EN: Placement policy: checks of the tier choice and a simulation of a publish cycle with ESP32-like tier costs
+   RU: Политика размещения: проверки выбора области памяти и моделирование цикла публикации со стоимостью как на ESP32
+   --------------------------
+   placement_* cases spend the time estimated by the cost model after the real work, so ns/op includes
+   the simulated memory access. Change the costs below to the measured ones of the target to tune the policy.
+*/
+
+#include "bench.h"
+#include "rStrings.h"
+#include <chrono>
+#include <string.h>
+
+BENCH_CHECK(check_placement_policy)
+{
+  rs_placement_config_t config = { 32, 128, 200, { 0, 0 }, { 0, 0 } };
+  rs_placement_t* placement = rs_placement_create(&config);
+  rs_allocator_t allocator;
+  rs_placement_allocator(placement, &allocator);
+  rs_set_allocator(&allocator);
+  bool ok = true;
+
+  // By size and by hint
+  char* small = malloc_string("status");
+  char* large = malloc_stringf("%64s", "x");
+  if ((rs_placement_tier(placement, small) != RS_TIER_INTERNAL) || (rs_placement_tier(placement, large) != RS_TIER_PSRAM)) {
+    ok = bench::fail("check_placement_policy", "placement by size");
+  };
+  char* topic;
+  char* config_value;
+  {
+    rs::alloc_hint hint(RS_HINT_TRANSIENT);
+    topic = mqttGetTopicDevice2(true, false, "heater", "status");
+  };
+  {
+    rs::alloc_hint hint(RS_HINT_LONG_LIVED);
+    config_value = malloc_string("on");
+  };
+  if (rs_get_alloc_hint() != RS_HINT_AUTO) ok = bench::fail("check_placement_policy", "hint was not restored");
+  if ((rs_placement_tier(placement, topic) != RS_TIER_INTERNAL) || (rs_placement_tier(placement, config_value) != RS_TIER_PSRAM)) {
+    ok = bench::fail("check_placement_policy", "placement by hint");
+  };
+
+  // The budget of internal RAM: status, the topic and 100 bytes fit, the next 100 bytes do not
+  void* first = rs_placement_alloc(placement, 100, RS_HINT_TRANSIENT);
+  void* second = rs_placement_alloc(placement, 100, RS_HINT_TRANSIENT);
+  if ((rs_placement_tier(placement, first) != RS_TIER_INTERNAL) || (rs_placement_tier(placement, second) != RS_TIER_PSRAM)) {
+    ok = bench::fail("check_placement_policy", "internal budget");
+  };
+
+  // A block grows within its tier
+  small = (char*)rs_realloc(small, 200);
+  if (rs_placement_tier(placement, small) != RS_TIER_INTERNAL) ok = bench::fail("check_placement_policy", "realloc changed the tier");
+
+  rs_tier_stats_t internal, psram;
+  rs_placement_get_stats(placement, RS_TIER_INTERNAL, &internal);
+  rs_placement_get_stats(placement, RS_TIER_PSRAM, &psram);
+  if ((internal.allocs != 4) || (internal.fallbacks != 1) || (psram.allocs != 3) || (internal.current != 200 + strlen(topic) + 1 + 100)
+   || (psram.current != 65 + 3 + 100)) {
+    ok = bench::fail("check_placement_policy", "internal: allocs = %u, fallbacks = %u, current = %u; psram: allocs = %u, current = %u",
+      internal.allocs, internal.fallbacks, (unsigned)internal.current, psram.allocs, (unsigned)psram.current);
+  };
+
+  rs_free(small);
+  rs_free(large);
+  rs_free(topic);
+  rs_free(config_value);
+  rs_free(first);
+  rs_free(second);
+  rs_placement_get_stats(placement, RS_TIER_INTERNAL, &internal);
+  rs_placement_get_stats(placement, RS_TIER_PSRAM, &psram);
+  if ((internal.current != 0) || (psram.current != 0) || (internal.frees != 4) || (psram.frees != 3)) {
+    ok = bench::fail("check_placement_policy", "blocks outstanding after release");
+  };
+  rs_set_allocator(nullptr);
+  rs_placement_delete(placement);
+  return ok;
+}
+
+// -----------------------------------------------------------------------------------------------------------------------
+// ---------------------------------------------------- Simulation -------------------------------------------------------
+// -----------------------------------------------------------------------------------------------------------------------
+
+// Rough ESP32 figures: internal SRAM about one cycle per byte at 240 MHz, PSRAM through the cache on misses
+// (40 MHz quad SPI), and a slower heap for the larger and more fragmented PSRAM region
+#define SIM_COST_ALLOC_NS { 600, 1100 }
+#define SIM_COST_BYTE_PS  { 4200, 25000 }
+
+static const char* const sensors[] = { "heater", "boiler", "outdoor", "greenhouse", "water_tank", "pump" };
+
+// Transient topics and values of every publish, and a long-lived cached value replaced now and then
+static void placementRun(bench::State& state, size_t internal_max, size_t transient_max, bool hints)
+{
+  rs_placement_config_t config = { internal_max, transient_max, 0, SIM_COST_ALLOC_NS, SIM_COST_BYTE_PS };
+  rs_placement_t* placement = rs_placement_create(&config);
+  rs_allocator_t allocator;
+  rs_placement_allocator(placement, &allocator);
+  rs_set_allocator(&allocator);
+  char* cached = nullptr;
+  uint64_t i = 0;
+  while (state.next()) {
+    rs_alloc_hint_t prev = rs_set_alloc_hint(hints ? RS_HINT_TRANSIENT : RS_HINT_AUTO);
+    char* topic = mqttGetTopicDevice2(true, false, sensors[i % 6], "status");
+    char* value = malloc_stringf("{\"value\":%d,\"status\":\"%s\"}", (int)i, i & 1 ? "on" : "off");
+    bench::doNotOptimize(topic);
+    bench::doNotOptimize(value);
+    rs_free(topic);
+    rs_free(value);
+    if ((i & 15) == 0) {
+      rs_set_alloc_hint(hints ? RS_HINT_LONG_LIVED : RS_HINT_AUTO);
+      rs_free(cached);
+      cached = malloc_stringf("%s: mode=%d, setpoint=%d.%d", sensors[i % 6], (int)(i & 3), 20 + (int)(i % 7), (int)(i % 10));
+    };
+    rs_set_alloc_hint(prev);
+    i++;
+  };
+  rs_free(cached);
+
+  // The estimated memory time is spent after the real work
+  rs_tier_stats_t internal, psram;
+  rs_placement_get_stats(placement, RS_TIER_INTERNAL, &internal);
+  rs_placement_get_stats(placement, RS_TIER_PSRAM, &psram);
+  auto stop = std::chrono::steady_clock::now() + std::chrono::nanoseconds(internal.cost_ns + psram.cost_ns);
+  while (std::chrono::steady_clock::now() < stop) bench::clobberMemory();
+
+  rs_set_allocator(nullptr);
+  rs_placement_delete(placement);
+}
+
+BENCH(placement_all_psram) { placementRun(state, 0, 0, false); }
+BENCH(placement_size_64) { placementRun(state, 64, 64, false); }
+BENCH(placement_hints) { placementRun(state, 64, 256, true); }
@@ -0,0 +1,81 @@
+/* 
+   EN: Sink output versus heap strings copied into a consumer buffer
+   RU: Вывод в sink в сравнении с копированием строк из кучи в буфер получателя
+*/
+
+#include "bench.h"
+#include "rStrings.h"
+#include "rStringsSink.h"
+#include <stdlib.h>
+#include <string.h>
+
+BENCH_CHECK(check_sink_output)
+{
+  char buffer[160];
+  rs_sink_buffer_t target;
+  rs_sink_t sink;
+  rs_sink_init_buffer(&sink, &target, buffer, sizeof(buffer));
+  const char* parts[] = { "heater", nullptr, "status" };
+  time_t zero = 0;
+  mqttSinkTopic(&sink, true, false, MQTT_HEADER_LOCATION, "climate", parts, 3);
+  sink_write(&sink, " ", 1);
+  sink_stringf(&sink, "%.2f", 21.5);
+  sink_write(&sink, " ", 1);
+  sink_timespan_dhms(&sink, 90061);
+  sink_write(&sink, " ", 1);
+  sink_time2str_empty(&sink, "%H:%M", &zero);
+  char* topic = mqttGetTopicSpecial2(true, false, "climate", "heater", "status");
+  char* span = malloc_timespan_dhms(90061);
+  char* expected = malloc_stringf("%s 21.50 %s %s", topic, span, "--.--.---- --:--:--");
+  bool ok = !sink.failed && (strcmp(buffer, expected) == 0) && (sink.written == strlen(expected));
+  if (!ok) bench::fail("check_sink_output", "\"%s\" != \"%s\"", buffer, expected);
+  free(topic);
+  free(span);
+  free(expected);
+  return ok;
+}
+
+BENCH_CHECK(check_sink_overflow)
+{
+  char buffer[8];
+  rs_sink_buffer_t target;
+  rs_sink_t sink;
+  rs_sink_init_buffer(&sink, &target, buffer, sizeof(buffer));
+  char longer[300];
+  memset(longer, 'z', sizeof(longer) - 1);
+  longer[sizeof(longer) - 1] = '\0';
+  bool ok = sink_string(&sink, "0123") && !sink_stringf(&sink, "%s", longer) && sink.failed
+         && (strcmp(buffer, "0123zzz") == 0) && !sink_string(&sink, "x");
+  return ok ? true : bench::fail("check_sink_overflow", "\"%s\"", buffer);
+}
+
+// A message is assembled into an outbox buffer: topic and value
+BENCH(outbox_heap_strings)
+{
+  char outbox[256];
+  while (state.next()) {
+    char* topic = mqttGetTopicDevice2(true, false, "heater", "temperature");
+    char* value = malloc_stringf("%.2f", 21.5);
+    size_t tlen = strlen(topic), vlen = strlen(value);
+    memcpy(outbox, topic, tlen + 1);
+    memcpy(outbox + 128, value, vlen + 1);
+    free(topic);
+    free(value);
+    bench::clobberMemory();
+  };
+}
+
+BENCH(outbox_sink)
+{
+  char outbox[256];
+  static const char* parts[] = { "heater", "temperature" };
+  while (state.next()) {
+    rs_sink_buffer_t target;
+    rs_sink_t sink;
+    rs_sink_init_buffer(&sink, &target, outbox, 128);
+    mqttSinkTopic(&sink, true, false, MQTT_HEADER_DEVICE, nullptr, parts, 2);
+    rs_sink_init_buffer(&sink, &target, outbox + 128, 128);
+    sink_stringf(&sink, "%.2f", 21.5);
+    bench::clobberMemory();
+  };
+}
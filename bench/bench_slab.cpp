@@ -0,0 +1,90 @@
+/* 
+   EN: Slab pool of fixed-size blocks behind the malloc_string* family
+   RU: Пул блоков фиксированного размера для функций malloc_string*
+*/
+
+#include "bench.h"
+#include "rStrings.h"
+#include <string.h>
+
+static const uint16_t slabBlocks[RS_SLAB_CLASSES] = { 16, 32, 16, 4 };
+
+BENCH_CHECK(check_slab_classes)
+{
+  rs_slab_t* slab = rs_slab_create(slabBlocks);
+  rs_allocator_t allocator;
+  rs_slab_allocator(slab, &allocator);
+  rs_set_allocator(&allocator);
+  char big[300];
+  memset(big, 'x', sizeof(big) - 1);
+  big[sizeof(big) - 1] = '\0';
+  char* topic = mqttGetTopicDevice2(true, false, "heater", "status");  // 44 bytes -> 64 class
+  char* value = malloc_stringf("%.2f", 21.5);                          // 6 bytes  -> 32 class
+  char* large = malloc_string(big);                                    // 300 bytes -> heap
+  char* grown = (char*)rs_realloc(rs_malloc(20), 100);                 // 32 -> 128 class
+  rs_slab_class_stats_t stats[RS_SLAB_CLASSES];
+  for (uint8_t i = 0; i < RS_SLAB_CLASSES; i++) rs_slab_get_stats(slab, i, &stats[i]);
+  bool ok = (stats[0].used == 1) && (stats[0].hits == 2) && (stats[1].used == 1) && (stats[2].used == 1)
+         && (rs_slab_oversize(slab) == 1) && (strcmp(topic, "kotyara12/village/boiler_room/heater/status") == 0);
+  rs_free(topic);
+  rs_free(value);
+  rs_free(large);
+  rs_free(grown);
+  for (uint8_t i = 0; i < RS_SLAB_CLASSES; i++) {
+    rs_slab_get_stats(slab, i, &stats[i]);
+    if (stats[i].used != 0) ok = false;
+  };
+  rs_set_allocator(nullptr);
+  rs_slab_delete(slab);
+  if (!ok) bench::fail("check_slab_classes", "unexpected occupancy");
+  return ok;
+}
+
+BENCH_CHECK(check_slab_miss_falls_back)
+{
+  const uint16_t blocks[RS_SLAB_CLASSES] = { 1, 0, 0, 0 };
+  rs_slab_t* slab = rs_slab_create(blocks);
+  rs_allocator_t allocator;
+  rs_slab_allocator(slab, &allocator);
+  rs_set_allocator(&allocator);
+  char* s1 = malloc_string("first");
+  char* s2 = malloc_string("second");
+  rs_slab_class_stats_t stats;
+  rs_slab_get_stats(slab, 0, &stats);
+  bool ok = s1 && s2 && (stats.hits == 1) && (stats.misses == 1) && (strcmp(s2, "second") == 0);
+  rs_free(s1);
+  rs_free(s2);
+  rs_set_allocator(nullptr);
+  rs_slab_delete(slab);
+  return ok ? true : bench::fail("check_slab_miss_falls_back", "hits = %u, misses = %u", stats.hits, stats.misses);
+}
+
+BENCH(slab_mqttGetTopicDevice2)
+{
+  rs_slab_t* slab = rs_slab_create(slabBlocks);
+  rs_allocator_t allocator;
+  rs_slab_allocator(slab, &allocator);
+  rs_set_allocator(&allocator);
+  while (state.next()) {
+    char* s = mqttGetTopicDevice2(true, false, "heater", "status");
+    bench::doNotOptimize(s);
+    rs_free(s);
+  };
+  rs_set_allocator(nullptr);
+  rs_slab_delete(slab);
+}
+
+BENCH(slab_malloc_string_short)
+{
+  rs_slab_t* slab = rs_slab_create(slabBlocks);
+  rs_allocator_t allocator;
+  rs_slab_allocator(slab, &allocator);
+  rs_set_allocator(&allocator);
+  while (state.next()) {
+    char* s = malloc_string("temperature");
+    bench::doNotOptimize(s);
+    rs_free(s);
+  };
+  rs_set_allocator(nullptr);
+  rs_slab_delete(slab);
+}
@@ -0,0 +1,190 @@
+/*
+   EN: Small strings: checks against the heap builders and benchmarks
+   RU: Короткие строки: сверка с построителями в куче и замеры
+*/
+
+#include "bench.h"
+#include "rStrings.h"
+#include "rStringsSmall.h"
+#include <stdlib.h>
+#include <string.h>
+#include <utility>
+
+static bool sameString(const char* check, const char* what, const rstr_t* actual, const char* expected)
+{
+  if ((expected == nullptr) || (strcmp(rstr_c_str(actual), expected) != 0) || (rstr_len(actual) != strlen(expected))) {
+    return bench::fail(check, "%s: \"%s\" (%u), expected \"%s\"", what, rstr_c_str(actual), (unsigned)rstr_len(actual),
+      expected ? expected : "(null)");
+  };
+  return true;
+}
+
+BENCH_CHECK(check_rstr_storage)
+{
+  bool ok = true;
+  rstr_t s = RSTR_INIT;
+  if ((rstr_len(&s) != 0) || (rstr_c_str(&s)[0] != 0) || !rstr_is_inline(&s)) ok = bench::fail("check_rstr_storage", "RSTR_INIT is not empty");
+
+  // The boundary between the inline and the heap storage
+  char text[64];
+  for (size_t len = 0; len < sizeof(text); len++) {
+    memset(text, 'a' + len % 26, len);
+    text[len] = 0;
+    bench::HeapCounters before = bench::heapCounters();
+    rstr_set(&s, text);
+    bench::HeapCounters after = bench::heapCounters();
+    ok = sameString("check_rstr_storage", "set", &s, text) && ok;
+    if (rstr_is_inline(&s) != (len <= RSTR_INLINE_MAX)) ok = bench::fail("check_rstr_storage", "length %u: wrong storage", (unsigned)len);
+    if ((len <= RSTR_INLINE_MAX) && (after.mallocs != before.mallocs)) ok = bench::fail("check_rstr_storage", "length %u: heap used", (unsigned)len);
+  };
+
+  // Setting from its own content, both inline and heap
+  rstr_set(&s, "inline value");
+  rstr_set(&s, rstr_c_str(&s) + 7);
+  ok = sameString("check_rstr_storage", "self inline", &s, "value") && ok;
+  rstr_set(&s, "a string that is too long to be stored inline");
+  rstr_set(&s, rstr_c_str(&s) + 2);
+  ok = sameString("check_rstr_storage", "self heap", &s, "string that is too long to be stored inline") && ok;
+
+  // Moving and detaching
+  rstr_t d = RSTR_INIT;
+  rstr_move(&d, &s);
+  ok = sameString("check_rstr_storage", "move", &d, "string that is too long to be stored inline") && ok;
+  ok = sameString("check_rstr_storage", "moved from", &s, "") && ok;
+  char* detached = rstr_detach(&d);
+  if ((detached == nullptr) || strcmp(detached, "string that is too long to be stored inline") != 0) ok = bench::fail("check_rstr_storage", "detach heap");
+  rs_free(detached);
+  rstr_set(&d, "short");
+  detached = rstr_detach(&d);
+  if ((detached == nullptr) || strcmp(detached, "short") != 0) ok = bench::fail("check_rstr_storage", "detach inline");
+  rs_free(detached);
+  ok = sameString("check_rstr_storage", "detached", &d, "") && ok;
+
+  // C++ wrapper
+  rs::rstr a("a string that is too long to be stored inline");
+  rs::rstr b = std::move(a);
+  if (!a.empty() || (b.length() != 45) || b.is_inline()) ok = bench::fail("check_rstr_storage", "rs::rstr move");
+  b = rs::rstr("x");
+  if ((strcmp(b, "x") != 0) || !b.is_inline()) ok = bench::fail("check_rstr_storage", "rs::rstr assign");
+  return ok;
+}
+
+BENCH_CHECK(check_rstr_builders)
+{
+  bool ok = true;
+  rstr_t s = RSTR_INIT;
+
+  // Format, on both sides of the boundary
+  for (int width = 0; width < 40; width++) {
+    char* expected = malloc_stringf("%*d|%s", width, width, "x");
+    rstr_format(&s, "%*d|%s", width, width, "x");
+    ok = sameString("check_rstr_builders", "format", &s, expected) && ok;
+    rs_free(expected);
+  };
+
+  // Self-append: the arguments point into the string, inline and on the heap
+  rstr_set(&s, "heater");
+  rstr_format(&s, "%s/x", rstr_c_str(&s));
+  ok = sameString("check_rstr_builders", "self inline", &s, "heater/x") && ok;
+  rstr_set(&s, "greenhouse/temperature/value");
+  rstr_format(&s, "%s/%s", rstr_c_str(&s), rstr_c_str(&s));
+  ok = sameString("check_rstr_builders", "self heap", &s, "greenhouse/temperature/value/greenhouse/temperature/value") && ok;
+  const char* self[] = { rstr_c_str(&s) };
+  char* expected = mqttGetTopic(true, false, MQTT_HEADER_DEVICE, nullptr, self, 1);
+  rstr_topic(&s, true, false, MQTT_HEADER_DEVICE, nullptr, self, 1);
+  ok = sameString("check_rstr_builders", "self topic", &s, expected) && ok;
+  rs_free(expected);
+
+  // Time
+  time_t value = 1634400000;
+  char buffer[64];
+  const char* formats[] = { "%H:%M", "%d.%m.%Y %H:%M:%S", "%A, %d %B %Y %H:%M:%S" };
+  for (const char* format: formats) {
+    time2str(format, &value, buffer, sizeof(buffer));
+    rstr_time(&s, format, value);
+    ok = sameString("check_rstr_builders", "time", &s, buffer) && ok;
+  };
+
+  // Time spans
+  const int64_t spans[] = { 0, 59, 3600, 86399, -90061, 31536000000LL };
+  for (int64_t span: spans) {
+    char* expected = malloc_timespan(span, RS_TIMESPAN_SECONDS, RS_TIMESPAN_DHMS);
+    rstr_timespan(&s, span, RS_TIMESPAN_SECONDS, RS_TIMESPAN_DHMS);
+    ok = sameString("check_rstr_builders", "timespan", &s, expected) && ok;
+    rs_free(expected);
+    expected = malloc_timespan(span, RS_TIMESPAN_MICROSECONDS, RS_TIMESPAN_HMS);
+    rstr_timespan(&s, span, RS_TIMESPAN_MICROSECONDS, RS_TIMESPAN_HMS);
+    ok = sameString("check_rstr_builders", "timespan us", &s, expected) && ok;
+    rs_free(expected);
+  };
+
+  // Topics: short ones stay inline with the default headers
+  const char* segments[] = { "heater", "status", "temperature" };
+  for (uint8_t count = 0; count <= 3; count++) {
+    for (uint8_t i = 0; i < 8; i++) {
+      bool primary = (i & 4) == 0, local = (i & 2) == 0;
+      mqtt_header_t kind = (i & 1) ? MQTT_HEADER_DEVICE : MQTT_HEADER_LOCATION;
+      char* expected = mqttGetTopic(primary, local, kind, count == 2 ? "config" : nullptr, segments, count);
+      rstr_topic(&s, primary, local, kind, count == 2 ? "config" : nullptr, segments, count);
+      ok = sameString("check_rstr_builders", "topic", &s, expected) && ok;
+      rs_free(expected);
+    };
+  };
+
+  rstr_free(&s);
+  return ok;
+}
+
+// -----------------------------------------------------------------------------------------------------------------------
+// ---------------------------------------------------- Benchmarks -------------------------------------------------------
+// -----------------------------------------------------------------------------------------------------------------------
+
+// Compare with malloc_timespan_dhms (bench_timespan.cpp)
+BENCH(rstr_timespan_dhms)
+{
+  int64_t value = 90061;
+  while (state.next()) {
+    rs::rstr s = rs::rstr::timespan(value++);
+    bench::doNotOptimize(s.c_str());
+  };
+}
+
+BENCH(malloc_stringf_short)
+{
+  int value = 0;
+  while (state.next()) {
+    char* s = malloc_stringf("%d.%d", value / 10, value % 10);
+    bench::doNotOptimize(s);
+    rs_free(s);
+    value++;
+  };
+}
+
+BENCH(rstr_format_short)
+{
+  int value = 0;
+  while (state.next()) {
+    rs::rstr s = rs::rstr::format("%d.%d", value / 10, value % 10);
+    bench::doNotOptimize(s.c_str());
+    value++;
+  };
+}
+
+// Topics are usually longer than RSTR_INLINE_MAX: the same single allocation as mqttGetTopicDevice1
+BENCH(mqttGetTopicDevice1_heap)
+{
+  while (state.next()) {
+    char* s = mqttGetTopicDevice1(true, true, "status");
+    bench::doNotOptimize(s);
+    rs_free(s);
+  };
+}
+
+BENCH(rstr_topic_device1)
+{
+  const char* segments[] = { "status" };
+  while (state.next()) {
+    rs::rstr s = rs::rstr::topic(true, true, MQTT_HEADER_DEVICE, nullptr, segments, 1);
+    bench::doNotOptimize(s.c_str());
+  };
+}
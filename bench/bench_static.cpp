@@ -0,0 +1,43 @@
+/* 
+   EN: Compile-time topics versus runtime topic generation
+   RU: Топики, собранные при компиляции, в сравнении с генерацией во время работы
+*/
+
+#include "bench.h"
+#include "rStrings.h"
+#include "rStringsStatic.h"
+#include <stdlib.h>
+#include <string.h>
+
+static constexpr auto topicStatus = rs::mqttStaticTopicDevice<true, false>("heater", "status");
+static constexpr auto topicHumidity = rs::mqttStaticTopicLocation<false, true>("outdoor", "humidity");
+static constexpr auto topicSpecial = rs::mqttStaticTopicSpecial<true, true>("climate", "heater", "status", "value");
+
+static_assert(topicStatus.size() == sizeof(MQTT1_PUB_HEADER_DEVICE "heater/status") - 1, "Wrong compile-time topic length");
+static_assert(topicStatus.c_str()[topicStatus.size()] == '\0', "Compile-time topic must end with a zero");
+
+BENCH_CHECK(check_static_topics)
+{
+  char* e1 = mqttGetTopicDevice2(true, false, "heater", "status");
+  char* e2 = mqttGetTopicLocation2(false, true, "outdoor", "humidity");
+  char* e3 = mqttGetTopicSpecial3(true, true, "climate", "heater", "status", "value");
+  bool ok = (strcmp(topicStatus, e1) == 0) && (strcmp(topicHumidity, e2) == 0) && (strcmp(topicSpecial, e3) == 0)
+         && (strlen(topicSpecial.c_str()) == topicSpecial.size());
+  if (!ok) bench::fail("check_static_topics", "\"%s\", \"%s\", \"%s\"", topicStatus.c_str(), topicHumidity.c_str(), topicSpecial.c_str());
+  free(e1);
+  free(e2);
+  free(e3);
+  return ok;
+}
+
+BENCH(static_topic_with_dynamic_segment)
+{
+  static const char* const params[] = { "status", "temperature", "humidity", "mode" };
+  static constexpr auto header = rs::mqttStaticTopicDevice<true, false>("heater");
+  size_t i = 0;
+  while (state.next()) {
+    char* s = mqttGetSubTopic(header, params[i++ & 3]);
+    bench::doNotOptimize(s);
+    free(s);
+  };
+}
@@ -0,0 +1,109 @@
+/*
+   EN: Allocation path under contention: per-task cache checks and a multi-thread stress benchmark
+   RU: Выделение памяти при конкуренции потоков: проверки кэша задач и многопоточный стресс-замер
+   --------------------------
+   stress_* cases split the iterations between N threads, so ns/op is the inverse of the total throughput:
+   with perfect scaling it halves when the number of threads doubles (as long as there are enough cores).
+   Note: the malloc counters of the harness are shared atomics and add some contention of their own.
+*/
+
+#include "bench.h"
+#include "rStrings.h"
+#include <stdlib.h>
+#include <string.h>
+#include <thread>
+#include <vector>
+
+BENCH_CHECK(check_tcache_reuse)
+{
+  rs_tcache_t* tcache = rs_tcache_create(nullptr, 4);
+  rs_allocator_t allocator;
+  rs_tcache_allocator(tcache, &allocator);
+  rs_set_allocator(&allocator);
+  bool ok = true;
+
+  // A freed block is reused by any request of its class
+  void* first = rs_malloc(40);
+  rs_free(first);
+  void* second = rs_malloc(60);
+  if (second != first) ok = bench::fail("check_tcache_reuse", "block was not reused");
+  rs_free(second);
+
+  // Lists are bounded: the blocks above the limit go back to the heap
+  void* blocks[6];
+  for (void*& block: blocks) block = rs_malloc(100);
+  for (void* block: blocks) rs_free(block);
+
+  // Blocks of an exited thread are returned to the heap
+  std::thread worker([]() {
+    for (int i = 0; i < 100; i++) {
+      char* topic = mqttGetTopicDevice2(true, false, "heater", "status");
+      char* value = malloc_stringf("%d", i);
+      rs_free(topic);
+      rs_free(value);
+    };
+  });
+  worker.join();
+
+  rs_tcache_flush(tcache);
+  rs_tcache_stats_t stats;
+  rs_tcache_get_stats(tcache, &stats);
+  rs_set_allocator(nullptr);
+  rs_tcache_delete(tcache);
+  if ((stats.overflows != 2) || (stats.cached != 0) || (stats.hits < 1 + 2 * 99)) {
+    ok = bench::fail("check_tcache_reuse", "hits = %u, misses = %u, overflows = %u, cached = %u",
+      stats.hits, stats.misses, stats.overflows, stats.cached);
+  };
+  return ok;
+}
+
+// -----------------------------------------------------------------------------------------------------------------------
+// ----------------------------------------------------- Stress ----------------------------------------------------------
+// -----------------------------------------------------------------------------------------------------------------------
+
+static const char* const sensors[] = { "heater", "boiler", "outdoor", "greenhouse", "water_tank", "pump" };
+static const char* const params[] = { "status", "temperature", "humidity", "mode", "state", "config" };
+
+// A publish cycle in miniature: a value, a topic and a concatenated payload
+static void stressWork(uint64_t ops)
+{
+  for (uint64_t i = 0; i < ops; i++) {
+    char* value = malloc_stringf("%s=%d", params[i % 6], (int)i);
+    char* topic = mqttGetTopicDevice2(true, false, sensors[i % 6], params[(i >> 3) % 6]);
+    char* payload = concat_strings_div(value, malloc_string("ok"), ";");
+    bench::doNotOptimize(topic);
+    bench::doNotOptimize(payload);
+    rs_free(topic);
+    rs_free(payload);
+  };
+}
+
+static void stressRun(bench::State& state, unsigned threads, bool cached)
+{
+  rs_tcache_t* tcache = nullptr;
+  rs_allocator_t allocator;
+  if (cached) {
+    tcache = rs_tcache_create(nullptr, 32);
+    rs_tcache_allocator(tcache, &allocator);
+    rs_set_allocator(&allocator);
+  };
+  uint64_t ops = (state.iterations() + threads - 1) / threads;
+  std::vector<std::thread> workers;
+  for (unsigned i = 0; i < threads; i++) {
+    workers.emplace_back(stressWork, ops);
+  };
+  for (auto& worker: workers) worker.join();
+  if (cached) {
+    rs_set_allocator(nullptr);
+    rs_tcache_delete(tcache);
+  };
+}
+
+#define BENCH_STRESS(threads) \
+  BENCH(stress_heap_##threads##t) { stressRun(state, threads, false); } \
+  BENCH(stress_tcache_##threads##t) { stressRun(state, threads, true); }
+
+BENCH_STRESS(1)
+BENCH_STRESS(2)
+BENCH_STRESS(4)
+BENCH_STRESS(8)
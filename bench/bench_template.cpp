@@ -0,0 +1,138 @@
+/*
+   EN: Templates: checks against snprintf and rendering versus printf formats
+   RU: Шаблоны: сверка с snprintf и вывод в сравнении с форматами printf
+*/
+
+#include "bench.h"
+#include "rStrings.h"
+#include "rStringsTemplate.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+BENCH_CHECK(check_template_render)
+{
+  bool ok = true;
+  rs_template_t* tpl = rs_template_compile("${location}/${device}/${sensor}/value ($$${sensor}$, $x)");
+  if ((tpl == nullptr) || (rs_template_arg_count(tpl) != 3) || (strcmp(rs_template_arg_name(tpl, 2), "sensor") != 0)
+   || (rs_template_arg_index(tpl, "device") != 1) || (rs_template_arg_index(tpl, "value") != -1)) {
+    rs_template_free(tpl);
+    return bench::fail("check_template_render", "compiled arguments");
+  };
+
+  const char* args[] = { "village", "greenhouse", "temperature" };
+  const char* expected = "village/greenhouse/temperature/value ($temperature$, $x)";
+  bench::HeapCounters before = bench::heapCounters();
+  char* str = rs_template_render_args(tpl, args, 3);
+  bench::HeapCounters after = bench::heapCounters();
+  if ((str == nullptr) || (strcmp(str, expected) != 0)) ok = bench::fail("check_template_render", "args: \"%s\"", str ? str : "(null)");
+  if ((after.mallocs - before.mallocs != 1) || (after.bytes - before.bytes != strlen(expected) + 1)) {
+    ok = bench::fail("check_template_render", "%u allocations of %u bytes", (unsigned)(after.mallocs - before.mallocs),
+      (unsigned)(after.bytes - before.bytes));
+  };
+  rs_free(str);
+
+  // Variables in any order, missing ones are empty
+  const rs_template_var_t vars[] = { { "sensor", "humidity" }, { "location", "home" }, { "unused", "-" } };
+  str = rs_template_render_vars(tpl, vars, 3);
+  if ((str == nullptr) || (strcmp(str, "home//humidity/value ($humidity$, $x)") != 0)) ok = bench::fail("check_template_render", "vars: \"%s\"", str ? str : "(null)");
+  rs_free(str);
+
+  // Buffer and sink
+  char buffer[128];
+  size_t len = strlen(expected);
+  if ((rs_template_format_args(tpl, args, 3, buffer, len + 1) != len) || (strcmp(buffer, expected) != 0)) ok = bench::fail("check_template_render", "format");
+  if ((rs_template_format_args(tpl, args, 3, buffer, len) != 0) || (buffer[0] != 0)) ok = bench::fail("check_template_render", "format overflow");
+  if (rs_template_length_vars(tpl, vars, 3) != strlen("home//humidity/value ($humidity$, $x)")) ok = bench::fail("check_template_render", "length");
+  rs_sink_buffer_t target;
+  rs_sink_t sink;
+  rs_sink_init_buffer(&sink, &target, buffer, sizeof(buffer));
+  if (!rs_template_sink_args(&sink, tpl, args, 3) || (strcmp(buffer, expected) != 0)) ok = bench::fail("check_template_render", "sink: \"%s\"", buffer);
+  rs_template_free(tpl);
+
+  // Literal only and empty templates
+  tpl = rs_template_compile("status");
+  str = rs_template_render_args(tpl, nullptr, 0);
+  if ((str == nullptr) || (strcmp(str, "status") != 0)) ok = bench::fail("check_template_render", "literal");
+  rs_free(str);
+  rs_template_free(tpl);
+  tpl = rs_template_compile("");
+  str = rs_template_render_args(tpl, nullptr, 0);
+  if ((str == nullptr) || (str[0] != 0)) ok = bench::fail("check_template_render", "empty");
+  rs_free(str);
+  rs_template_free(tpl);
+  return ok;
+}
+
+BENCH_CHECK(check_template_errors)
+{
+  bool ok = true;
+  const char* invalid[] = { "${location", "a/${}/b", "$${x}/${" };
+  for (const char* text: invalid) {
+    rs_template_t* tpl = rs_template_compile(text);
+    if (tpl) {
+      ok = bench::fail("check_template_errors", "\"%s\" compiled", text);
+      rs_template_free(tpl);
+    };
+  };
+  // Too many different names
+  char text[512] = "";
+  for (int i = 0; i <= RS_TEMPLATE_MAX_ARGS; i++) {
+    snprintf(text + strlen(text), sizeof(text) - strlen(text), "${a%d}", i);
+  };
+  rs_template_t* tpl = rs_template_compile(text);
+  if (tpl) {
+    ok = bench::fail("check_template_errors", "%d names compiled", RS_TEMPLATE_MAX_ARGS + 1);
+    rs_template_free(tpl);
+  };
+  return ok;
+}
+
+// -----------------------------------------------------------------------------------------------------------------------
+// ---------------------------------------------------- Benchmarks -------------------------------------------------------
+// -----------------------------------------------------------------------------------------------------------------------
+
+static const char* const templateArgs[] = { "village", "greenhouse", "temperature" };
+
+BENCH(template_malloc_stringf)
+{
+  while (state.next()) {
+    char* str = malloc_stringf("%s/%s/%s/value", templateArgs[0], templateArgs[1], templateArgs[2]);
+    bench::doNotOptimize(str);
+    rs_free(str);
+  };
+}
+
+BENCH(template_render_args)
+{
+  rs_template_t* tpl = rs_template_compile("${location}/${device}/${sensor}/value");
+  while (state.next()) {
+    char* str = rs_template_render_args(tpl, templateArgs, 3);
+    bench::doNotOptimize(str);
+    rs_free(str);
+  };
+  rs_template_free(tpl);
+}
+
+BENCH(template_render_vars)
+{
+  rs_template_t* tpl = rs_template_compile("${location}/${device}/${sensor}/value");
+  const rs_template_var_t vars[] = { { "location", "village" }, { "device", "greenhouse" }, { "sensor", "temperature" } };
+  while (state.next()) {
+    char* str = rs_template_render_vars(tpl, vars, 3);
+    bench::doNotOptimize(str);
+    rs_free(str);
+  };
+  rs_template_free(tpl);
+}
+
+BENCH(template_format_args)
+{
+  rs_template_t* tpl = rs_template_compile("${location}/${device}/${sensor}/value");
+  char buffer[128];
+  while (state.next()) {
+    size_t len = rs_template_format_args(tpl, templateArgs, 3, buffer, sizeof(buffer));
+    bench::doNotOptimize(len);
+  };
+  rs_template_free(tpl);
+}
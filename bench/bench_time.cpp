@@ -0,0 +1,332 @@
+/*
+   EN: Time-string cache: checks against localtime_r + strftime and benchmarks
+   RU: Кэш строк времени: сверка с localtime_r + strftime и замеры
+*/
+
+#include "bench.h"
+#include "rStrings.h"
+#include "rStringsTime.h"
+#include <random>
+#include <stdlib.h>
+#include <string.h>
+
+static const time_t timestamp = 1700000000;
+static const time_t dstSpring = 1711846800;   // 31.03.2024 01:00 UTC, EET -> EEST
+static const time_t dstAutumn = 1729990800;   // 27.10.2024 01:00 UTC, EEST -> EET
+
+static const char* formats[] = {
+  "%d.%m.%Y %H:%M:%S", "%H:%M:%S", "%H:%M", "%T", "%R", "%r", "%Y-%m-%dT%H:%M:%S%z", "%M:%S %Z",
+  "%s", "%c", "%H%%%M", "%S.%S", "%a %d %b %H:%M:%S", "%d.%m.%Y %H:%M:%S (with a long tail text)",
+};
+
+static bool compareAll(const char* check, time_t value)
+{
+  char actual[64], expected[64];
+  for (const char* format: formats) {
+    struct tm timeinfo;
+    localtime_r(&value, &timeinfo);
+    size_t expectedLen = strftime(expected, sizeof(expected), format, &timeinfo);
+    size_t len = time2str(format, &value, actual, sizeof(actual));
+    if ((len != expectedLen) || (strcmp(actual, expected) != 0)) {
+      return bench::fail(check, "%lld \"%s\": \"%s\" != \"%s\"", (long long)value, format, actual, expected);
+    };
+  };
+  return true;
+}
+
+static bool compareRange(const char* check, time_t from, time_t to, time_t step)
+{
+  for (time_t value = from; value < to; value += step) {
+    if (!compareAll(check, value)) return false;
+  };
+  return true;
+}
+
+BENCH_CHECK(check_time_cache_sequential)
+{
+  // With localtime_r and with the time zone table
+  for (int pass = 0; pass < 2; pass++) {
+    if (pass == 0) rs_tz_invalidate(); else rs_tz_update(timestamp);
+    if (!compareRange("check_time_cache_sequential", timestamp - 7200, timestamp + 7200, 1)
+     || !compareRange("check_time_cache_sequential", dstSpring - 7200, dstSpring + 7200, 7)
+     || !compareRange("check_time_cache_sequential", dstAutumn - 7200, dstAutumn + 7200, 7)) return false;
+  };
+  return true;
+}
+
+BENCH_CHECK(check_time_cache_random)
+{
+  time2str_cache_reset();
+  std::mt19937_64 random(42);
+  std::uniform_int_distribution<time_t> jumps(-5400, 5400);
+  time_t value = timestamp;
+  for (int i = 0; i < 100000; i++) {
+    value = (i % 1000 == 0) ? (time_t)(random() % 2000000000) : value + jumps(random);
+    if (!compareAll("check_time_cache_random", value)) return false;
+  };
+  return true;
+}
+
+BENCH_CHECK(check_time_cache_half_hour_zone)
+{
+  // Lord Howe Island: +10:30, daylight saving time shifts the clock by 30 minutes
+  const char* saved = getenv("TZ");
+  char previous[64];
+  strncpy(previous, saved ? saved : "", sizeof(previous) - 1);
+  previous[sizeof(previous) - 1] = 0;
+  setenv("TZ", "<+1030>-10:30<+11>-11,M10.1.0,M4.1.0", 1);
+  tzset();
+  rs_tz_update(1728142200 - 86400 * 10);
+  bool ok = compareRange("check_time_cache_half_hour_zone", 1728142200 - 7200, 1728142200 + 7200, 13)
+         && compareRange("check_time_cache_half_hour_zone", 1743865200 - 7200, 1743865200 + 7200, 13);
+  setenv("TZ", previous, 1);
+  tzset();
+  rs_tz_update(timestamp);
+  return ok;
+}
+
+static bool compareLocaltime(const char* check, time_t value)
+{
+  struct tm actual, expected;
+  rs_localtime_r(&value, &actual);
+  localtime_r(&value, &expected);
+  char a[64], e[64];
+  strftime(a, sizeof(a), "%Y-%m-%d %H:%M:%S %z %Z %j %a %U", &actual);
+  strftime(e, sizeof(e), "%Y-%m-%d %H:%M:%S %z %Z %j %a %U", &expected);
+  if ((actual.tm_year != expected.tm_year) || (actual.tm_mon != expected.tm_mon) || (actual.tm_mday != expected.tm_mday)
+   || (actual.tm_hour != expected.tm_hour) || (actual.tm_min != expected.tm_min) || (actual.tm_sec != expected.tm_sec)
+   || (actual.tm_wday != expected.tm_wday) || (actual.tm_yday != expected.tm_yday) || (actual.tm_isdst != expected.tm_isdst)
+   || (strcmp(a, e) != 0)) {
+    return bench::fail(check, "%lld: \"%s\" (dst %d) != \"%s\" (dst %d)", (long long)value, a, actual.tm_isdst, e, expected.tm_isdst);
+  };
+  return true;
+}
+
+BENCH_CHECK(check_localtime_table)
+{
+  const char* saved = getenv("TZ");
+  char previous[64];
+  strncpy(previous, saved ? saved : "", sizeof(previous) - 1);
+  previous[sizeof(previous) - 1] = 0;
+  const char* zones[] = {
+    previous, "UTC0", "<+0530>-5:30", "<+1030>-10:30<+11>-11,M10.1.0,M4.1.0",
+    "AEST-10AEDT,M10.1.0,M4.1.0/3", "EST5EDT,M3.2.0,M11.1.0", "<-03>3<-02>,M3.5.0/-2,M10.5.0/-1",
+  };
+  std::mt19937_64 random(42);
+  bool ok = true;
+  for (const char* zone: zones) {
+    setenv("TZ", zone, 1);
+    tzset();
+    if (!rs_tz_update(timestamp)) {
+      ok = bench::fail("check_localtime_table", "%s: too many transitions", zone);
+      break;
+    };
+    // Every second around the transitions is checked by the random walk, outside the window - localtime_r
+    for (int i = 0; ok && (i < 200000); i++) {
+      time_t value = (i < 100000) ? timestamp - 86400 + (time_t)(random() % (410LL * 86400)) : (time_t)(random() % 4000000000LL) - 2000000000LL;
+      ok = compareLocaltime("check_localtime_table", value);
+    };
+    for (time_t value = dstSpring - 86400 * 30; ok && (value < dstSpring + 86400 * 30); value += 599) {
+      ok = compareLocaltime("check_localtime_table", value);
+    };
+    for (time_t value = dstAutumn - 86400 * 30; ok && (value < dstAutumn + 86400 * 30); value += 599) {
+      ok = compareLocaltime("check_localtime_table", value);
+    };
+    if (!ok) bench::fail("check_localtime_table", "TZ=%s", zone);
+  };
+  setenv("TZ", previous, 1);
+  tzset();
+  rs_tz_update(timestamp);
+  return ok;
+}
+
+BENCH_CHECK(check_time_cache_stats)
+{
+  time2str_cache_reset();
+  rs_time_cache_stats_t before, after;
+  time2str_cache_stats(&before);
+  char buffer[32];
+  time_t value = timestamp;
+  for (int i = 0; i < 60; i++) {
+    time2str("%H:%M:%S", &value, buffer, sizeof(buffer));
+    time2str("%H:%M:%S", &value, buffer, sizeof(buffer));
+    value++;
+  };
+  time2str_cache_stats(&after);
+  uint32_t renders = after.renders - before.renders;
+  uint32_t patches = after.patches - before.patches;
+  uint32_t hits = after.hits - before.hits;
+  if ((renders > 2) || (renders + patches != 60) || (hits != 60)) {
+    return bench::fail("check_time_cache_stats", "renders %u, patches %u, hits %u", renders, patches, hits);
+  };
+  // Too small buffer: nothing and an empty string
+  if ((time2str("%H:%M:%S", &value, buffer, 8) != 0) || (buffer[0] != 0)) {
+    return bench::fail("check_time_cache_stats", "overflow: \"%s\"", buffer);
+  };
+  time_t zero = 0;
+  if ((time2str_empty("%H:%M", &zero, buffer, 8) != 0) || (buffer[0] != 0)) {
+    return bench::fail("check_time_cache_stats", "empty overflow: \"%s\"", buffer);
+  };
+  return true;
+}
+
+static const char* programFormats[] = {
+  "%d.%m.%Y %H:%M:%S", "%H:%M:%S", "%H:%M", "%T", "%R", "%r", "%D", "%F", "%e.%m %k:%M", "%I:%M %p %l",
+  "%a %d %b %Y", "%A, %B %d", "%h %C %y %j", "%u %w %U %W", "%%%n%t", "%Y-%m-%dT%H:%M:%S%z", "%Z %s", "%c | %x | %X",
+  "%-d.%-m %_H %EY %Od %G-W%V-%g", "plain text", "",
+};
+
+BENCH_CHECK(check_timefmt_vs_strftime)
+{
+  std::mt19937_64 random(42);
+  char actual[96], expected[96];
+  for (const char* format: programFormats) {
+    rs_timefmt_t program;
+    if (!rs_timefmt_compile(&program, format)) {
+      return bench::fail("check_timefmt_vs_strftime", "\"%s\" is not compiled", format);
+    };
+    for (int i = 0; i < 20000; i++) {
+      // Years 1902..2037 and a little beyond on 64-bit time_t
+      time_t value = (time_t)(random() % 4400000000LL) - 2140000000LL;
+      struct tm timeinfo;
+      localtime_r(&value, &timeinfo);
+      size_t expectedLen = strftime(expected, sizeof(expected), format, &timeinfo);
+      size_t len = rs_timefmt_render(&program, &timeinfo, actual, sizeof(actual));
+      if ((len != expectedLen) || (strcmp(actual, expected) != 0)) {
+        return bench::fail("check_timefmt_vs_strftime", "%lld \"%s\": \"%s\" != \"%s\"", (long long)value, format, actual, expected);
+      };
+    };
+  };
+  return true;
+}
+
+BENCH_CHECK(check_timefmt_limits)
+{
+  rs_timefmt_t program;
+  char buffer[32];
+  if (rs_timefmt_compile(&program, "%H:%M %")) {
+    return bench::fail("check_timefmt_limits", "a single %% at the end is compiled");
+  };
+  if (rs_timefmt_compile(&program, "%d %d %d %d %d %d %d %d %d %d %d %d %d")) {
+    return bench::fail("check_timefmt_limits", "too many operations are compiled");
+  };
+  rs_timefmt_compile(&program, "%d.%m.%Y %H:%M:%S");
+  time_t value = timestamp;
+  // "14.11.2023 23:13:20" - 19 characters
+  if ((rs_timefmt_render_time(&program, value, buffer, 19) != 0) || (buffer[0] != 0)) {
+    return bench::fail("check_timefmt_limits", "overflow: \"%s\"", buffer);
+  };
+  if (rs_timefmt_render_time(&program, value, buffer, 20) != 19) {
+    return bench::fail("check_timefmt_limits", "exact size: \"%s\"", buffer);
+  };
+  rs_timefmt_compile(&program, "%H:%M %c");
+  if ((rs_timefmt_render_time(&program, value, buffer, 10) != 0) || (buffer[0] != 0)) {
+    return bench::fail("check_timefmt_limits", "strftime overflow: \"%s\"", buffer);
+  };
+  return true;
+}
+
+BENCH(timefmt_render_tm)
+{
+  rs_timefmt_t program;
+  rs_timefmt_compile(&program, "%d.%m.%Y %H:%M:%S");
+  char buffer[32];
+  time_t value = timestamp;
+  struct tm timeinfo;
+  localtime_r(&value, &timeinfo);
+  while (state.next()) {
+    bench::doNotOptimize(rs_timefmt_render(&program, &timeinfo, buffer, sizeof(buffer)));
+    timeinfo.tm_sec = (timeinfo.tm_sec + 1) % 60;
+  };
+}
+
+BENCH(timefmt_strftime_tm)
+{
+  char buffer[32];
+  time_t value = timestamp;
+  struct tm timeinfo;
+  localtime_r(&value, &timeinfo);
+  while (state.next()) {
+    bench::doNotOptimize(strftime(buffer, sizeof(buffer), "%d.%m.%Y %H:%M:%S", &timeinfo));
+    timeinfo.tm_sec = (timeinfo.tm_sec + 1) % 60;
+  };
+}
+
+BENCH(timefmt_render_time_random)
+{
+  rs_timefmt_t program;
+  rs_timefmt_compile(&program, "%d.%m.%Y %H:%M:%S");
+  char buffer[32];
+  std::mt19937 random(42);
+  time_t values[1024];
+  for (time_t& value: values) value = timestamp + random() % 86400;
+  size_t i = 0;
+  while (state.next()) {
+    bench::doNotOptimize(rs_timefmt_render_time(&program, values[i++ % 1024], buffer, sizeof(buffer)));
+  };
+}
+
+BENCH(localtime_r_random)
+{
+  std::mt19937 random(42);
+  time_t values[1024];
+  for (time_t& value: values) value = timestamp + random() % (86400 * 365);
+  size_t i = 0;
+  struct tm timeinfo;
+  while (state.next()) {
+    bench::doNotOptimize(localtime_r(&values[i++ % 1024], &timeinfo));
+  };
+}
+
+BENCH(rs_localtime_r_random)
+{
+  rs_tz_update(timestamp);
+  std::mt19937 random(42);
+  time_t values[1024];
+  for (time_t& value: values) value = timestamp + random() % (86400 * 365);
+  size_t i = 0;
+  struct tm timeinfo;
+  while (state.next()) {
+    bench::doNotOptimize(rs_localtime_r(&values[i++ % 1024], &timeinfo));
+  };
+}
+
+BENCH(rs_tz_update)
+{
+  while (state.next()) {
+    bench::doNotOptimize(rs_tz_update(timestamp));
+  };
+}
+
+BENCH(time2str_cache_same_second)
+{
+  char buffer[32];
+  time_t value = timestamp;
+  while (state.next()) {
+    bench::doNotOptimize(time2str("%d.%m.%Y %H:%M:%S", &value, buffer, sizeof(buffer)));
+  };
+}
+
+BENCH(time2str_cache_random)
+{
+  char buffer[32];
+  std::mt19937 random(42);
+  time_t values[1024];
+  for (time_t& value: values) value = timestamp + random() % 86400;
+  size_t i = 0;
+  while (state.next()) {
+    bench::doNotOptimize(time2str("%d.%m.%Y %H:%M:%S", &values[i++ % 1024], buffer, sizeof(buffer)));
+  };
+}
+
+BENCH(time2str_uncached_reference)
+{
+  char buffer[32];
+  time_t value = timestamp;
+  while (state.next()) {
+    struct tm timeinfo;
+    localtime_r(&value, &timeinfo);
+    bench::doNotOptimize(strftime(buffer, sizeof(buffer), "%d.%m.%Y %H:%M:%S", &timeinfo));
+    value++;
+  };
+}
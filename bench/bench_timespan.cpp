@@ -0,0 +1,133 @@
+/*
+   EN: Time intervals: checks against snprintf and benchmarks
+   RU: Интервалы времени: сверка с snprintf и замеры
+*/
+
+#include "bench.h"
+#include "rStrings.h"
+#include <inttypes.h>
+#include <random>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// The reference layout with 64-bit snprintf
+static void reference(int64_t value, rs_timespan_unit_t unit, rs_timespan_style_t style, char* buffer, size_t size)
+{
+  uint64_t magnitude = value < 0 ? 0 - (uint64_t)value : (uint64_t)value;
+  uint64_t scale = unit == RS_TIMESPAN_MILLISECONDS ? 1000 : (unit == RS_TIMESPAN_MICROSECONDS ? 1000000 : 1);
+  uint64_t seconds = magnitude / scale;
+  uint64_t fraction = magnitude % scale;
+  int len = snprintf(buffer, size, "%s", value < 0 ? "-" : "");
+  if (style == RS_TIMESPAN_DHMS) {
+    len += snprintf(buffer + len, size - len, "%" PRIu64 ".%02" PRIu64 ":%02" PRIu64 ":%02" PRIu64,
+      seconds / 86400, seconds % 86400 / 3600, seconds % 3600 / 60, seconds % 60);
+  } else {
+    len += snprintf(buffer + len, size - len, "%02" PRIu64 ":%02" PRIu64 ":%02" PRIu64, seconds / 3600, seconds % 3600 / 60, seconds % 60);
+  };
+  if (scale > 1) {
+    snprintf(buffer + len, size - len, ".%0*" PRIu64, scale == 1000 ? 3 : 6, fraction);
+  };
+}
+
+BENCH_CHECK(check_timespan_vs_snprintf)
+{
+  std::mt19937_64 random(42);
+  char actual[RS_TIMESPAN_BUFFER_SIZE], expected[64];
+  for (int i = 0; i < 300000; i++) {
+    int64_t value;
+    switch (i % 4) {
+      case 0:  value = (int64_t)(random() % 100000); break;
+      case 1:  value = (int64_t)(random() % 100000000000ULL); break;
+      case 2:  value = (int64_t)random(); break;
+      default: value = i < 8 ? (i < 4 ? INT64_MIN : INT64_MAX) : -(int64_t)(random() % 1000000000ULL); break;
+    };
+    for (int unit = RS_TIMESPAN_SECONDS; unit <= RS_TIMESPAN_MICROSECONDS; unit++) {
+      for (int style = RS_TIMESPAN_HMS; style <= RS_TIMESPAN_DHMS; style++) {
+        size_t len = timespan_to_str(value, (rs_timespan_unit_t)unit, (rs_timespan_style_t)style, actual, sizeof(actual));
+        reference(value, (rs_timespan_unit_t)unit, (rs_timespan_style_t)style, expected, sizeof(expected));
+        if ((len != strlen(expected)) || (strcmp(actual, expected) != 0)) {
+          return bench::fail("check_timespan_vs_snprintf", "%" PRId64 " unit %d style %d: \"%s\" != \"%s\"", value, unit, style, actual, expected);
+        };
+      };
+    };
+  };
+  return true;
+}
+
+BENCH_CHECK(check_timespan_cases)
+{
+  struct { int64_t value; rs_timespan_unit_t unit; rs_timespan_style_t style; const char* expected; } cases[] = {
+    { 0, RS_TIMESPAN_SECONDS, RS_TIMESPAN_HMS, "00:00:00" },
+    { 86399, RS_TIMESPAN_SECONDS, RS_TIMESPAN_HMS, "23:59:59" },
+    { 1234567, RS_TIMESPAN_SECONDS, RS_TIMESPAN_DHMS, "14.06:56:07" },
+    // 100000 days: the old uint16_t code gave "34464.00:00:00"
+    { 8640000000LL, RS_TIMESPAN_SECONDS, RS_TIMESPAN_DHMS, "100000.00:00:00" },
+    { 360000000LL, RS_TIMESPAN_SECONDS, RS_TIMESPAN_HMS, "100000:00:00" },
+    { 1250, RS_TIMESPAN_MILLISECONDS, RS_TIMESPAN_HMS, "00:00:01.250" },
+    { 90061000005LL, RS_TIMESPAN_MICROSECONDS, RS_TIMESPAN_DHMS, "1.01:01:01.000005" },
+    { 0, RS_TIMESPAN_SECONDS, RS_TIMESPAN_COMPACT, "0s" },
+    { 0, RS_TIMESPAN_MICROSECONDS, RS_TIMESPAN_COMPACT, "0s" },
+    { 45, RS_TIMESPAN_SECONDS, RS_TIMESPAN_COMPACT, "45s" },
+    { 300, RS_TIMESPAN_SECONDS, RS_TIMESPAN_COMPACT, "5m" },
+    { 93784, RS_TIMESPAN_SECONDS, RS_TIMESPAN_COMPACT, "1d 2h" },
+    { 86400 * 3 + 59, RS_TIMESPAN_SECONDS, RS_TIMESPAN_COMPACT, "3d" },
+    { -3723, RS_TIMESPAN_SECONDS, RS_TIMESPAN_COMPACT, "-1h 2m" },
+    { 1250, RS_TIMESPAN_MILLISECONDS, RS_TIMESPAN_COMPACT, "1s 250ms" },
+    { 250, RS_TIMESPAN_MILLISECONDS, RS_TIMESPAN_COMPACT, "250ms" },
+    { 1500, RS_TIMESPAN_MICROSECONDS, RS_TIMESPAN_COMPACT, "1ms 500us" },
+    { INT64_MAX, RS_TIMESPAN_SECONDS, RS_TIMESPAN_COMPACT, "106751991167300d 15h" },
+    { INT64_MIN, RS_TIMESPAN_SECONDS, RS_TIMESPAN_DHMS, "-106751991167300.15:30:08" },
+  };
+  char buffer[RS_TIMESPAN_BUFFER_SIZE];
+  for (auto& item: cases) {
+    size_t len = timespan_to_str(item.value, item.unit, item.style, buffer, sizeof(buffer));
+    if ((len != strlen(item.expected)) || (strcmp(buffer, item.expected) != 0)) {
+      return bench::fail("check_timespan_cases", "%" PRId64 ": \"%s\" != \"%s\"", item.value, buffer, item.expected);
+    };
+  };
+  // Too small buffer
+  if ((timespan_to_str(86399, RS_TIMESPAN_SECONDS, RS_TIMESPAN_HMS, buffer, 8) != 0) || (buffer[0] != 0)) {
+    return bench::fail("check_timespan_cases", "overflow: \"%s\"", buffer);
+  };
+  // The legacy functions keep their layout
+  char* hms = malloc_timespan_hms(3599);
+  char* dhms = malloc_timespan_dhms(31536000);
+  bool ok = (strcmp(hms, "00:59:59") == 0) && (strcmp(dhms, "365.00:00:00") == 0);
+  if (!ok) bench::fail("check_timespan_cases", "legacy: \"%s\", \"%s\"", hms, dhms);
+  free(hms);
+  free(dhms);
+  return ok;
+}
+
+static const int64_t spans[] = { 59, 3599, 86399, 1234567, 31536000, 315360000 };
+static const size_t spansCount = sizeof(spans) / sizeof(spans[0]);
+
+BENCH(timespan_to_str_dhms)
+{
+  char buffer[RS_TIMESPAN_BUFFER_SIZE];
+  size_t i = 0;
+  while (state.next()) {
+    bench::doNotOptimize(timespan_to_str(spans[i++ % spansCount], RS_TIMESPAN_SECONDS, RS_TIMESPAN_DHMS, buffer, sizeof(buffer)));
+  };
+}
+
+BENCH(timespan_to_str_compact)
+{
+  char buffer[RS_TIMESPAN_BUFFER_SIZE];
+  size_t i = 0;
+  while (state.next()) {
+    bench::doNotOptimize(timespan_to_str(spans[i++ % spansCount], RS_TIMESPAN_SECONDS, RS_TIMESPAN_COMPACT, buffer, sizeof(buffer)));
+  };
+}
+
+BENCH(timespan_snprintf_dhms)
+{
+  char buffer[RS_TIMESPAN_BUFFER_SIZE];
+  size_t i = 0;
+  while (state.next()) {
+    int64_t value = spans[i++ % spansCount];
+    bench::doNotOptimize(snprintf(buffer, sizeof(buffer), "%" PRId64 ".%02d:%02d:%02d", value / 86400,
+      (int)(value % 86400 / 3600), (int)(value % 3600 / 60), (int)(value % 60)));
+  };
+}
@@ -0,0 +1,203 @@
+/* 
+   EN: Topic infrastructure: builders and interning
+   RU: Инфраструктура топиков: генераторы и кэширование
+*/
+
+#include "bench.h"
+#include "rStrings.h"
+#include "rStringsTopics.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+
+static bool checkTopic(char* actual, const std::string& expected)
+{
+  bool ok = actual && (expected == actual);
+  if (!ok) bench::fail("check_topic_builders", "\"%s\" != \"%s\"", actual ? actual : "NULL", expected.c_str());
+  free(actual);
+  return ok;
+}
+
+// The numbered functions against the printf layout they used to have, for every header
+BENCH_CHECK(check_topic_builders)
+{
+  bool ok = true;
+  for (int i = 0; ok && (i < 4); i++) {
+    bool primary = i & 1;
+    bool local = i & 2;
+    std::string loc = mqttGetTopicHeader(primary, local, MQTT_HEADER_LOCATION);
+    std::string dev = mqttGetTopicHeader(primary, local, MQTT_HEADER_DEVICE);
+    ok = checkTopic(mqttGetTopicLocation1(primary, local, "a"), loc + "a")
+      && checkTopic(mqttGetTopicLocation3(primary, local, "a", "bb", "c"), loc + "a/bb/c")
+      && checkTopic(mqttGetTopicLocation(primary, local, "a", "bb", nullptr), loc + "a/bb")
+      && checkTopic(mqttGetTopicSpecial1(primary, local, "sys", "a"), loc + "sys/a")
+      && checkTopic(mqttGetTopicSpecial1(primary, local, nullptr, "a"), loc + "a")
+      && checkTopic(mqttGetTopicSpecial5(primary, local, "sys", "a", "b", "c", "d", "e"), loc + "sys/a/b/c/d/e")
+      && checkTopic(mqttGetTopicSpecial(primary, local, nullptr, "a", nullptr, nullptr), loc + "a")
+      && checkTopic(mqttGetTopicDevice2(primary, local, "a", "bb"), dev + "a/bb")
+      && checkTopic(mqttGetTopicDevice5(primary, local, "a", "b", "c", "d", "e"), dev + "a/b/c/d/e");
+  };
+  if (!ok) return false;
+  if (mqttGetTopicDevice(true, false, nullptr, nullptr, nullptr) != nullptr) return bench::fail("check_topic_builders", "no topic");
+  // Any depth, NULL segments are skipped
+  const char* deep[] = { "a", "b", nullptr, "c", "d", "e", "f", "g", "h", "i", "j" };
+  std::string expected = std::string(mqttGetTopicHeader(false, true, MQTT_HEADER_DEVICE)) + "a/b/c/d/e/f/g/h/i/j";
+  if (!checkTopic(mqttGetTopic(false, true, MQTT_HEADER_DEVICE, nullptr, deep, 11), expected)) return false;
+  char buffer[64];
+  size_t len = mqttFormatTopic(false, true, MQTT_HEADER_DEVICE, nullptr, deep, 11, buffer, sizeof(buffer));
+  if ((len != expected.size()) || (expected != buffer)) return bench::fail("check_topic_builders", "format \"%s\"", buffer);
+  len = mqttFormatTopic(false, true, MQTT_HEADER_DEVICE, nullptr, deep, 11, buffer, expected.size());
+  if ((len != 0) || (buffer[0] != '\0')) return bench::fail("check_topic_builders", "overflow \"%s\"", buffer);
+  return true;
+}
+
+BENCH(mqttFormatTopic_special3)
+{
+  const char* segments[] = { "heater", "temperature", "value" };
+  char buffer[96];
+  while (state.next()) {
+    bench::doNotOptimize(mqttFormatTopic(true, true, MQTT_HEADER_LOCATION, "climate", segments, 3, buffer, sizeof(buffer)));
+  };
+}
+
+BENCH_CHECK(check_intern_topics)
+{
+  mqttInternInvalidate();
+  // Hits and misses are counted since start: other checks may have used the cache
+  mqtt_intern_stats_t start;
+  mqttInternGetStats(&start);
+  const char* parts[] = { "heater", "status" };
+  const char* t1 = mqttInternTopic(true, false, MQTT_HEADER_DEVICE, nullptr, parts, 2);
+  const char* t2 = mqttInternTopic(true, false, MQTT_HEADER_DEVICE, nullptr, parts, 2);
+  const char* t3 = mqttInternTopic(false, false, MQTT_HEADER_DEVICE, nullptr, parts, 2);
+  // The same topic string built from other segments is the same topic
+  const char* joined[] = { "heater/status" };
+  const char* t4 = mqttInternTopic(true, false, MQTT_HEADER_DEVICE, nullptr, joined, 1);
+  const char* t5 = mqttInternTopic(true, true, MQTT_HEADER_LOCATION, "climate", parts, 2);
+  char* e1 = mqttGetTopicDevice2(true, false, "heater", "status");
+  char* e3 = mqttGetTopicDevice2(false, false, "heater", "status");
+  char* e5 = mqttGetTopicSpecial2(true, true, "climate", "heater", "status");
+  mqtt_intern_stats_t stats;
+  mqttInternGetStats(&stats);
+  bool ok = t1 && (t1 == t2) && (t1 != t3) && (strcmp(t1, e1) == 0) && (strcmp(t3, e3) == 0)
+         && (t4 == t1) && t5 && (strcmp(t5, e5) == 0)
+         && (stats.hits - start.hits == 2) && (stats.misses - start.misses == 3) && (stats.count == 3);
+  if (!ok) bench::fail("check_intern_topics", "t1 = %s, t5 = %s, hits = %u, misses = %u", t1, t5, stats.hits, stats.misses);
+  free(e1);
+  free(e3);
+  free(e5);
+  mqttInternInvalidate();
+  mqttInternGetStats(&stats);
+  return ok && (stats.count == 0) && (stats.bytes == 0);
+}
+
+BENCH_CHECK(check_intern_overflow)
+{
+  mqttInternInvalidate();
+  char name[16];
+  const char* parts[] = { name };
+  mqtt_intern_stats_t stats;
+  mqttInternGetStats(&stats);
+  const int capacity = stats.capacity;
+  bool ok = true;
+  for (int i = 0; i < capacity + 1; i++) {
+    snprintf(name, sizeof(name), "param%d", i);
+    const char* topic = mqttInternTopic(true, false, MQTT_HEADER_DEVICE, nullptr, parts, 1);
+    if ((i < capacity) != (topic != nullptr)) ok = false;
+  };
+  mqttInternGetStats(&stats);
+  mqttInternInvalidate();
+  return ok && (stats.overflows == 1) ? true : bench::fail("check_intern_overflow", "overflows = %u", stats.overflows);
+}
+
+BENCH(intern_mqttGetTopicDevice2_hit)
+{
+  mqttInternInvalidate();
+  static const char* const sensors[] = { "heater", "boiler", "outdoor", "greenhouse" };
+  size_t i = 0;
+  while (state.next()) {
+    const char* parts[] = { sensors[i++ & 3], "status" };
+    bench::doNotOptimize(mqttInternTopic(true, false, MQTT_HEADER_DEVICE, nullptr, parts, 2));
+  };
+  mqttInternInvalidate();
+}
+
+// -----------------------------------------------------------------------------------------------------------------------
+// --------------------------------------------------- Topic tables ------------------------------------------------------
+// -----------------------------------------------------------------------------------------------------------------------
+
+// Parameters of a device with many sensors, as published at startup
+#define TABLE_TOPICS 200
+
+static char tableNames[TABLE_TOPICS][16];
+static const char* tableParts[TABLE_TOPICS][2];
+static mqtt_topic_desc_t tableTopics[TABLE_TOPICS];
+
+static void tableInit()
+{
+  static const char* const params[] = { "status", "temperature", "humidity", "config" };
+  for (int i = 0; i < TABLE_TOPICS; i++) {
+    snprintf(tableNames[i], sizeof(tableNames[i]), "sensor%d", i / 4);
+    tableParts[i][0] = tableNames[i];
+    tableParts[i][1] = params[i % 4];
+    tableTopics[i].primary = (i % 5) != 0;
+    tableTopics[i].local = (i % 3) == 0;
+    tableTopics[i].kind = (i & 1) ? MQTT_HEADER_DEVICE : MQTT_HEADER_LOCATION;
+    tableTopics[i].special = (i % 7) == 0 ? "config" : nullptr;
+    tableTopics[i].segments = tableParts[i];
+    tableTopics[i].count = 2;
+  };
+}
+
+BENCH_CHECK(check_topic_table)
+{
+  tableInit();
+  bool ok = true;
+  bench::HeapCounters before = bench::heapCounters();
+  mqtt_topic_table_t* table = mqttTopicTableCreate(tableTopics, TABLE_TOPICS);
+  bench::HeapCounters after = bench::heapCounters();
+  if ((table == nullptr) || (after.mallocs - before.mallocs != 1) || (mqttTopicTableCount(table) != TABLE_TOPICS)
+   || (mqttTopicTableSize(table) != after.bytes - before.bytes)) {
+    mqttTopicTableFree(table);
+    return bench::fail("check_topic_table", "%u allocations", (unsigned)(after.mallocs - before.mallocs));
+  };
+  for (int i = 0; i < TABLE_TOPICS; i++) {
+    const mqtt_topic_desc_t* topic = &tableTopics[i];
+    char* expected = mqttGetTopic(topic->primary, topic->local, topic->kind, topic->special, topic->segments, topic->count);
+    const char* actual = mqttTopicTableGet(table, i);
+    if ((actual == nullptr) || (strcmp(actual, expected) != 0) || (mqttTopicTableLength(table, i) != strlen(expected))) {
+      ok = bench::fail("check_topic_table", "item %d: \"%s\" != \"%s\"", i, actual ? actual : "(null)", expected);
+    };
+    free(expected);
+  };
+  if ((mqttTopicTableGet(table, TABLE_TOPICS) != nullptr) || (mqttTopicTableGeneration(table) != mqttGetTopicHeadersGeneration())) {
+    ok = bench::fail("check_topic_table", "index out of range or generation");
+  };
+  mqttTopicTableFree(table);
+  return ok;
+}
+
+BENCH(topic_table_200_separate)
+{
+  tableInit();
+  char* topics[TABLE_TOPICS];
+  while (state.next()) {
+    for (int i = 0; i < TABLE_TOPICS; i++) {
+      const mqtt_topic_desc_t* topic = &tableTopics[i];
+      topics[i] = mqttGetTopic(topic->primary, topic->local, topic->kind, topic->special, topic->segments, topic->count);
+    };
+    bench::doNotOptimize(topics);
+    for (int i = 0; i < TABLE_TOPICS; i++) rs_free(topics[i]);
+  };
+}
+
+BENCH(topic_table_200_batch)
+{
+  tableInit();
+  while (state.next()) {
+    mqtt_topic_table_t* table = mqttTopicTableCreate(tableTopics, TABLE_TOPICS);
+    bench::doNotOptimize(table);
+    mqttTopicTableFree(table);
+  };
+}
@@ -0,0 +1,229 @@
+/*
+   EN: Subscription trie: checks against a plain MQTT filter matcher and benchmarks
+   RU: Дерево подписок: сверка с простым сопоставлением MQTT фильтров и замеры
+*/
+
+#include "bench.h"
+#include "rStrings.h"
+#include "rStringsTrie.h"
+#include <algorithm>
+#include <random>
+#include <stdio.h>
+#include <string.h>
+#include <string>
+#include <vector>
+
+static std::vector<std::string> splitLevels(const std::string& path)
+{
+  std::vector<std::string> levels;
+  size_t start = 0;
+  while (true) {
+    size_t end = path.find('/', start);
+    levels.push_back(path.substr(start, end == std::string::npos ? std::string::npos : end - start));
+    if (end == std::string::npos) return levels;
+    start = end + 1;
+  };
+}
+
+// Plain MQTT filter matching, level by level
+static bool referenceMatch(const std::string& filter, const std::string& topic)
+{
+  std::vector<std::string> f = splitLevels(filter);
+  std::vector<std::string> t = splitLevels(topic);
+  for (size_t i = 0; i < f.size(); i++) {
+    bool wildcard = (f[i] == "#") || (f[i] == "+");
+    if (wildcard && (i == 0) && (topic[0] == '$')) return false;
+    if (f[i] == "#") return true;
+    if (i >= t.size()) return false;
+    if ((f[i] != "+") && (f[i] != t[i])) return false;
+  };
+  return f.size() == t.size();
+}
+
+static void collect(const char*, void* ctx, void* message)
+{
+  ((std::vector<size_t>*)message)->push_back((size_t)ctx);
+}
+
+static std::string randomPath(std::mt19937& random, const char* const* words, size_t count, bool wildcards)
+{
+  std::string path;
+  size_t levels = 1 + random() % 5;
+  for (size_t i = 0; i < levels; i++) {
+    if (i > 0) path += "/";
+    if (wildcards && (i == levels - 1) && (random() % 6 == 0)) {
+      path += "#";
+    } else if (wildcards && (random() % 5 == 0)) {
+      path += "+";
+    } else {
+      path += words[random() % count];
+    };
+  };
+  // An empty topic or filter is invalid in MQTT
+  return path.empty() ? "a" : path;
+}
+
+BENCH_CHECK(check_trie_vs_reference)
+{
+  static const char* const words[] = { "a", "b", "c", "", "$x" };
+  std::mt19937 random(42);
+  mqtt_trie_t* trie = mqttTrieCreate();
+  std::vector<std::string> filters;
+  std::vector<bool> active;
+  for (size_t i = 0; i < 400; i++) {
+    filters.push_back(randomPath(random, words, 4, true));
+    active.push_back(true);
+    if (!mqttTrieSubscribe(trie, filters[i].c_str(), collect, (void*)i)) {
+      mqttTrieFree(trie);
+      return bench::fail("check_trie_vs_reference", "subscribe \"%s\"", filters[i].c_str());
+    };
+  };
+  bool ok = true;
+  for (int pass = 0; ok && (pass < 2); pass++) {
+    if (pass == 1) {
+      // Every third subscription is removed
+      for (size_t i = 0; i < filters.size(); i += 3) {
+        active[i] = false;
+        if (!mqttTrieUnsubscribe(trie, filters[i].c_str(), collect, (void*)i)) ok = bench::fail("check_trie_vs_reference", "unsubscribe");
+      };
+    };
+    for (int i = 0; ok && (i < 5000); i++) {
+      std::string topic = randomPath(random, words, 5, false);
+      std::vector<size_t> actual, expected;
+      uint16_t count = mqttTrieDispatch(trie, topic.c_str(), &actual);
+      for (size_t j = 0; j < filters.size(); j++) {
+        if (active[j] && referenceMatch(filters[j], topic)) expected.push_back(j);
+      };
+      std::sort(actual.begin(), actual.end());
+      if ((actual != expected) || (count != actual.size())) {
+        ok = bench::fail("check_trie_vs_reference", "\"%s\": %zu handlers, expected %zu", topic.c_str(), actual.size(), expected.size());
+      };
+    };
+  };
+  // Invalid filters
+  const char* invalid[] = { "", "a/#/b", "a+/b", "a/b#" };
+  for (const char* filter: invalid) {
+    if (mqttTrieSubscribe(trie, filter, collect, nullptr)) ok = bench::fail("check_trie_vs_reference", "invalid \"%s\" accepted", filter);
+  };
+  mqttTrieFree(trie);
+  return ok;
+}
+
+// Default CONFIG_RSTRINGS_TRIE_MAX_LEVELS of rStringsConfig.h
+#define TRIE_MAX_LEVELS 32
+
+static std::string deepPath(size_t levels, const char* last)
+{
+  std::string path;
+  for (size_t i = 1; i < levels; i++) path += "l/";
+  return path + last;
+}
+
+BENCH_CHECK(check_trie_depth)
+{
+  bool ok = true;
+  mqtt_trie_t* trie = mqttTrieCreate();
+  // Every accepted subscription is reachable, deeper filters are rejected
+  std::string deepest = deepPath(TRIE_MAX_LEVELS, "x");
+  std::string wildcard = deepPath(TRIE_MAX_LEVELS, "#");
+  if (!mqttTrieSubscribe(trie, deepest.c_str(), collect, (void*)1)) ok = bench::fail("check_trie_depth", "%d levels rejected", TRIE_MAX_LEVELS);
+  if (!mqttTrieSubscribe(trie, wildcard.c_str(), collect, (void*)2)) ok = bench::fail("check_trie_depth", "%d levels with # rejected", TRIE_MAX_LEVELS);
+  std::string tooDeep = deepPath(TRIE_MAX_LEVELS + 1, "x");
+  if (mqttTrieSubscribe(trie, tooDeep.c_str(), collect, nullptr)) ok = bench::fail("check_trie_depth", "%d levels accepted", TRIE_MAX_LEVELS + 1);
+  std::vector<size_t> actual;
+  if ((mqttTrieDispatch(trie, deepest.c_str(), &actual) != 2) || (actual.size() != 2)) ok = bench::fail("check_trie_depth", "deepest topic: %zu handlers", actual.size());
+  // Topics deeper than the limit still reach # filters
+  actual.clear();
+  std::string deeper = deepPath(TRIE_MAX_LEVELS + 8, "x");
+  if ((mqttTrieDispatch(trie, deeper.c_str(), &actual) != 1) || (actual.size() != 1) || (actual[0] != 2)) ok = bench::fail("check_trie_depth", "deeper topic: %zu handlers", actual.size());
+  mqttTrieFree(trie);
+  return ok;
+}
+
+// -----------------------------------------------------------------------------------------------------------------------
+// ---------------------------------------------- 2000 device subscriptions ----------------------------------------------
+// -----------------------------------------------------------------------------------------------------------------------
+
+#define TRIE_SENSORS 200
+#define TRIE_PARAMS 10
+
+static void counter(const char*, void* ctx, void* message)
+{
+  (*(size_t*)message) += (size_t)ctx;
+}
+
+static std::vector<std::string> deviceTopics()
+{
+  std::vector<std::string> topics;
+  char buffer[96];
+  const char* header = mqttGetTopicHeader(true, false, MQTT_HEADER_DEVICE);
+  for (int s = 0; s < TRIE_SENSORS; s++) {
+    for (int p = 0; p < TRIE_PARAMS; p++) {
+      snprintf(buffer, sizeof(buffer), "%ssensor%03d/param%d/set", header, s, p);
+      topics.push_back(buffer);
+    };
+  };
+  return topics;
+}
+
+BENCH_CHECK(check_trie_device_topics)
+{
+  std::vector<std::string> topics = deviceTopics();
+  mqtt_trie_t* trie = mqttTrieCreate();
+  for (size_t i = 0; i < topics.size(); i++) {
+    mqttTrieSubscribe(trie, topics[i].c_str(), counter, (void*)(i + 1));
+  };
+  // A header-relative wildcard: every "…/set" of sensor007
+  mqttTrieSubscribeHeader(trie, true, false, MQTT_HEADER_DEVICE, "sensor007/+/set", counter, (void*)100000);
+  bool ok = true;
+  for (size_t i = 0; ok && (i < topics.size()); i++) {
+    size_t sum = 0;
+    mqttTrieDispatch(trie, topics[i].c_str(), &sum);
+    size_t expected = (i + 1) + (i / TRIE_PARAMS == 7 ? 100000 : 0);
+    if (sum != expected) ok = bench::fail("check_trie_device_topics", "\"%s\": %zu != %zu", topics[i].c_str(), sum, expected);
+  };
+  mqtt_trie_stats_t stats;
+  mqttTrieGetStats(trie, &stats);
+  if (ok && (stats.subscriptions != topics.size() + 1)) ok = bench::fail("check_trie_device_topics", "subscriptions = %u", stats.subscriptions);
+  mqttTrieFree(trie);
+  return ok;
+}
+
+BENCH(trie_dispatch_2000)
+{
+  std::vector<std::string> topics = deviceTopics();
+  mqtt_trie_t* trie = mqttTrieCreate();
+  for (size_t i = 0; i < topics.size(); i++) {
+    mqttTrieSubscribe(trie, topics[i].c_str(), counter, (void*)(i + 1));
+  };
+  mqttTrieSubscribeHeader(trie, true, false, MQTT_HEADER_DEVICE, "+/param0/set", counter, (void*)1);
+  mqttTrieSubscribeHeader(trie, true, false, MQTT_HEADER_DEVICE, "sensor100/#", counter, (void*)1);
+  std::mt19937 random(42);
+  std::vector<size_t> order(1024);
+  for (size_t& item: order) item = random() % topics.size();
+  size_t i = 0, sum = 0;
+  while (state.next()) {
+    bench::doNotOptimize(mqttTrieDispatch(trie, topics[order[i++ % order.size()]].c_str(), &sum));
+  };
+  bench::doNotOptimize(sum);
+  mqttTrieFree(trie);
+}
+
+// What the firmware does today: strcmp against every topic built at subscription
+BENCH(linear_strcmp_dispatch_2000)
+{
+  std::vector<std::string> topics = deviceTopics();
+  std::vector<const char*> table;
+  for (auto& topic: topics) table.push_back(topic.c_str());
+  std::mt19937 random(42);
+  std::vector<size_t> order(1024);
+  for (size_t& item: order) item = random() % topics.size();
+  size_t i = 0, sum = 0;
+  while (state.next()) {
+    const char* topic = topics[order[i++ % order.size()]].c_str();
+    for (size_t j = 0; j < table.size(); j++) {
+      if (strcmp(table[j], topic) == 0) sum += j;
+    };
+  };
+  bench::doNotOptimize(sum);
+}
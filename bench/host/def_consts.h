@@ -0,0 +1,12 @@
+/* 
+   EN: Stand-in common constants for the host (Linux) build of rStrings
+   RU: Общие константы для сборки rStrings на хосте (Linux)
+*/
+
+#ifndef __DEF_CONSTS_H__
+#define __DEF_CONSTS_H__
+
+#define CONFIG_FORMAT_EMPTY_DATETIME "--.--.---- --:--:--"
+#define CONFIG_FORMAT_STRFTIME_BUFFER_SIZE 64
+
+#endif // __DEF_CONSTS_H__
@@ -0,0 +1,31 @@
+/* 
+   EN: Stand-in project configuration for the host (Linux) build of rStrings
+   RU: Конфигурация проекта для сборки rStrings на хосте (Linux)
+   --------------------------
+   Values mimic a typical device: two brokers, local and public topics with full headers
+*/
+
+#ifndef __PROJECT_CONFIG_H__
+#define __PROJECT_CONFIG_H__
+
+// Primary broker: local topics
+#define CONFIG_MQTT1_LOC_PREFIX  "local/"
+#define CONFIG_MQTT1_LOC_LOCATION "village"
+#define CONFIG_MQTT1_LOC_DEVICE "boiler_room"
+
+// Primary broker: public topics
+#define CONFIG_MQTT1_PUB_PREFIX  "kotyara12/"
+#define CONFIG_MQTT1_PUB_LOCATION "village"
+#define CONFIG_MQTT1_PUB_DEVICE "boiler_room"
+
+// Backup broker: local topics
+#define CONFIG_MQTT2_LOC_PREFIX  "local/"
+#define CONFIG_MQTT2_LOC_LOCATION "village"
+#define CONFIG_MQTT2_LOC_DEVICE "boiler_room"
+
+// Backup broker: public topics
+#define CONFIG_MQTT2_PUB_PREFIX  "backup/kotyara12/"
+#define CONFIG_MQTT2_PUB_LOCATION "village"
+#define CONFIG_MQTT2_PUB_DEVICE "boiler_room"
+
+#endif // __PROJECT_CONFIG_H__
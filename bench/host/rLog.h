@@ -0,0 +1,54 @@
+/* 
+   EN: Stand-in logger for the host (Linux) build of rStrings: messages go to stderr
+   RU: Заглушка логгера для сборки rStrings на хосте (Linux): сообщения выводятся в stderr
+*/
+
+#ifndef __RLOG_H__
+#define __RLOG_H__
+
+#include <stdio.h>
+
+#define RLOG_LEVEL_NONE    0
+#define RLOG_LEVEL_ERROR   1
+#define RLOG_LEVEL_WARN    2
+#define RLOG_LEVEL_INFO    3
+#define RLOG_LEVEL_DEBUG   4
+#define RLOG_LEVEL_VERBOSE 5
+
+#ifndef CONFIG_RLOG_PROJECT_LEVEL
+#define CONFIG_RLOG_PROJECT_LEVEL RLOG_LEVEL_ERROR
+#endif
+
+#define RLOG_PRINT(letter, tag, format, ...) fprintf(stderr, letter " [%s] " format "\n", tag, ##__VA_ARGS__)
+
+#if CONFIG_RLOG_PROJECT_LEVEL >= RLOG_LEVEL_ERROR
+#define rlog_e(tag, format, ...) RLOG_PRINT("E", tag, format, ##__VA_ARGS__)
+#else
+#define rlog_e(tag, format, ...)
+#endif
+
+#if CONFIG_RLOG_PROJECT_LEVEL >= RLOG_LEVEL_WARN
+#define rlog_w(tag, format, ...) RLOG_PRINT("W", tag, format, ##__VA_ARGS__)
+#else
+#define rlog_w(tag, format, ...)
+#endif
+
+#if CONFIG_RLOG_PROJECT_LEVEL >= RLOG_LEVEL_INFO
+#define rlog_i(tag, format, ...) RLOG_PRINT("I", tag, format, ##__VA_ARGS__)
+#else
+#define rlog_i(tag, format, ...)
+#endif
+
+#if CONFIG_RLOG_PROJECT_LEVEL >= RLOG_LEVEL_DEBUG
+#define rlog_d(tag, format, ...) RLOG_PRINT("D", tag, format, ##__VA_ARGS__)
+#else
+#define rlog_d(tag, format, ...)
+#endif
+
+#if CONFIG_RLOG_PROJECT_LEVEL >= RLOG_LEVEL_VERBOSE
+#define rlog_v(tag, format, ...) RLOG_PRINT("V", tag, format, ##__VA_ARGS__)
+#else
+#define rlog_v(tag, format, ...)
+#endif
+
+#endif // __RLOG_H__
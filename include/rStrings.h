@@ -9,7 +9,12 @@
 #ifndef __R_STRINGS_H__
 #define __R_STRINGS_H__
 
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdarg.h>
 #include <time.h>
+#include "rStringsAlloc.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -29,6 +34,7 @@ char* malloc_stringl(const char *source, const uint32_t len);
  * Generating a string in heap with formatting
  * */
 char* malloc_stringf(const char *format, ...);
+char* vmalloc_stringf(const char *format, va_list args);
 uint16_t format_string(char* buffer, uint16_t buffer_size, const char *format, ...);
 
 /**
@@ -38,11 +44,71 @@ char * concat_strings(char * part1, char * part2);
 char * concat_strings_div(char * part1, char * part2, const char* divider);
 
 /**
- * Converting 64-bit integers to a string
+ * Converting 64-bit integers to a string, radix 2...16, negative values are written as "-" + magnitude in any radix
+ * The buffer must hold RS_INT64_BUFFER_SIZE bytes (66) in the worst case: radix 2, sign, 64 digits and a zero
  * */
+#define RS_INT64_BUFFER_SIZE 66
 char* _i64toa(int64_t value, char* buffer, uint8_t radix);
 char* _ui64toa(uint64_t value, char* buffer, uint8_t radix);
 
+/**
+ * The same as _i64toa and _ui64toa, but return the length of the string (0 for a wrong radix)
+ * */
+size_t i64_to_str(int64_t value, char* buffer, uint8_t radix);
+size_t ui64_to_str(uint64_t value, char* buffer, uint8_t radix);
+
+/**
+ * Rounding of decimal values to the requested precision
+ * */
+typedef enum {
+  RS_ROUND_HALF_UP   = 0,    // half away from zero: 2.345 -> 2.35, -2.345 -> -2.35
+  RS_ROUND_HALF_EVEN = 1,    // half to even (banker's): 2.345 -> 2.34, 2.355 -> 2.36
+  RS_ROUND_DOWN      = 2     // towards zero (truncation): 2.349 -> 2.34
+} rs_rounding_t;
+
+/**
+ * Options of decimal formatting
+ * 
+ * @param precision - Digits after the decimal point, up to RS_DECIMAL_MAX_PRECISION
+ * @param rounding - Rounding mode
+ * @param point - Decimal separator
+ * @param nan - Text for NaN
+ * @param inf - Text for infinity (a "-" is added for negative infinity)
+ * */
+#define RS_DECIMAL_MAX_PRECISION 17
+#define RS_DECIMAL_BUFFER_SIZE 48
+typedef struct {
+  uint8_t       precision;
+  rs_rounding_t rounding;
+  char          point;
+  const char*   nan;
+  const char*   inf;
+} rs_decimal_format_t;
+
+/**
+ * Converting floating point values to a string without printf: fixed notation, magnitudes of 1e18 and more
+ * in exponential notation ("1.50e+20"). The decimal value nearest to the binary one is rounded, 
+ * so 0.15 with precision 1 gives "0.2" (printf gives "0.1")
+ * 
+ * @return - Length of the string or 0 if the buffer is too small (RS_DECIMAL_BUFFER_SIZE is always enough)
+ * */
+size_t double_to_str(double value, uint8_t precision, char* buffer, size_t buffer_size);
+size_t double_to_str_ex(double value, const rs_decimal_format_t* format, char* buffer, size_t buffer_size);
+
+/**
+ * Converting fixed point values (value / 10^scale, for example 2150 with scale 2 = 21.50) to a string
+ * 
+ * @param format - Formatting options, NULL - precision equal to scale
+ * @return - Length of the string or 0 if the buffer is too small
+ * */
+size_t fixed_to_str(int64_t value, uint8_t scale, const rs_decimal_format_t* format, char* buffer, size_t buffer_size);
+
+/**
+ * Generating a heap string with a decimal value
+ * */
+char* malloc_double(double value, uint8_t precision);
+char* malloc_fixed(int64_t value, uint8_t scale, uint8_t precision);
+
 /**
  * Generating a heap string containing a textual representation of the date and time
  * */
@@ -51,6 +117,41 @@ size_t time2str_empty(const char *format, time_t *value, char* buffer, size_t bu
 // char* malloc_timestr(const char *format, time_t value);
 // char* malloc_timestr_empty(const char *format, time_t value);
 
+/**
+ * Time intervals (uptime, durations): the unit of the value and the layout of the string
+ * 
+ * RS_TIMESPAN_HMS     - "HH:MM:SS", hours are not limited: "1234:05:06"
+ * RS_TIMESPAN_DHMS    - "D.HH:MM:SS": "14.06:56:07"
+ * RS_TIMESPAN_COMPACT - two most significant units, the second is omitted if zero: "1d 2h", "5m", "1s 250ms"
+ * 
+ * Milliseconds and microseconds add a fraction to HMS and DHMS: "00:00:01.250"
+ * */
+typedef enum {
+  RS_TIMESPAN_SECONDS = 0,
+  RS_TIMESPAN_MILLISECONDS,
+  RS_TIMESPAN_MICROSECONDS
+} rs_timespan_unit_t;
+
+typedef enum {
+  RS_TIMESPAN_HMS = 0,
+  RS_TIMESPAN_DHMS,
+  RS_TIMESPAN_COMPACT
+} rs_timespan_style_t;
+
+#define RS_TIMESPAN_BUFFER_SIZE 32
+
+/**
+ * Converting a time interval to a string without printf and allocations, over the full range of int64_t
+ * 
+ * @return - Length of the string or 0 if the buffer is too small (RS_TIMESPAN_BUFFER_SIZE is always enough)
+ * */
+size_t timespan_to_str(int64_t value, rs_timespan_unit_t unit, rs_timespan_style_t style, char* buffer, size_t buffer_size);
+
+/**
+ * Generating a heap string containing a textual representation of a time interval
+ * */
+char * malloc_timespan(int64_t value, rs_timespan_unit_t unit, rs_timespan_style_t style);
+
 /**
  * Generating a heap string containing a textual representation of a time interval in hours, minutes, and seconds
  * */
@@ -61,6 +162,24 @@ char * malloc_timespan_hms(time_t value);
  * */
 char * malloc_timespan_dhms(time_t value);
 
+/**
+ * Topic header kind: prefix + location + / or prefix + location + / + device + /
+ * */
+typedef enum {
+  MQTT_HEADER_LOCATION = 0,
+  MQTT_HEADER_DEVICE   = 1
+} mqtt_header_t;
+
+/**
+ * Returns the topic header configured in project_config.h or set by mqttSetTopicHeaders()
+ * 
+ * @param primary - Primary or backup MQTT broker
+ * @param local - Local (hidden) topic (available only within this location)
+ * @param kind - Location or device header
+ * @return - Pointer to a constant string, do not free it. Valid until the headers are changed twice
+ * */
+const char * mqttGetTopicHeader(const bool primary, const bool local, const mqtt_header_t kind);
+
 /**
  * Adding one or more parts to the current topic
  * 
@@ -70,6 +189,30 @@ char * malloc_timespan_dhms(time_t value);
  * */
 char * mqttGetSubTopic(const char *topic, const char *subtopic);
 
+/**
+ * Generation of a name of a topic of any depth: header + [special + /] + segments[0] + / + ... + segments[count-1]
+ * The length is calculated in advance, the topic is assembled with memcpy in one allocation
+ *
+ * Note: NULL items of segments are skipped, NULL special means "no special segment"
+ *
+ * @param primary - Primary or backup MQTT broker
+ * @param local - Local (hidden) topic (available only within this location)
+ * @param kind - Location or device header
+ * @param special - Special segment after the header (only meaningful for MQTT_HEADER_LOCATION), may be NULL
+ * @param segments - Topic segments
+ * @param count - Number of topic segments
+ * @return - Pointer to a string in heap. Remember to free it after using the function esp_mqtt_free_string() or free();
+ * */
+char * mqttGetTopic(const bool primary, const bool local, const mqtt_header_t kind, const char *special, const char * const *segments, const uint8_t count);
+
+/**
+ * The same as mqttGetTopic, but into the buffer
+ *
+ * @return - Length of the topic, 0 (and an empty string) if the buffer is too small
+ * */
+size_t mqttFormatTopic(const bool primary, const bool local, const mqtt_header_t kind, const char *special, const char * const *segments, const uint8_t count,
+  char *buffer, size_t buffer_size);
+
 /**
  * Generation of a name of a topic: prefix + location + / + topic 
  * for example: "/home/heater"
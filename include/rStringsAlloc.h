@@ -0,0 +1,290 @@
+/* 
+   EN: Pluggable memory allocator for rStrings with allocation statistics
+   RU: Подключаемый распределитель памяти для rStrings со статистикой выделений
+   --------------------------
+   (с) 2021 Разживин Александр | Razzhivin Alexander
+   kotyara12@yandex.ru | https://kotyara12.ru | tg: @kotyara1971
+*/
+
+#ifndef __R_STRINGS_ALLOC_H__
+#define __R_STRINGS_ALLOC_H__
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Memory allocator backend
+ * 
+ * @param alloc - Allocate a block of at least size bytes, NULL on failure
+ * @param realloc - Resize a block (ptr may be NULL), NULL on failure
+ * @param free - Release a block (ptr may be NULL)
+ * @param size - Optional: usable size of a block, required for current / peak statistics
+ * @param ctx - User context passed to every callback
+ * */
+typedef struct {
+  void*  (*alloc)(void* ctx, size_t size);
+  void*  (*realloc)(void* ctx, void* ptr, size_t size);
+  void   (*free)(void* ctx, void* ptr);
+  size_t (*size)(void* ctx, const void* ptr);
+  void*  ctx;
+} rs_allocator_t;
+
+/**
+ * Allocation statistics of all rStrings functions
+ * 
+ * @param calls - Number of allocation and reallocation calls
+ * @param frees - Number of released blocks
+ * @param bytes - Total number of bytes requested
+ * @param current - Bytes currently outstanding (0 if the backend has no size callback)
+ * @param peak - Highest value of current since start or the last reset
+ * @param failures - Number of failed allocations
+ * */
+typedef struct {
+  uint64_t calls;
+  uint64_t frees;
+  uint64_t bytes;
+  size_t   current;
+  size_t   peak;
+  uint32_t failures;
+} rs_alloc_stats_t;
+
+/**
+ * Registering an allocator for all rStrings functions, NULL restores the default one (psram_malloc or malloc)
+ * 
+ * Note: the allocator structure must stay valid while it is registered. Strings returned by rStrings must be
+ * released by the same allocator, so switch it before any strings are created or release them with rs_free()
+ * while the old allocator is still active. With the default allocator free() can be used as before.
+ * */
+void rs_set_allocator(const rs_allocator_t* allocator);
+const rs_allocator_t* rs_get_allocator(void);
+const rs_allocator_t* rs_default_allocator(void);
+
+/**
+ * Memory management through the registered allocator
+ * */
+void* rs_malloc(size_t size);
+void* rs_realloc(void* ptr, size_t size);
+void  rs_free(void* ptr);
+
+/**
+ * Usable size of a block allocated by rs_malloc, 0 if the allocator cannot tell (no size callback)
+ * */
+size_t rs_usable_size(const void* ptr);
+
+/**
+ * Allocation statistics: reset clears the counters and sets the peak to the current value
+ * */
+void rs_get_alloc_stats(rs_alloc_stats_t* stats);
+void rs_reset_alloc_stats(void);
+
+/**
+ * Slab pool: fixed-size blocks of 32, 64, 128 and 256 bytes in one preallocated region. Requests that do not fit
+ * into a class, or arrive when their class is full, fall back to the default allocator. Connect the pool to the
+ * rStrings functions by rs_set_allocator() with the structure filled by rs_slab_allocator()
+ * */
+#define RS_SLAB_CLASSES 4
+#define RS_SLAB_MIN_BLOCK 32
+
+typedef struct rs_slab_t rs_slab_t;
+
+/**
+ * Slab pool statistics for one size class
+ * 
+ * @param block_size - Block size of the class, bytes
+ * @param capacity - Number of blocks in the class
+ * @param used - Blocks currently occupied
+ * @param peak - Highest value of used
+ * @param hits - Requests served by the class
+ * @param misses - Requests of this class served by the heap because the class was full
+ * */
+typedef struct {
+  size_t   block_size;
+  uint16_t capacity;
+  uint16_t used;
+  uint16_t peak;
+  uint32_t hits;
+  uint32_t misses;
+} rs_slab_class_stats_t;
+
+/**
+ * Creating a slab pool: blocks[i] is the number of blocks of RS_SLAB_MIN_BLOCK << i bytes
+ * */
+rs_slab_t* rs_slab_create(const uint16_t blocks[RS_SLAB_CLASSES]);
+
+/**
+ * Deleting a slab pool, all blocks of the pool must be released before that
+ * */
+void rs_slab_delete(rs_slab_t* slab);
+
+/**
+ * Filling an allocator structure that serves requests from the pool
+ * */
+void rs_slab_allocator(rs_slab_t* slab, rs_allocator_t* allocator);
+
+/**
+ * Per-class statistics and the number of requests larger than the largest class
+ * */
+bool rs_slab_get_stats(rs_slab_t* slab, uint8_t index, rs_slab_class_stats_t* stats);
+uint32_t rs_slab_oversize(rs_slab_t* slab);
+
+/**
+ * Per-task cache: every task (thread) keeps its own lists of freed blocks of 32, 64, 128 and 256 bytes and reuses
+ * them without taking the heap lock. A list holds up to limit blocks, further blocks go back to the backend.
+ * The cache is placed in front of another allocator (backend), which must have a size callback (otherwise all
+ * requests are passed through). Connect it by rs_set_allocator() with the structure filled by rs_tcache_allocator()
+ * 
+ * Note: blocks of a task return to the backend when the task exits. rs_tcache_delete() releases only the blocks 
+ * of the calling task, call rs_tcache_flush() in other tasks before that
+ * */
+typedef struct rs_tcache_t rs_tcache_t;
+
+/**
+ * Per-task cache statistics, summed over all tasks. Tasks add their counters every 64 operations 
+ * (and on flush or exit), so the values lag a little behind
+ * 
+ * @param hits - Requests served from a list of the task
+ * @param misses - Requests passed to the backend
+ * @param overflows - Freed blocks passed to the backend because the list was full
+ * @param cached - Blocks currently kept in the lists
+ * */
+typedef struct {
+  uint32_t hits;
+  uint32_t misses;
+  uint32_t overflows;
+  uint32_t cached;
+} rs_tcache_stats_t;
+
+rs_tcache_t* rs_tcache_create(const rs_allocator_t* backend, uint16_t limit);
+void rs_tcache_delete(rs_tcache_t* tcache);
+void rs_tcache_allocator(rs_tcache_t* tcache, rs_allocator_t* allocator);
+
+/**
+ * Returning all blocks cached by the calling task to the backend
+ * */
+void rs_tcache_flush(rs_tcache_t* tcache);
+void rs_tcache_get_stats(rs_tcache_t* tcache, rs_tcache_stats_t* stats);
+
+/**
+ * Placement policy: chooses the memory tier (internal RAM or PSRAM) for every block by its size and a hint.
+ * On ESP32 the tiers are heap_caps_malloc(MALLOC_CAP_INTERNAL) and heap_caps_malloc(MALLOC_CAP_SPIRAM), on other
+ * platforms both tiers are simulated on the heap (with a small header per block), so that the policy can be tuned
+ * on the host with the access costs of the target. Connect it by rs_set_allocator() with the structure filled
+ * by rs_placement_allocator()
+ * */
+#define RS_TIERS 2
+
+typedef enum {
+  RS_TIER_INTERNAL = 0,
+  RS_TIER_PSRAM    = 1
+} rs_tier_t;
+
+/**
+ * Expected lifetime of the next blocks, set per task by rs_set_alloc_hint()
+ *
+ * RS_HINT_AUTO - by size only: up to internal_max bytes in internal RAM, larger ones in PSRAM
+ * RS_HINT_TRANSIENT - released soon (topics, payloads being published): internal RAM up to transient_max bytes
+ * RS_HINT_LONG_LIVED - kept for a long time (configuration, cached values): always PSRAM
+ * */
+typedef enum {
+  RS_HINT_AUTO       = 0,
+  RS_HINT_TRANSIENT  = 1,
+  RS_HINT_LONG_LIVED = 2
+} rs_alloc_hint_t;
+
+/**
+ * Policy parameters
+ *
+ * @param internal_max - Largest block placed in internal RAM without a hint
+ * @param transient_max - Largest block placed in internal RAM with RS_HINT_TRANSIENT
+ * @param internal_budget - Bytes of internal RAM the policy may hold at once, further blocks go to PSRAM (0 - no limit)
+ * @param cost_alloc_ns - Cost model: time of one allocation in the tier, ns
+ * @param cost_byte_ps - Cost model: time of one byte of access in the tier, ps. Every block is counted as written
+ *                       once when it is allocated and read once before it is released
+ * */
+typedef struct {
+  size_t   internal_max;
+  size_t   transient_max;
+  size_t   internal_budget;
+  uint32_t cost_alloc_ns[RS_TIERS];
+  uint32_t cost_byte_ps[RS_TIERS];
+} rs_placement_config_t;
+
+/**
+ * Statistics of one tier
+ *
+ * @param allocs - Blocks placed in the tier
+ * @param frees - Blocks of the tier released
+ * @param bytes - Total number of bytes placed in the tier
+ * @param current - Bytes of the tier currently outstanding
+ * @param peak - Highest value of current
+ * @param fallbacks - Blocks that the policy chose for this tier but placed in the other one (budget or out of memory)
+ * @param failures - Failed allocations (both tiers out of memory)
+ * @param cost_ns - Estimated access time by the cost model, ns
+ * */
+typedef struct {
+  uint32_t allocs;
+  uint32_t frees;
+  uint64_t bytes;
+  size_t   current;
+  size_t   peak;
+  uint32_t fallbacks;
+  uint32_t failures;
+  uint64_t cost_ns;
+} rs_tier_stats_t;
+
+typedef struct rs_placement_t rs_placement_t;
+
+/**
+ * Creating a placement policy, config NULL - defaults (64 bytes, 256 bytes, no budget, no costs)
+ * */
+rs_placement_t* rs_placement_create(const rs_placement_config_t* config);
+void rs_placement_delete(rs_placement_t* placement);
+void rs_placement_allocator(rs_placement_t* placement, rs_allocator_t* allocator);
+
+/**
+ * Allocation with an explicit hint. The block is released by the free callback of the policy (rs_free() while 
+ * the policy is registered)
+ * */
+void* rs_placement_alloc(rs_placement_t* placement, size_t size, rs_alloc_hint_t hint);
+rs_tier_t rs_placement_tier(rs_placement_t* placement, const void* ptr);
+
+bool rs_placement_get_stats(rs_placement_t* placement, rs_tier_t tier, rs_tier_stats_t* stats);
+void rs_placement_reset_stats(rs_placement_t* placement);
+
+/**
+ * Setting the hint for the following allocations of the calling task, returns the previous hint
+ * */
+rs_alloc_hint_t rs_set_alloc_hint(rs_alloc_hint_t hint);
+rs_alloc_hint_t rs_get_alloc_hint(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#ifdef __cplusplus
+
+namespace rs {
+
+/**
+ * Hint for the allocations of the calling task within a scope:
+ *   { rs::alloc_hint hint(RS_HINT_TRANSIENT); char* topic = mqttGetTopicDevice1(...); ... }
+ * */
+class alloc_hint {
+  public:
+    explicit alloc_hint(rs_alloc_hint_t hint) : _prev(rs_set_alloc_hint(hint)) {};
+    ~alloc_hint() { rs_set_alloc_hint(_prev); };
+    alloc_hint(const alloc_hint&) = delete;
+    alloc_hint& operator=(const alloc_hint&) = delete;
+  private:
+    rs_alloc_hint_t _prev;
+};
+
+} // namespace rs
+
+#endif // __cplusplus
+
+#endif // __R_STRINGS_ALLOC_H__
@@ -0,0 +1,105 @@
+/* 
+   EN: Arena (bump) allocation of strings for one processing cycle
+   RU: Выделение строк из арены (последовательно) для одного цикла обработки
+   --------------------------
+   (с) 2021 Разживин Александр | Razzhivin Alexander
+   kotyara12@yandex.ru | https://kotyara12.ru | tg: @kotyara1971
+*/
+
+#ifndef __R_STRINGS_ARENA_H__
+#define __R_STRINGS_ARENA_H__
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdarg.h>
+#include <time.h>
+#include "rStrings.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Arena: one memory block, strings are allocated one after another and released all at once by rs_arena_reset()
+ * 
+ * Note: an arena is not thread-safe, use one arena per task
+ * 
+ * @param base - Memory block
+ * @param size - Size of the memory block
+ * @param used - Bytes allocated since the last reset
+ * @param peak - Highest value of used since initialization
+ * @param failures - Number of allocations that did not fit into the arena
+ * @param owned - The block was allocated by rs_arena_init() and is released by rs_arena_free()
+ * */
+typedef struct {
+  char*    base;
+  size_t   size;
+  size_t   used;
+  size_t   peak;
+  uint32_t failures;
+  bool     owned;
+} rs_arena_t;
+
+/**
+ * Initialization of an arena on a caller buffer or, if buffer is NULL, on a block allocated by rs_malloc()
+ * */
+bool rs_arena_init(rs_arena_t* arena, void* buffer, size_t size);
+
+/**
+ * Releasing all strings of the arena at once (usually at the end of a cycle)
+ * */
+void rs_arena_reset(rs_arena_t* arena);
+
+/**
+ * Releasing the memory block of the arena (only if it was allocated by rs_arena_init())
+ * */
+void rs_arena_free(rs_arena_t* arena);
+
+/**
+ * Allocating a block aligned to the size of a pointer, NULL if the arena is exhausted
+ * */
+void* rs_arena_alloc(rs_arena_t* arena, size_t size);
+size_t rs_arena_available(const rs_arena_t* arena);
+
+/**
+ * Arena versions of the string functions. Results must not be freed, they live until rs_arena_reset()
+ * */
+char* malloc_string_arena(rs_arena_t* arena, const char *source);
+char* malloc_stringl_arena(rs_arena_t* arena, const char *source, const uint32_t len);
+char* malloc_stringf_arena(rs_arena_t* arena, const char *format, ...);
+char* vmalloc_stringf_arena(rs_arena_t* arena, const char *format, va_list args);
+char* malloc_timespan_arena(rs_arena_t* arena, int64_t value, rs_timespan_unit_t unit, rs_timespan_style_t style);
+char* malloc_timespan_hms_arena(rs_arena_t* arena, time_t value);
+char* malloc_timespan_dhms_arena(rs_arena_t* arena, time_t value);
+
+/**
+ * Arena versions of the topic functions, see mqttGetSubTopic, mqttGetTopic, mqttGetTopicLocation, mqttGetTopicSpecial and mqttGetTopicDevice
+ * */
+char* mqttGetSubTopic_arena(rs_arena_t* arena, const char *topic, const char *subtopic);
+char* mqttGetTopic_arena(rs_arena_t* arena, const bool primary, const bool local, const mqtt_header_t kind, const char *special, const char * const *segments, const uint8_t count);
+
+char* mqttGetTopicLocation1_arena(rs_arena_t* arena, const bool primary, const bool local, const char *topic);
+char* mqttGetTopicLocation2_arena(rs_arena_t* arena, const bool primary, const bool local, const char *topic1, const char *topic2);
+char* mqttGetTopicLocation3_arena(rs_arena_t* arena, const bool primary, const bool local, const char *topic1, const char *topic2, const char *topic3);
+char* mqttGetTopicLocation_arena(rs_arena_t* arena, const bool primary, const bool local, const char *topic1, const char *topic2, const char *topic3);
+
+char* mqttGetTopicSpecial1_arena(rs_arena_t* arena, const bool primary, const bool local, const char *special, const char *topic);
+char* mqttGetTopicSpecial2_arena(rs_arena_t* arena, const bool primary, const bool local, const char *special, const char *topic1, const char *topic2);
+char* mqttGetTopicSpecial3_arena(rs_arena_t* arena, const bool primary, const bool local, const char *special, const char *topic1, const char *topic2, const char *topic3);
+char* mqttGetTopicSpecial4_arena(rs_arena_t* arena, const bool primary, const bool local, const char *special, const char *topic1, const char *topic2, const char *topic3, const char *topic4);
+char* mqttGetTopicSpecial5_arena(rs_arena_t* arena, const bool primary, const bool local, const char *special, const char *topic1, const char *topic2, const char *topic3, const char *topic4, const char *topic5);
+char* mqttGetTopicSpecial_arena(rs_arena_t* arena, const bool primary, const bool local, const char *special, const char *topic1, const char *topic2, const char *topic3);
+
+char* mqttGetTopicDevice1_arena(rs_arena_t* arena, const bool primary, const bool local, const char *topic);
+char* mqttGetTopicDevice2_arena(rs_arena_t* arena, const bool primary, const bool local, const char *topic1, const char *topic2);
+char* mqttGetTopicDevice3_arena(rs_arena_t* arena, const bool primary, const bool local, const char *topic1, const char *topic2, const char *topic3);
+char* mqttGetTopicDevice4_arena(rs_arena_t* arena, const bool primary, const bool local, const char *topic1, const char *topic2, const char *topic3, const char *topic4);
+char* mqttGetTopicDevice5_arena(rs_arena_t* arena, const bool primary, const bool local, const char *topic1, const char *topic2, const char *topic3, const char *topic4, const char *topic5);
+char* mqttGetTopicDevice_arena(rs_arena_t* arena, const bool primary, const bool local, const char *topic1, const char *topic2, const char *topic3);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // __R_STRINGS_ARENA_H__
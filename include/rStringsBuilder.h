@@ -0,0 +1,87 @@
+/* 
+   EN: String builder: appending to one growing heap string in linear time
+   RU: Построитель строк: добавление к одной растущей строке в куче за линейное время
+   --------------------------
+   (с) 2021 Разживин Александр | Razzhivin Alexander
+   kotyara12@yandex.ru | https://kotyara12.ru | tg: @kotyara1971
+*/
+
+#ifndef __R_STRINGS_BUILDER_H__
+#define __R_STRINGS_BUILDER_H__
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdarg.h>
+#include <time.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * String builder: the string is kept zero terminated, the buffer grows by half of its size (or more if needed).
+ * After a failed allocation the builder is marked as failed, all following appends are ignored and detach
+ * returns NULL
+ * 
+ * @param data - The string, NULL until the first allocation
+ * @param len - Length of the string
+ * @param capacity - Size of the buffer including the terminating zero
+ * @param failed - An allocation has failed
+ * */
+typedef struct {
+  char*  data;
+  size_t len;
+  size_t capacity;
+  bool   failed;
+} rs_builder_t;
+
+/**
+ * Builder initialization, reserve - initial capacity (0 - allocate on the first append)
+ * */
+bool rs_builder_init(rs_builder_t* builder, size_t reserve);
+
+/**
+ * Takes over a heap string created by rStrings (malloc_string...), the string must not be used or freed after that
+ * */
+void rs_builder_adopt(rs_builder_t* builder, char* str);
+
+/**
+ * Makes room for at least additional more characters
+ * */
+bool rs_builder_reserve(rs_builder_t* builder, size_t additional);
+
+/**
+ * Appending data, every function returns false if the builder has failed
+ * 
+ * rs_builder_append_sep - appends the separator before str only if the builder is not empty
+ * rs_builder_append_time - date and time, see time2str
+ * */
+bool rs_builder_append(rs_builder_t* builder, const char* str);
+bool rs_builder_appendl(rs_builder_t* builder, const char* str, size_t len);
+bool rs_builder_append_char(rs_builder_t* builder, char c);
+bool rs_builder_append_sep(rs_builder_t* builder, const char* separator, const char* str);
+bool rs_builder_append_fmt(rs_builder_t* builder, const char* format, ...);
+bool rs_builder_append_vfmt(rs_builder_t* builder, const char* format, va_list args);
+bool rs_builder_append_int(rs_builder_t* builder, int64_t value);
+bool rs_builder_append_time(rs_builder_t* builder, const char* format, time_t value);
+
+/**
+ * Returns the string and leaves the builder empty. The string must be released by rs_free() (or free() with the 
+ * default allocator). rs_builder_detach_fit() also shrinks the block to the length of the string
+ * 
+ * @return - The string ("" if nothing was appended) or NULL if the builder has failed
+ * */
+char* rs_builder_detach(rs_builder_t* builder);
+char* rs_builder_detach_fit(rs_builder_t* builder);
+
+/**
+ * Releases the string and leaves the builder empty
+ * */
+void rs_builder_free(rs_builder_t* builder);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // __R_STRINGS_BUILDER_H__
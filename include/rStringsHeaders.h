@@ -0,0 +1,218 @@
+/* 
+   EN: MQTT topic headers (prefix + location + device) built by the preprocessor from project_config.h
+   RU: Заголовки MQTT топиков (префикс + локация + устройство), собираемые препроцессором из project_config.h
+   --------------------------
+   (с) 2021 Разживин Александр | Razzhivin Alexander
+   kotyara12@yandex.ru | https://kotyara12.ru | tg: @kotyara1971
+*/
+
+#ifndef __R_STRINGS_HEADERS_H__
+#define __R_STRINGS_HEADERS_H__
+
+#include "project_config.h"
+
+// 
+// MQTT1 LOCAL
+// 
+#if defined(CONFIG_MQTT1_LOC_PREFIX)
+  // PREFIX + ...
+  #if defined(CONFIG_MQTT1_LOC_LOCATION)
+    // PREFIX + LOCATION + ...
+    #define MQTT1_LOC_HEADER_LOCATION CONFIG_MQTT1_LOC_PREFIX CONFIG_MQTT1_LOC_LOCATION "/"
+    #if defined(CONFIG_MQTT1_LOC_DEVICE)
+      // PREFIX + LOCATION + "/" + DEVICE + "/"
+      #define MQTT1_LOC_HEADER_DEVICE CONFIG_MQTT1_LOC_PREFIX CONFIG_MQTT1_LOC_LOCATION "/" CONFIG_MQTT1_LOC_DEVICE "/"
+    #else
+      // PREFIX + LOCATION + "/"
+      #define MQTT1_LOC_HEADER_DEVICE CONFIG_MQTT1_LOC_PREFIX CONFIG_MQTT1_LOC_LOCATION
+    #endif // defined(CONFIG_MQTT1_LOC_DEVICE)
+  #else
+    // PREFIX + ...
+    #define MQTT1_LOC_HEADER_LOCATION CONFIG_MQTT1_LOC_PREFIX
+    #if defined(CONFIG_MQTT1_LOC_DEVICE)
+      // PREFIX + DEVICE
+      #define MQTT1_LOC_HEADER_DEVICE CONFIG_MQTT1_LOC_PREFIX CONFIG_MQTT1_LOC_DEVICE "/"
+    #else
+      // PREFIX
+      #define MQTT1_LOC_HEADER_DEVICE CONFIG_MQTT1_LOC_PREFIX
+    #endif // defined(CONFIG_MQTT1_LOC_DEVICE)
+  #endif // defined(CONFIG_MQTT1_LOC_LOCATION)
+#else
+  // ...
+  #if defined(CONFIG_MQTT1_LOC_LOCATION)
+    // LOCATION + ...
+    #define MQTT1_LOC_HEADER_LOCATION CONFIG_MQTT1_LOC_LOCATION "/"
+    #if defined(CONFIG_MQTT1_LOC_DEVICE)
+      // LOCATION + "/" + DEVICE
+      #define MQTT1_LOC_HEADER_DEVICE CONFIG_MQTT1_LOC_LOCATION "/" CONFIG_MQTT1_LOC_DEVICE "/"
+    #else
+      // LOCATION
+      #define MQTT1_LOC_HEADER_DEVICE CONFIG_MQTT1_LOC_LOCATION "/"
+    #endif // defined(CONFIG_MQTT1_LOC_DEVICE)
+  #else
+    // ...
+    #define MQTT1_LOC_HEADER_LOCATION ""
+    #if defined(CONFIG_MQTT1_LOC_DEVICE)
+      // DEVICE
+      #define MQTT1_LOC_HEADER_DEVICE CONFIG_MQTT1_LOC_DEVICE "/"
+    #else
+      // EMPTY
+      #define MQTT1_LOC_HEADER_DEVICE ""
+    #endif // defined(CONFIG_MQTT1_LOC_DEVICE)
+  #endif // defined(CONFIG_MQTT1_LOC_LOCATION)
+#endif // defined(CONFIG_MQTT1_LOC_PREFIX)
+
+// 
+// MQTT2 LOCAL
+// 
+#if defined(CONFIG_MQTT2_LOC_PREFIX)
+  // PREFIX + ...
+  #if defined(CONFIG_MQTT2_LOC_LOCATION)
+    // PREFIX + LOCATION + ...
+    #define MQTT2_LOC_HEADER_LOCATION CONFIG_MQTT2_LOC_PREFIX CONFIG_MQTT2_LOC_LOCATION "/"
+    #if defined(CONFIG_MQTT2_LOC_DEVICE)
+      // PREFIX + LOCATION + "/" + DEVICE + "/"
+      #define MQTT2_LOC_HEADER_DEVICE CONFIG_MQTT2_LOC_PREFIX CONFIG_MQTT2_LOC_LOCATION "/" CONFIG_MQTT2_LOC_DEVICE "/"
+    #else
+      // PREFIX + LOCATION + "/"
+      #define MQTT2_LOC_HEADER_DEVICE CONFIG_MQTT2_LOC_PREFIX CONFIG_MQTT2_LOC_LOCATION
+    #endif // defined(CONFIG_MQTT2_LOC_DEVICE)
+  #else
+    // PREFIX + ...
+    #define MQTT2_LOC_HEADER_LOCATION CONFIG_MQTT2_LOC_PREFIX
+    #if defined(CONFIG_MQTT2_LOC_DEVICE)
+      // PREFIX + DEVICE
+      #define MQTT2_LOC_HEADER_DEVICE CONFIG_MQTT2_LOC_PREFIX CONFIG_MQTT2_LOC_DEVICE "/"
+    #else
+      // PREFIX
+      #define MQTT2_LOC_HEADER_DEVICE CONFIG_MQTT2_LOC_PREFIX
+    #endif // defined(CONFIG_MQTT2_LOC_DEVICE)
+  #endif // defined(CONFIG_MQTT2_LOC_LOCATION)
+#else
+  // ...
+  #if defined(CONFIG_MQTT2_LOC_LOCATION)
+    // LOCATION + ...
+    #define MQTT2_LOC_HEADER_LOCATION CONFIG_MQTT2_LOC_LOCATION "/"
+    #if defined(CONFIG_MQTT2_LOC_DEVICE)
+      // LOCATION + "/" + DEVICE
+      #define MQTT2_LOC_HEADER_DEVICE CONFIG_MQTT2_LOC_LOCATION "/" CONFIG_MQTT2_LOC_DEVICE "/"
+    #else
+      // LOCATION
+      #define MQTT2_LOC_HEADER_DEVICE CONFIG_MQTT2_LOC_LOCATION "/"
+    #endif // defined(CONFIG_MQTT2_LOC_DEVICE)
+  #else
+    // ...
+    #define MQTT2_LOC_HEADER_LOCATION ""
+    #if defined(CONFIG_MQTT2_LOC_DEVICE)
+      // DEVICE
+      #define MQTT2_LOC_HEADER_DEVICE CONFIG_MQTT2_LOC_DEVICE "/"
+    #else
+      // EMPTY
+      #define MQTT2_LOC_HEADER_DEVICE ""
+    #endif // defined(CONFIG_MQTT2_LOC_DEVICE)
+  #endif // defined(CONFIG_MQTT2_LOC_LOCATION)
+#endif // defined(CONFIG_MQTT2_LOC_PREFIX)
+
+// 
+// MQTT1 PUBLIC
+// 
+#if defined(CONFIG_MQTT1_PUB_PREFIX)
+  // PREFIX + ...
+  #if defined(CONFIG_MQTT1_PUB_LOCATION)
+    // PREFIX + LOCATION + ...
+    #define MQTT1_PUB_HEADER_LOCATION CONFIG_MQTT1_PUB_PREFIX CONFIG_MQTT1_PUB_LOCATION "/"
+    #if defined(CONFIG_MQTT1_PUB_DEVICE)
+      // PREFIX + LOCATION + "/" + DEVICE + "/"
+      #define MQTT1_PUB_HEADER_DEVICE CONFIG_MQTT1_PUB_PREFIX CONFIG_MQTT1_PUB_LOCATION "/" CONFIG_MQTT1_PUB_DEVICE "/"
+    #else
+      // PREFIX + LOCATION + "/"
+      #define MQTT1_PUB_HEADER_DEVICE CONFIG_MQTT1_PUB_PREFIX CONFIG_MQTT1_PUB_LOCATION
+    #endif // defined(CONFIG_MQTT1_PUB_DEVICE)
+  #else
+    // PREFIX + ...
+    #define MQTT1_PUB_HEADER_LOCATION CONFIG_MQTT1_PUB_PREFIX
+    #if defined(CONFIG_MQTT1_PUB_DEVICE)
+      // PREFIX + DEVICE
+      #define MQTT1_PUB_HEADER_DEVICE CONFIG_MQTT1_PUB_PREFIX CONFIG_MQTT1_PUB_DEVICE "/"
+    #else
+      // PREFIX
+      #define MQTT1_PUB_HEADER_DEVICE CONFIG_MQTT1_PUB_PREFIX
+    #endif // defined(CONFIG_MQTT1_PUB_DEVICE)
+  #endif // defined(CONFIG_MQTT1_PUB_LOCATION)
+#else
+  // ...
+  #if defined(CONFIG_MQTT1_PUB_LOCATION)
+    // LOCATION + ...
+    #define MQTT1_PUB_HEADER_LOCATION CONFIG_MQTT1_PUB_LOCATION "/"
+    #if defined(CONFIG_MQTT1_PUB_DEVICE)
+      // LOCATION + "/" + DEVICE
+      #define MQTT1_PUB_HEADER_DEVICE CONFIG_MQTT1_PUB_LOCATION "/" CONFIG_MQTT1_PUB_DEVICE "/"
+    #else
+      // LOCATION
+      #define MQTT1_PUB_HEADER_DEVICE CONFIG_MQTT1_PUB_LOCATION "/"
+    #endif // defined(CONFIG_MQTT1_PUB_DEVICE)
+  #else
+    // ...
+    #define MQTT1_PUB_HEADER_LOCATION ""
+    #if defined(CONFIG_MQTT1_PUB_DEVICE)
+      // DEVICE
+      #define MQTT1_PUB_HEADER_DEVICE CONFIG_MQTT1_PUB_DEVICE "/"
+    #else
+      // EMPTY
+      #define MQTT1_PUB_HEADER_DEVICE ""
+    #endif // defined(CONFIG_MQTT1_PUB_DEVICE)
+  #endif // defined(CONFIG_MQTT1_PUB_LOCATION)
+#endif // defined(CONFIG_MQTT1_PUB_PREFIX)
+
+// 
+// MQTT2 PUBLIC
+// 
+#if defined(CONFIG_MQTT2_PUB_PREFIX)
+  // PREFIX + ...
+  #if defined(CONFIG_MQTT2_PUB_LOCATION)
+    // PREFIX + LOCATION + ...
+    #define MQTT2_PUB_HEADER_LOCATION CONFIG_MQTT2_PUB_PREFIX CONFIG_MQTT2_PUB_LOCATION "/"
+    #if defined(CONFIG_MQTT2_PUB_DEVICE)
+      // PREFIX + LOCATION + "/" + DEVICE + "/"
+      #define MQTT2_PUB_HEADER_DEVICE CONFIG_MQTT2_PUB_PREFIX CONFIG_MQTT2_PUB_LOCATION "/" CONFIG_MQTT2_PUB_DEVICE "/"
+    #else
+      // PREFIX + LOCATION + "/"
+      #define MQTT2_PUB_HEADER_DEVICE CONFIG_MQTT2_PUB_PREFIX CONFIG_MQTT2_PUB_LOCATION
+    #endif // defined(CONFIG_MQTT2_PUB_DEVICE)
+  #else
+    // PREFIX + ...
+    #define MQTT2_PUB_HEADER_LOCATION CONFIG_MQTT2_PUB_PREFIX
+    #if defined(CONFIG_MQTT2_PUB_DEVICE)
+      // PREFIX + DEVICE
+      #define MQTT2_PUB_HEADER_DEVICE CONFIG_MQTT2_PUB_PREFIX CONFIG_MQTT2_PUB_DEVICE "/"
+    #else
+      // PREFIX
+      #define MQTT2_PUB_HEADER_DEVICE CONFIG_MQTT2_PUB_PREFIX
+    #endif // defined(CONFIG_MQTT2_PUB_DEVICE)
+  #endif // defined(CONFIG_MQTT2_PUB_LOCATION)
+#else
+  // ...
+  #if defined(CONFIG_MQTT2_PUB_LOCATION)
+    // LOCATION + ...
+    #define MQTT2_PUB_HEADER_LOCATION CONFIG_MQTT2_PUB_LOCATION "/"
+    #if defined(CONFIG_MQTT2_PUB_DEVICE)
+      // LOCATION + "/" + DEVICE
+      #define MQTT2_PUB_HEADER_DEVICE CONFIG_MQTT2_PUB_LOCATION "/" CONFIG_MQTT2_PUB_DEVICE "/"
+    #else
+      // LOCATION
+      #define MQTT2_PUB_HEADER_DEVICE CONFIG_MQTT2_PUB_LOCATION "/"
+    #endif // defined(CONFIG_MQTT2_PUB_DEVICE)
+  #else
+    // ...
+    #define MQTT2_PUB_HEADER_LOCATION ""
+    #if defined(CONFIG_MQTT2_PUB_DEVICE)
+      // DEVICE
+      #define MQTT2_PUB_HEADER_DEVICE CONFIG_MQTT2_PUB_DEVICE "/"
+    #else
+      // EMPTY
+      #define MQTT2_PUB_HEADER_DEVICE ""
+    #endif // defined(CONFIG_MQTT2_PUB_DEVICE)
+  #endif // defined(CONFIG_MQTT2_PUB_LOCATION)
+#endif // defined(CONFIG_MQTT2_PUB_PREFIX)
+
+#endif // __R_STRINGS_HEADERS_H__
@@ -0,0 +1,99 @@
+/*
+   EN: Streaming JSON writer: objects, arrays and values go straight into a sink (fixed buffer, builder, outbox)
+   RU: Потоковая запись JSON: объекты, массивы и значения выводятся сразу в sink (буфер, построитель, очередь)
+   --------------------------
+   (с) 2021 Разживин Александр | Razzhivin Alexander
+   kotyara12@yandex.ru | https://kotyara12.ru | tg: @kotyara1971
+   --------------------------
+   Example:
+     char payload[256];
+     rs_sink_buffer_t target;
+     rs_sink_t sink;
+     rs_json_t json;
+     rs_sink_init_buffer(&sink, &target, payload, sizeof(payload));
+     rs_json_init(&json, &sink);
+     rs_json_object_begin(&json, NULL);
+       rs_json_double(&json, "temperature", 21.5, 1);
+       rs_json_time(&json, "time", "%d.%m.%Y %H:%M:%S", time(NULL));
+     rs_json_object_end(&json);
+     if (rs_json_finish(&json)) esp_mqtt_client_publish(client, topic, payload, target.len, 0, 0);
+*/
+
+#ifndef __R_STRINGS_JSON_H__
+#define __R_STRINGS_JSON_H__
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <time.h>
+#include "rStringsSink.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Deepest nesting of objects and arrays
+ * */
+#define RS_JSON_MAX_DEPTH 32
+
+/**
+ * Writer state, no heap memory is used
+ *
+ * @param sink - Output
+ * @param arrays - Bit i is set if the container of level i + 1 is an array
+ * @param depth - Number of open containers
+ * @param first - No value has been written into the current container yet
+ * @param failed - The sink did not accept the output (overflow) or the calls did not form valid JSON,
+ *                 all following calls are ignored
+ * */
+typedef struct {
+  rs_sink_t* sink;
+  uint32_t   arrays;
+  uint8_t    depth;
+  bool       first;
+  bool       failed;
+} rs_json_t;
+
+void rs_json_init(rs_json_t* json, rs_sink_t* sink);
+
+/**
+ * Containers. Every value function takes a key: required inside an object, must be NULL inside an array
+ * and at the top level
+ * */
+bool rs_json_object_begin(rs_json_t* json, const char* key);
+bool rs_json_object_end(rs_json_t* json);
+bool rs_json_array_begin(rs_json_t* json, const char* key);
+bool rs_json_array_end(rs_json_t* json);
+
+/**
+ * Values
+ *
+ * rs_json_string - escaped string, NULL gives null
+ * rs_json_double - decimal value with precision digits (see double_to_str), NaN and infinity give null
+ * rs_json_fixed - fixed point value value / 10^scale (see fixed_to_str)
+ * rs_json_time - date and time as a string (see time2str)
+ * rs_json_raw - text that is already valid JSON, written as is
+ * */
+bool rs_json_string(rs_json_t* json, const char* key, const char* value);
+bool rs_json_stringl(rs_json_t* json, const char* key, const char* value, size_t len);
+bool rs_json_int(rs_json_t* json, const char* key, int64_t value);
+bool rs_json_uint(rs_json_t* json, const char* key, uint64_t value);
+bool rs_json_double(rs_json_t* json, const char* key, double value, uint8_t precision);
+bool rs_json_fixed(rs_json_t* json, const char* key, int64_t value, uint8_t scale);
+bool rs_json_bool(rs_json_t* json, const char* key, bool value);
+bool rs_json_null(rs_json_t* json, const char* key);
+bool rs_json_time(rs_json_t* json, const char* key, const char* format, time_t value);
+bool rs_json_raw(rs_json_t* json, const char* key, const char* value);
+
+/**
+ * Checks the result: true if all containers are closed and the sink has accepted the whole output
+ * (its length is sink->written)
+ * */
+bool rs_json_finish(rs_json_t* json);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // __R_STRINGS_JSON_H__
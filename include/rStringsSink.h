@@ -0,0 +1,105 @@
+/* 
+   EN: Output of formatted strings, topics and time directly into a consumer (sink), without heap strings
+   RU: Вывод форматированных строк, топиков и времени напрямую получателю (sink), без строк в куче
+   --------------------------
+   (с) 2021 Разживин Александр | Razzhivin Alexander
+   kotyara12@yandex.ru | https://kotyara12.ru | tg: @kotyara1971
+*/
+
+#ifndef __R_STRINGS_SINK_H__
+#define __R_STRINGS_SINK_H__
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdarg.h>
+#include <time.h>
+#include "rStrings.h"
+#include "rStringsBuilder.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Sink write callback: receives the next chunk of output (not zero terminated)
+ * 
+ * @return - Number of bytes accepted, less than len stops the output
+ * */
+typedef size_t (*rs_sink_write_t)(void* ctx, const char* data, size_t len);
+
+/**
+ * Sink: consumer of output, for example an MQTT outbox, a UART or a log buffer
+ * 
+ * @param write - Write callback
+ * @param ctx - User context passed to the callback
+ * @param written - Total number of bytes accepted by the sink
+ * @param failed - The sink did not accept some data, all following writes are ignored
+ * */
+typedef struct {
+  rs_sink_write_t write;
+  void*           ctx;
+  size_t          written;
+  bool            failed;
+} rs_sink_t;
+
+/**
+ * Sink initialization
+ * */
+void rs_sink_init(rs_sink_t* sink, rs_sink_write_t write, void* ctx);
+
+/**
+ * Sink into a fixed buffer: output is kept zero terminated, overflow marks the sink as failed
+ * 
+ * @param buffer - Output buffer
+ * @param size - Size of the buffer
+ * @param len - Current length of the output
+ * */
+typedef struct {
+  char*  buffer;
+  size_t size;
+  size_t len;
+} rs_sink_buffer_t;
+
+void rs_sink_init_buffer(rs_sink_t* sink, rs_sink_buffer_t* target, char* buffer, size_t size);
+
+/**
+ * Sink into a string builder: the builder grows as needed, a failed allocation marks the sink as failed
+ * */
+void rs_sink_init_builder(rs_sink_t* sink, rs_builder_t* builder);
+
+/**
+ * Writing raw data and strings
+ * */
+bool sink_write(rs_sink_t* sink, const char* data, size_t len);
+bool sink_string(rs_sink_t* sink, const char* str);
+
+/**
+ * Formatted output. The result is formatted in chunks of CONFIG_RSTRINGS_FORMAT_SCRATCH_SIZE bytes on the stack;
+ * a single formatted result longer than that uses one temporary heap block
+ * */
+bool sink_stringf(rs_sink_t* sink, const char* format, ...);
+bool sink_vstringf(rs_sink_t* sink, const char* format, va_list args);
+
+/**
+ * Date and time (see time2str) and time intervals (see timespan_to_str)
+ * */
+bool sink_time2str(rs_sink_t* sink, const char* format, time_t* value);
+bool sink_time2str_empty(rs_sink_t* sink, const char* format, time_t* value);
+bool sink_timespan(rs_sink_t* sink, int64_t value, rs_timespan_unit_t unit, rs_timespan_style_t style);
+bool sink_timespan_hms(rs_sink_t* sink, time_t value);
+bool sink_timespan_dhms(rs_sink_t* sink, time_t value);
+
+/**
+ * Topics: header + [special + /] + topics[0] + / + ... + topics[count-1], the same layout as mqttGetTopic*
+ * 
+ * Note: NULL items of topics are skipped, NULL special means "no special segment"
+ * */
+bool mqttSinkSubTopic(rs_sink_t* sink, const char* topic, const char* subtopic);
+bool mqttSinkTopic(rs_sink_t* sink, const bool primary, const bool local, const mqtt_header_t kind, const char* special, const char* const* topics, const uint8_t count);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // __R_STRINGS_SINK_H__
@@ -0,0 +1,153 @@
+/*
+   EN: Small string: up to 22 characters are stored in place, longer strings on the heap
+   RU: Короткая строка: до 22 символов хранятся на месте, более длинные строки - в куче
+   --------------------------
+   (с) 2021 Разживин Александр | Razzhivin Alexander
+   kotyara12@yandex.ru | https://kotyara12.ru | tg: @kotyara1971
+   --------------------------
+   Example (C):
+     rstr_t uptime = RSTR_INIT;
+     rstr_timespan(&uptime, esp_timer_get_time() / 1000000, RS_TIMESPAN_SECONDS, RS_TIMESPAN_DHMS);
+     esp_mqtt_client_publish(client, topic, rstr_c_str(&uptime), 0, 0, 0);
+     rstr_free(&uptime);
+   Example (C++):
+     rs::rstr value = rs::rstr::format("%.1f", temperature);
+*/
+
+#ifndef __R_STRINGS_SMALL_H__
+#define __R_STRINGS_SMALL_H__
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdarg.h>
+#include <time.h>
+#include "rStrings.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Small string of 24 bytes. The last byte is a tag: the length of an inline string (up to RSTR_INLINE_MAX),
+ * or RSTR_TAG_HEAP if the string is on the heap. A zero-filled rstr_t is an empty string
+ *
+ * Note: do not copy rstr_t by assignment while it may be on the heap, use rstr_move() or rstr_setl()
+ * */
+#define RSTR_SIZE 24
+#define RSTR_INLINE_MAX (RSTR_SIZE - 2)
+#define RSTR_TAG_HEAP 0xFF
+
+typedef union {
+  char    bytes[RSTR_SIZE];
+  struct {
+    char*  data;
+    size_t len;
+  } heap;
+} rstr_t;
+
+#define RSTR_INIT {{ 0 }}
+
+/**
+ * Access to the string, never NULL
+ * */
+const char* rstr_c_str(const rstr_t* s);
+size_t rstr_len(const rstr_t* s);
+bool rstr_is_inline(const rstr_t* s);
+
+/**
+ * Initialization as an empty string, rstr_free() releases the heap block (if any) and leaves an empty string
+ * */
+void rstr_init(rstr_t* s);
+void rstr_free(rstr_t* s);
+
+/**
+ * Replacing the content, false if out of memory (the string is empty then)
+ * */
+bool rstr_set(rstr_t* s, const char* str);
+bool rstr_setl(rstr_t* s, const char* str, size_t len);
+
+/**
+ * Moving the string to dest (the previous content of dest is released), src becomes empty
+ * */
+void rstr_move(rstr_t* dest, rstr_t* src);
+
+/**
+ * Returns a heap string that must be released by rs_free() (free() with the default allocator), s becomes empty.
+ * NULL if out of memory
+ * */
+char* rstr_detach(rstr_t* s);
+
+/**
+ * Builders: the same output as malloc_stringf, time2str, timespan_to_str and mqttGetTopic,
+ * but short results need no heap at all
+ * */
+bool rstr_format(rstr_t* s, const char* format, ...);
+bool rstr_vformat(rstr_t* s, const char* format, va_list args);
+bool rstr_time(rstr_t* s, const char* format, time_t value);
+bool rstr_timespan(rstr_t* s, int64_t value, rs_timespan_unit_t unit, rs_timespan_style_t style);
+bool rstr_topic(rstr_t* s, const bool primary, const bool local, const mqtt_header_t kind, const char *special,
+  const char * const *segments, const uint8_t count);
+
+#ifdef __cplusplus
+}
+#endif
+
+#ifdef __cplusplus
+
+namespace rs {
+
+/**
+ * Owning wrapper of rstr_t: movable, not copyable
+ * */
+class rstr {
+  public:
+    rstr() { rstr_init(&_s); };
+    explicit rstr(const char* str) { rstr_init(&_s); rstr_set(&_s, str); };
+    rstr(rstr&& other) noexcept { rstr_init(&_s); rstr_move(&_s, &other._s); };
+    rstr& operator=(rstr&& other) noexcept { if (this != &other) rstr_move(&_s, &other._s); return *this; };
+    rstr(const rstr&) = delete;
+    rstr& operator=(const rstr&) = delete;
+    ~rstr() { rstr_free(&_s); };
+
+    const char* c_str() const { return rstr_c_str(&_s); };
+    operator const char*() const { return rstr_c_str(&_s); };
+    size_t length() const { return rstr_len(&_s); };
+    bool empty() const { return rstr_len(&_s) == 0; };
+    bool is_inline() const { return rstr_is_inline(&_s); };
+    char* detach() { return rstr_detach(&_s); };
+    rstr_t* raw() { return &_s; };
+
+    static rstr format(const char* format, ...) __attribute__((format(printf, 1, 2)))
+    {
+      rstr ret;
+      va_list args;
+      va_start(args, format);
+      rstr_vformat(&ret._s, format, args);
+      va_end(args);
+      return ret;
+    };
+    static rstr time(const char* format, time_t value) { rstr ret; rstr_time(&ret._s, format, value); return ret; };
+    static rstr timespan(int64_t value, rs_timespan_unit_t unit = RS_TIMESPAN_SECONDS, rs_timespan_style_t style = RS_TIMESPAN_DHMS)
+    {
+      rstr ret;
+      rstr_timespan(&ret._s, value, unit, style);
+      return ret;
+    };
+    static rstr topic(const bool primary, const bool local, const mqtt_header_t kind, const char *special,
+      const char * const *segments, const uint8_t count)
+    {
+      rstr ret;
+      rstr_topic(&ret._s, primary, local, kind, special, segments, count);
+      return ret;
+    };
+
+  private:
+    rstr_t _s;
+};
+
+} // namespace rs
+
+#endif // __cplusplus
+
+#endif // __R_STRINGS_SMALL_H__
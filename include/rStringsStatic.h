@@ -0,0 +1,152 @@
+/* 
+   EN: Compile-time MQTT topics (C++11): header from project_config.h + literal segments, no heap and no formatting
+   RU: MQTT топики на этапе компиляции (C++11): заголовок из project_config.h + литералы, без кучи и без форматирования
+   --------------------------
+   (с) 2021 Разживин Александр | Razzhivin Alexander
+   kotyara12@yandex.ru | https://kotyara12.ru | tg: @kotyara1971
+   --------------------------
+   Example:
+     static constexpr auto topicStatus = rs::mqttStaticTopicDevice<true, false>("heater", "status");
+     esp_mqtt_client_subscribe(client, topicStatus.c_str(), 0);
+   Segments that are only known at runtime are appended as before, e.g. mqttGetSubTopic(topicStatus, name)
+*/
+
+#ifndef __R_STRINGS_STATIC_H__
+#define __R_STRINGS_STATIC_H__
+
+#ifdef __cplusplus
+
+#include <stddef.h>
+#include "rStringsHeaders.h"
+
+namespace rs {
+
+/**
+ * String of a known length N, stored in place (constexpr-constructible, ends with a zero)
+ * */
+template <size_t N>
+struct static_string {
+  char data[N + 1];
+
+  constexpr size_t size() const { return N; }
+  constexpr const char* c_str() const { return data; }
+  constexpr operator const char*() const { return data; }
+};
+
+namespace detail {
+
+template <size_t... I> struct index_seq {};
+template <size_t N, size_t... I> struct make_index_seq: make_index_seq<N - 1, N - 1, I...> {};
+template <size_t... I> struct make_index_seq<0, I...> { typedef index_seq<I...> type; };
+
+// Length of segments joined by "/"
+template <size_t... N> struct joined_len;
+template <size_t N> struct joined_len<N> { static constexpr size_t value = N; };
+template <size_t N, size_t... Rest> struct joined_len<N, Rest...> { static constexpr size_t value = N + 1 + joined_len<Rest...>::value; };
+
+template <size_t N, size_t... I>
+constexpr static_string<N - 1> literal(const char (&str)[N], index_seq<I...>)
+{
+  return static_string<N - 1>{{ str[I]..., '\0' }};
+}
+
+template <size_t N1, size_t N2, size_t... I1, size_t... I2>
+constexpr static_string<N1 + N2> concat(const static_string<N1>& a, const static_string<N2>& b, index_seq<I1...>, index_seq<I2...>)
+{
+  return static_string<N1 + N2>{{ a.data[I1]..., b.data[I2]..., '\0' }};
+}
+
+} // namespace detail
+
+/**
+ * Conversion of a string literal and concatenation
+ * */
+template <size_t N>
+constexpr static_string<N - 1> literal(const char (&str)[N])
+{
+  return detail::literal(str, typename detail::make_index_seq<N - 1>::type());
+}
+
+template <size_t N1, size_t N2>
+constexpr static_string<N1 + N2> concat(const static_string<N1>& a, const static_string<N2>& b)
+{
+  return detail::concat(a, b, typename detail::make_index_seq<N1>::type(), typename detail::make_index_seq<N2>::type());
+}
+
+/**
+ * Joining segments with "/"
+ * */
+template <size_t N>
+constexpr static_string<N> join(const static_string<N>& segment)
+{
+  return segment;
+}
+
+template <size_t N, size_t... Rest>
+constexpr static_string<detail::joined_len<N, Rest...>::value> join(const static_string<N>& first, const static_string<Rest>&... rest)
+{
+  return concat(concat(first, literal("/")), join(rest...));
+}
+
+/**
+ * Topic headers of project_config.h (see rStringsHeaders.h) as constexpr strings
+ * */
+template <bool primary, bool local> struct topic_headers;
+
+template <> struct topic_headers<true, true> {
+  static constexpr static_string<sizeof(MQTT1_LOC_HEADER_LOCATION) - 1> location() { return literal(MQTT1_LOC_HEADER_LOCATION); }
+  static constexpr static_string<sizeof(MQTT1_LOC_HEADER_DEVICE) - 1> device() { return literal(MQTT1_LOC_HEADER_DEVICE); }
+};
+
+template <> struct topic_headers<false, true> {
+  static constexpr static_string<sizeof(MQTT2_LOC_HEADER_LOCATION) - 1> location() { return literal(MQTT2_LOC_HEADER_LOCATION); }
+  static constexpr static_string<sizeof(MQTT2_LOC_HEADER_DEVICE) - 1> device() { return literal(MQTT2_LOC_HEADER_DEVICE); }
+};
+
+template <> struct topic_headers<true, false> {
+  static constexpr static_string<sizeof(MQTT1_PUB_HEADER_LOCATION) - 1> location() { return literal(MQTT1_PUB_HEADER_LOCATION); }
+  static constexpr static_string<sizeof(MQTT1_PUB_HEADER_DEVICE) - 1> device() { return literal(MQTT1_PUB_HEADER_DEVICE); }
+};
+
+template <> struct topic_headers<false, false> {
+  static constexpr static_string<sizeof(MQTT2_PUB_HEADER_LOCATION) - 1> location() { return literal(MQTT2_PUB_HEADER_LOCATION); }
+  static constexpr static_string<sizeof(MQTT2_PUB_HEADER_DEVICE) - 1> device() { return literal(MQTT2_PUB_HEADER_DEVICE); }
+};
+
+/**
+ * Generation of a name of a topic at compile time, the same layout as mqttGetTopicLocation, mqttGetTopicSpecial
+ * and mqttGetTopicDevice: prefix + location + / [+ special + /] [+ device + /] + topic1 + / + ... + topicN
+ * 
+ * Note: static topics keep the compile-time headers of project_config.h and do not follow mqttSetTopicHeaders(),
+ * do not use them if the headers are switched at runtime
+ * 
+ * @param primary - Primary or backup MQTT broker
+ * @param local - Local (hidden) topic (available only within this location)
+ * @param topics - String literals
+ * */
+template <bool primary, bool local, size_t... N>
+constexpr static_string<sizeof(topic_headers<primary, local>::location().data) - 1 + detail::joined_len<(N - 1)...>::value>
+  mqttStaticTopicLocation(const char (&...topics)[N])
+{
+  return concat(topic_headers<primary, local>::location(), join(literal(topics)...));
+}
+
+template <bool primary, bool local, size_t S, size_t... N>
+constexpr static_string<sizeof(topic_headers<primary, local>::location().data) - 1 + detail::joined_len<S - 1, (N - 1)...>::value>
+  mqttStaticTopicSpecial(const char (&special)[S], const char (&...topics)[N])
+{
+  return concat(topic_headers<primary, local>::location(), join(literal(special), literal(topics)...));
+}
+
+template <bool primary, bool local, size_t... N>
+constexpr static_string<sizeof(topic_headers<primary, local>::device().data) - 1 + detail::joined_len<(N - 1)...>::value>
+  mqttStaticTopicDevice(const char (&...topics)[N])
+{
+  return concat(topic_headers<primary, local>::device(), join(literal(topics)...));
+}
+
+} // namespace rs
+
+#endif // __cplusplus
+
+#endif // __R_STRINGS_STATIC_H__
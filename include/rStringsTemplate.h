@@ -0,0 +1,83 @@
+/*
+   EN: Templates with named placeholders: compiled once, rendered many times without parsing the format
+   RU: Шаблоны с именованными подстановками: компилируются один раз, выводятся многократно без разбора формата
+   --------------------------
+   (с) 2021 Разживин Александр | Razzhivin Alexander
+   kotyara12@yandex.ru | https://kotyara12.ru | tg: @kotyara1971
+   --------------------------
+   Syntax: "${name}" is replaced by the value of the variable name, "$$" gives "$", any other "$" is kept as is
+   Example:
+     rs_template_t* tpl = rs_template_compile("${location}/${device}/${sensor}/value");
+     const char* args[] = { "village", "greenhouse", "temperature" };
+     char* topic = rs_template_render_args(tpl, args, 3);
+     ...
+     rs_free(topic);
+     rs_template_free(tpl);
+*/
+
+#ifndef __R_STRINGS_TEMPLATE_H__
+#define __R_STRINGS_TEMPLATE_H__
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include "rStringsSink.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Largest number of different placeholders in one template
+ * */
+#define RS_TEMPLATE_MAX_ARGS 32
+
+typedef struct rs_template_t rs_template_t;
+
+/**
+ * Variable for rendering by name
+ * */
+typedef struct {
+  const char* name;
+  const char* value;
+} rs_template_var_t;
+
+/**
+ * Compiling a template into literal and placeholder segments (one heap block)
+ *
+ * @return - The template or NULL on a syntax error ("${" without "}", empty name, too many names) or out of memory
+ * */
+rs_template_t* rs_template_compile(const char* text);
+void rs_template_free(rs_template_t* tpl);
+
+/**
+ * Different placeholder names in the order of their first appearance, the index is the position in args
+ * */
+uint8_t rs_template_arg_count(const rs_template_t* tpl);
+const char* rs_template_arg_name(const rs_template_t* tpl, uint8_t index);
+int rs_template_arg_index(const rs_template_t* tpl, const char* name);
+
+/**
+ * Rendering with values by the index of the placeholder (args) or by its name (vars).
+ * Missing and NULL values give an empty string
+ *
+ * rs_template_length_* - length of the result without the terminating zero
+ * rs_template_render_* - heap string of the exact size, must be released by rs_free(); NULL if out of memory
+ * rs_template_format_* - into a buffer, returns the length or 0 if the buffer is too small (then it holds "")
+ * rs_template_sink_* - into a sink
+ * */
+size_t rs_template_length_args(const rs_template_t* tpl, const char* const* args, size_t count);
+char* rs_template_render_args(const rs_template_t* tpl, const char* const* args, size_t count);
+size_t rs_template_format_args(const rs_template_t* tpl, const char* const* args, size_t count, char* buffer, size_t buffer_size);
+bool rs_template_sink_args(rs_sink_t* sink, const rs_template_t* tpl, const char* const* args, size_t count);
+
+size_t rs_template_length_vars(const rs_template_t* tpl, const rs_template_var_t* vars, size_t count);
+char* rs_template_render_vars(const rs_template_t* tpl, const rs_template_var_t* vars, size_t count);
+size_t rs_template_format_vars(const rs_template_t* tpl, const rs_template_var_t* vars, size_t count, char* buffer, size_t buffer_size);
+bool rs_template_sink_vars(rs_sink_t* sink, const rs_template_t* tpl, const rs_template_var_t* vars, size_t count);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // __R_STRINGS_TEMPLATE_H__
@@ -0,0 +1,104 @@
+/* 
+   EN: Fast date and time strings: incremental cache of rendered timestamps
+   RU: Быстрое формирование строк даты и времени: инкрементальный кэш сформированных меток времени
+   --------------------------
+   (с) 2021 Разживин Александр | Razzhivin Alexander
+   kotyara12@yandex.ru | https://kotyara12.ru | tg: @kotyara1971
+*/
+
+#ifndef __R_STRINGS_TIME_H__
+#define __R_STRINGS_TIME_H__
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <time.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * The same as time2str, but through a per-format cache: the last time, its local time and the rendered string
+ * are kept for every format. A later time within the same hour only patches the minutes and seconds digits,
+ * localtime_r and strftime are called again only when the hour changes. time2str and time2str_empty use the 
+ * cache automatically if CONFIG_RSTRINGS_TIME_CACHE_SLOTS > 0
+ * 
+ * Note: call time2str_cache_reset() after changing the time zone (TZ)
+ * 
+ * @return - Length of the string or 0 if the buffer is too small
+ * */
+size_t time2str_cached(const char *format, time_t value, char* buffer, size_t buffer_size);
+void time2str_cache_reset(void);
+
+/**
+ * Statistics of the time cache
+ * 
+ * @param hits - Calls with the same time as the previous one
+ * @param patches - Calls answered by patching minutes and seconds
+ * @param renders - Calls that required localtime_r and strftime
+ * */
+typedef struct {
+  uint32_t hits;
+  uint32_t patches;
+  uint32_t renders;
+} rs_time_cache_stats_t;
+
+void time2str_cache_stats(rs_time_cache_stats_t* stats);
+
+/**
+ * Precompiled strftime format: the format is parsed once into a list of operations (literal runs, numeric fields,
+ * names), rendering does not parse anything. Names of days, months and AM/PM are those of the "C" locale; 
+ * specifiers that depend on the locale or on the time zone (%c, %x, %X, %z, %Z, %s, %G...) and any flags are
+ * kept as pieces of the format and rendered by strftime
+ * */
+#define RS_TIMEFMT_MAX_OPS 24
+#define RS_TIMEFMT_MAX_TEXT 48
+
+typedef struct {
+  uint8_t code;
+  uint8_t arg;
+  uint8_t len;
+} rs_timefmt_op_t;
+
+typedef struct {
+  rs_timefmt_op_t ops[RS_TIMEFMT_MAX_OPS];
+  char text[RS_TIMEFMT_MAX_TEXT];         // Literal runs and pieces for strftime
+  uint8_t count;
+  uint8_t text_len;
+} rs_timefmt_t;
+
+/**
+ * Compiles format into program
+ * @return - false if the format is too long (see RS_TIMEFMT_MAX_OPS and RS_TIMEFMT_MAX_TEXT) or ends with a single %
+ * */
+bool rs_timefmt_compile(rs_timefmt_t* program, const char* format);
+
+/**
+ * Renders the compiled format from struct tm (as strftime) or from time_t (as time2str)
+ * @return - Length of the string or 0 if the buffer is too small
+ * */
+size_t rs_timefmt_render(const rs_timefmt_t* program, const struct tm* timeinfo, char* buffer, size_t buffer_size);
+size_t rs_timefmt_render_time(const rs_timefmt_t* program, time_t value, char* buffer, size_t buffer_size);
+
+/**
+ * Conversion of time_t to local time without localtime_r: rs_tz_update() finds the UTC offsets and the instants of
+ * DST transitions of the current TZ from now for CONFIG_RSTRINGS_TZ_WINDOW_DAYS days, rs_localtime_r() is then a
+ * table lookup plus arithmetic and does not take the environment lock. Times outside the table (and all times before
+ * the first rs_tz_update) are converted by localtime_r. time2str and rs_timefmt_render_time use rs_localtime_r
+ * 
+ * Note: call rs_tz_update() after setting TZ and after the first time synchronization, then once in a few months;
+ * it also resets the time cache of time2str
+ * 
+ * @param now - Beginning of the window, 0 - current time
+ * @return - false if the transitions do not fit into the table (the table is not used then)
+ * */
+bool rs_tz_update(time_t now);
+void rs_tz_invalidate(void);
+struct tm* rs_localtime_r(const time_t* value, struct tm* result);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // __R_STRINGS_TIME_H__
@@ -0,0 +1,178 @@
+/* 
+   EN: MQTT topics: interning of repeatedly generated topics, runtime headers and parsing of incoming topics
+   RU: MQTT топики: кэширование многократно генерируемых топиков, заголовки во время работы и разбор входящих топиков
+   --------------------------
+   (с) 2021 Разживин Александр | Razzhivin Alexander
+   kotyara12@yandex.ru | https://kotyara12.ru | tg: @kotyara1971
+*/
+
+#ifndef __R_STRINGS_TOPICS_H__
+#define __R_STRINGS_TOPICS_H__
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include "rStrings.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Interned topic: header + [special + /] + topics[0] + / + ... + topics[count-1]
+ * Repeated calls with the same arguments return the same string without formatting and allocation
+ * 
+ * Note: NULL items of topics are skipped, NULL special means "no special segment"
+ * 
+ * @param primary - Primary or backup MQTT broker
+ * @param local - Local (hidden) topic (available only within this location)
+ * @param kind - Location or device header
+ * @param special - Special segment after the header (only meaningful for MQTT_HEADER_LOCATION), may be NULL
+ * @param topics - Topic segments
+ * @param count - Number of topic segments
+ * @return - Pointer to a shared string, do not free it. Valid until mqttInternInvalidate().
+ *           NULL if the cache is full (CONFIG_RSTRINGS_INTERN_CAPACITY) or out of memory: use mqttGetTopic* instead
+ * */
+const char * mqttInternTopic(const bool primary, const bool local, const mqtt_header_t kind, const char *special, const char * const *topics, const uint8_t count);
+
+/**
+ * Dropping all interned topics, for example, after the topic headers have been changed.
+ * All pointers returned by mqttInternTopic() become invalid
+ * */
+void mqttInternInvalidate(void);
+
+/**
+ * Statistics of the topic cache
+ * 
+ * @param hits - Requests answered from the cache
+ * @param misses - Requests that generated a new topic
+ * @param overflows - Requests rejected because the cache was full
+ * @param count - Topics currently stored
+ * @param capacity - Maximum number of topics
+ * @param bytes - Memory used by the stored strings
+ * */
+typedef struct {
+  uint32_t hits;
+  uint32_t misses;
+  uint32_t overflows;
+  uint16_t count;
+  uint16_t capacity;
+  size_t   bytes;
+} mqtt_intern_stats_t;
+
+void mqttInternGetStats(mqtt_intern_stats_t *stats);
+
+/**
+ * Changing the topic headers of one broker and scope at runtime (a new location or device name, switching brokers)
+ * without reflashing. The headers are built as in project_config.h: prefix + location + / for MQTT_HEADER_LOCATION,
+ * prefix + location + / + device + / for MQTT_HEADER_DEVICE, NULL or empty parts are omitted.
+ * 
+ * Note: tasks generating topics are not blocked, they see either the old or the new headers. Pointers returned by
+ * mqttGetTopicHeader() stay valid until the headers are changed once more. Interned topics built with the previous
+ * headers are not returned any more, call mqttInternInvalidate() to release them when they are no longer used
+ * 
+ * @param primary - Primary or backup MQTT broker
+ * @param local - Local (hidden) topics
+ * @param prefix, location, device - New parts of the headers
+ * @return - false if the headers do not fit into CONFIG_RSTRINGS_TOPIC_HEADERS_SIZE, the headers are not changed
+ * */
+bool mqttSetTopicHeaders(const bool primary, const bool local, const char *prefix, const char *location, const char *device);
+
+/**
+ * Restoring all topic headers from project_config.h
+ * */
+void mqttResetTopicHeaders(void);
+
+/**
+ * Counter of the header changes, for example, to rebuild cached topics and subscriptions
+ * */
+uint32_t mqttGetTopicHeadersGeneration(void);
+
+/**
+ * Parsed incoming topic: views into the original string, nothing is copied
+ * */
+#define MQTT_TOPIC_MAX_SEGMENTS 8
+
+typedef struct {
+  uint16_t offset;
+  uint16_t len;
+} mqtt_segment_t;
+
+/**
+ * @param primary, local, kind - The header that matched, see mqttGetTopicHeader
+ * @param header_len - Length of the header (with the "/" after it)
+ * @param special - Index of the special segment in specials, -1 if there is none
+ * @param count - Number of segments after the header (and the special segment)
+ * @param truncated - The topic has more than MQTT_TOPIC_MAX_SEGMENTS segments, the last one holds the rest
+ * */
+typedef struct {
+  bool           primary;
+  bool           local;
+  mqtt_header_t  kind;
+  uint16_t       header_len;
+  int8_t         special;
+  uint8_t        count;
+  bool           truncated;
+  mqtt_segment_t segments[MQTT_TOPIC_MAX_SEGMENTS];
+} mqtt_topic_parts_t;
+
+/**
+ * Splitting an incoming topic against the configured headers, the inverse of mqttGetTopicLocation, 
+ * mqttGetTopicSpecial and mqttGetTopicDevice: the longest matching header wins (equal headers are reported as 
+ * primary, local and location before the others). After a location header the first segment is reported as 
+ * special if it is one of specials
+ * 
+ * @param topic - Incoming topic (not necessarily zero terminated)
+ * @param len - Length of the topic
+ * @param specials - Known special segments, may be NULL
+ * @param specials_count - Number of specials, at most INT8_MAX
+ * @return - false if the topic does not begin with any header or there are too many specials
+ * */
+bool mqttParseTopic(const char *topic, size_t len, const char * const *specials, const uint8_t specials_count, mqtt_topic_parts_t *parts);
+
+/**
+ * Comparing and copying a segment of a parsed topic
+ * */
+bool mqttSegmentEquals(const char *topic, const mqtt_segment_t segment, const char *value);
+size_t mqttSegmentCopy(const char *topic, const mqtt_segment_t segment, char *buffer, size_t buffer_size);
+
+/**
+ * Description of one topic of a table, the same arguments as mqttGetTopic
+ * */
+typedef struct {
+  bool               primary;
+  bool               local;
+  mqtt_header_t      kind;
+  const char        *special;
+  const char * const *segments;
+  uint8_t            count;
+} mqtt_topic_desc_t;
+
+/**
+ * Topic table: all topics of the list in one heap block (an offset index followed by the strings),
+ * built with one allocation and released with one free. Total memory use is printed to the log
+ *
+ * Note: the table keeps the headers of the moment it was built, compare mqttTopicTableGeneration() with
+ * mqttGetTopicHeadersGeneration() to find out if it has to be rebuilt
+ *
+ * @return - The table or NULL if out of memory
+ * */
+typedef struct mqtt_topic_table_t mqtt_topic_table_t;
+
+mqtt_topic_table_t * mqttTopicTableCreate(const mqtt_topic_desc_t *topics, const uint16_t count);
+void mqttTopicTableFree(mqtt_topic_table_t *table);
+
+/**
+ * Access to the table: topics in the order of the list, NULL for an index out of range
+ * */
+uint16_t mqttTopicTableCount(const mqtt_topic_table_t *table);
+const char * mqttTopicTableGet(const mqtt_topic_table_t *table, const uint16_t index);
+size_t mqttTopicTableLength(const mqtt_topic_table_t *table, const uint16_t index);
+size_t mqttTopicTableSize(const mqtt_topic_table_t *table);
+uint32_t mqttTopicTableGeneration(const mqtt_topic_table_t *table);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // __R_STRINGS_TOPICS_H__
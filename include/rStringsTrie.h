@@ -0,0 +1,87 @@
+/* 
+   EN: MQTT topics: routing of incoming messages through a subscription trie with + and # wildcards
+   RU: MQTT топики: маршрутизация входящих сообщений через дерево подписок с масками + и #
+   --------------------------
+   (с) 2021 Разживин Александр | Razzhivin Alexander
+   kotyara12@yandex.ru | https://kotyara12.ru | tg: @kotyara1971
+*/
+
+#ifndef __R_STRINGS_TRIE_H__
+#define __R_STRINGS_TRIE_H__
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include "rStrings.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Message handler
+ * 
+ * @param topic - Incoming topic
+ * @param ctx - Context given at subscription
+ * @param message - Context given to mqttTrieDispatch (for example the payload)
+ * */
+typedef void (*mqtt_handler_t)(const char* topic, void* ctx, void* message);
+
+/**
+ * Subscription trie: topic levels are nodes, edges are kept in one hash table, so dispatching a topic takes
+ * O(number of levels) lookups and allocates nothing. Memory is allocated only by subscriptions
+ * 
+ * Note: subscribe and unsubscribe must not run concurrently with dispatch (the trie has no locks, handlers
+ * are called directly from mqttTrieDispatch)
+ * */
+typedef struct mqtt_trie_t mqtt_trie_t;
+
+mqtt_trie_t* mqttTrieCreate(void);
+void mqttTrieFree(mqtt_trie_t* trie);
+
+/**
+ * Adding a subscription: a full topic or a filter with + (one level) and # (all remaining levels, last only)
+ * 
+ * @return - false if the filter is invalid, deeper than CONFIG_RSTRINGS_TRIE_MAX_LEVELS or out of memory
+ * */
+bool mqttTrieSubscribe(mqtt_trie_t* trie, const char* filter, mqtt_handler_t handler, void* ctx);
+
+/**
+ * Adding a subscription for header + filter, where the header is the same as in mqttGetTopic*:
+ * mqttTrieSubscribeHeader(trie, true, false, MQTT_HEADER_DEVICE, "heater/+/set", ...)
+ * */
+bool mqttTrieSubscribeHeader(mqtt_trie_t* trie, const bool primary, const bool local, const mqtt_header_t kind, const char* filter, mqtt_handler_t handler, void* ctx);
+
+/**
+ * Removing a subscription with the same filter, handler and context
+ * */
+bool mqttTrieUnsubscribe(mqtt_trie_t* trie, const char* filter, mqtt_handler_t handler, void* ctx);
+
+/**
+ * Calls the handlers of all subscriptions that match topic. Topics beginning with $ are not matched 
+ * by wildcards at the first level (MQTT 3.1.1, 4.7.2)
+ * 
+ * @return - Number of handlers called
+ * */
+uint16_t mqttTrieDispatch(const mqtt_trie_t* trie, const char* topic, void* message);
+
+/**
+ * Statistics of the trie
+ * 
+ * @param subscriptions - Number of subscriptions
+ * @param nodes - Number of topic levels stored
+ * @param bytes - Memory used by the trie
+ * */
+typedef struct {
+  uint32_t subscriptions;
+  uint32_t nodes;
+  size_t   bytes;
+} mqtt_trie_stats_t;
+
+void mqttTrieGetStats(const mqtt_trie_t* trie, mqtt_trie_stats_t* stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // __R_STRINGS_TRIE_H__
@@ -2,16 +2,17 @@
 #include "project_config.h"
 #include "def_consts.h"
 #include "rLog.h"
+#include "rStringsHeaders.h"
+#include "rStringsTime.h"
+#include "rStringsBuilder.h"
+#include "rStringsTopicHeaders.h"
+#include "rStringsConfig.h"
+#include "rStringsPort.h"
 #include <stdio.h>
 #include <stdarg.h>
 #include <stdlib.h>
 #include <string.h>
-#if defined(__has_include) && __has_include("reEsp32.h")
-  #include "reEsp32.h"
-  #define USE_ESP_MALLOC 1
-#else
-  #define USE_ESP_MALLOC 0
-#endif
+#include <math.h>
 
 #if CONFIG_RLOG_PROJECT_LEVEL > RLOG_LEVEL_NONE
 static const char * tagHEAP = "OUT OF MEMORY";
@@ -26,17 +27,12 @@ char * malloc_string(const char *source)
 {
   if (source) {
     uint32_t len = strlen(source);
-    #if USE_ESP_MALLOC
-      char *ret = (char*)psram_malloc(len+1);
-    #else
-      char *ret = (char*)malloc(len+1);
-    #endif
+    char *ret = (char*)rs_malloc(len+1);
     if (ret == nullptr) {
       rlog_e(tagHEAP, "Failed to create string: out of memory!");
       return nullptr;
     }
-    memset(ret, 0, len+1);
-    strcpy(ret, source);
+    memcpy(ret, source, len+1);
     return ret;
   };
   return nullptr;
@@ -45,43 +41,55 @@ char * malloc_string(const char *source)
 char * malloc_stringl(const char *source, const uint32_t len) 
 {
   if (source) {
-    #if USE_ESP_MALLOC
-      char *ret = (char*)psram_malloc(len+1);
-    #else
-      char *ret = (char*)malloc(len+1);
-    #endif
+    char *ret = (char*)rs_malloc(len+1);
     if (ret == nullptr) {
       rlog_e(tagHEAP, "Failed to create string: out of memory!");
       return nullptr;
     }
-    memset(ret, 0, len+1);
-    strncpy(ret, source, len);
+    // copy up to len characters, the source may be shorter
+    const char *end = (const char*)memchr(source, 0, len);
+    size_t size = end ? (size_t)(end - source) : len;
+    memcpy(ret, source, size);
+    ret[size] = '\0';
     return ret;
   };
   return nullptr;
 }
 
-char * malloc_stringf(const char *format, ...) 
+char * vmalloc_stringf(const char *format, va_list args) 
 {
   char *ret = nullptr;
   if (format != nullptr) {
-    // get the list of arguments
-    va_list args1, args2;
-    va_start(args1, format);
-    va_copy(args2, args1);
-    // calculate length of resulting string
-    int len = vsnprintf(nullptr, 0, format, args1);
-    va_end(args1);
+    va_list args2;
+    va_copy(args2, args);
+    #if CONFIG_RSTRINGS_FORMAT_SCRATCH_SIZE > 0
+      // format once into the scratch buffer, most strings fit there
+      #if CONFIG_RSTRINGS_FORMAT_SCRATCH_TLS
+        RS_THREAD_LOCAL char scratch[CONFIG_RSTRINGS_FORMAT_SCRATCH_SIZE];
+      #else
+        char scratch[CONFIG_RSTRINGS_FORMAT_SCRATCH_SIZE];
+      #endif // CONFIG_RSTRINGS_FORMAT_SCRATCH_TLS
+      int len = vsnprintf(scratch, sizeof(scratch), format, args);
+      bool fits = len < (int)sizeof(scratch);
+    #else
+      // calculate length of resulting string
+      int len = vsnprintf(nullptr, 0, format, args);
+      bool fits = false;
+    #endif // CONFIG_RSTRINGS_FORMAT_SCRATCH_SIZE
     // allocate memory for string
     if (len > 0) {
-      #if USE_ESP_MALLOC
-        ret = (char*)psram_malloc(len+1);
-      #else
-        ret = (char*)malloc(len+1);
-      #endif
+      ret = (char*)rs_malloc(len+1);
       if (ret != nullptr) {
-        memset(ret, 0, len+1);
-        vsnprintf(ret, len+1, format, args2);
+        #if CONFIG_RSTRINGS_FORMAT_SCRATCH_SIZE > 0
+          if (fits) {
+            memcpy(ret, scratch, len+1);
+          } else {
+            vsnprintf(ret, len+1, format, args2);
+          };
+        #else
+          (void)fits;
+          vsnprintf(ret, len+1, format, args2);
+        #endif // CONFIG_RSTRINGS_FORMAT_SCRATCH_SIZE
       } else {
         rlog_e(tagHEAP, "Failed to format string: out of memory!");
       };
@@ -91,112 +99,390 @@ char * malloc_stringf(const char *format, ...)
   return ret;
 }
 
+char * malloc_stringf(const char *format, ...) 
+{
+  va_list args;
+  va_start(args, format);
+  char *ret = vmalloc_stringf(format, args);
+  va_end(args);
+  return ret;
+}
+
 uint16_t format_string(char* buffer, uint16_t buffer_size, const char *format, ...)
 {
   uint16_t ret = 0;
-  if (buffer && format) {
-    memset(buffer, 0, buffer_size);
-    // get the list of arguments
+  if (buffer && format && buffer_size) {
+    // format string in one pass, vsnprintf reports the full length even if the output was truncated
     va_list args;
     va_start(args, format);
-    uint16_t len = vsnprintf(nullptr, 0, format, args);
-    // format string
-    if (len+1 > buffer_size) {
-      ret = -len;
-      rlog_e(tagFMTS, "Buffer %d bytes too small to hold formatted string, %d bytes needed", buffer_size, len+1);
-    };
-    ret = vsnprintf(buffer, buffer_size, format, args);
+    int len = vsnprintf(buffer, buffer_size, format, args);
     va_end(args);
+    if (len < 0) {
+      buffer[0] = '\0';
+    } else {
+      if (len+1 > buffer_size) {
+        rlog_e(tagFMTS, "Buffer %d bytes too small to hold formatted string, %d bytes needed", buffer_size, len+1);
+      };
+      ret = len;
+    };
   };
   return ret;
 }
 
-char* _i64toa(int64_t value, char* buffer, uint8_t radix) 
+// -----------------------------------------------------------------------------------------------------------------------
+// ------------------------------------------------- Integer to string ---------------------------------------------------
+// -----------------------------------------------------------------------------------------------------------------------
+
+static const char _digits[] = "0123456789abcdef";
+
+static const char _digits2[201] = 
+  "00010203040506070809"
+  "10111213141516171819"
+  "20212223242526272829"
+  "30313233343536373839"
+  "40414243444546474849"
+  "50515253545556575859"
+  "60616263646566676869"
+  "70717273747576777879"
+  "80818283848586878889"
+  "90919293949596979899";
+
+static inline uint8_t decDigits32(uint32_t value)
 {
-  // Check radix
-  if (radix < 2 || radix > 16) { 
-    *buffer = '\0'; 
-    return buffer; 
+  if (value < 10) return 1;
+  if (value < 100) return 2;
+  if (value < 1000) return 3;
+  if (value < 10000) return 4;
+  if (value < 100000) return 5;
+  if (value < 1000000) return 6;
+  if (value < 10000000) return 7;
+  if (value < 100000000) return 8;
+  if (value < 1000000000) return 9;
+  return 10;
+}
+
+// Writes exactly digits characters of value (right-aligned), two digits per step
+static inline void decWrite32(uint32_t value, char* buffer, uint8_t digits)
+{
+  char* pos = buffer + digits;
+  while (value >= 100) {
+    pos -= 2;
+    memcpy(pos, &_digits2[(value % 100) * 2], 2);
+    value /= 100;
   };
+  if (value >= 10) {
+    pos -= 2;
+    memcpy(pos, &_digits2[value * 2], 2);
+  } else {
+    *--pos = '0' + value;
+  };
+  // leading zeros of a padded block
+  while (pos > buffer) *--pos = '0';
+}
 
-  uint8_t negative, digit;
-  uint64_t val;
-  char *pos = buffer, *pos1 = buffer, tmp;
+static size_t decToStr(uint64_t value, char* buffer)
+{
+  // 32-bit fast path: no 64-bit division at all
+  if (value <= UINT32_MAX) {
+    uint8_t digits = decDigits32((uint32_t)value);
+    decWrite32((uint32_t)value, buffer, digits);
+    return digits;
+  };
+  // Split into blocks of 8 digits: at most two 64-bit divisions
+  uint32_t low = (uint32_t)(value % 100000000);
+  uint64_t high = value / 100000000;
+  size_t len;
+  if (high <= UINT32_MAX) {
+    len = decDigits32((uint32_t)high);
+    decWrite32((uint32_t)high, buffer, len);
+  } else {
+    uint32_t top = (uint32_t)(high / 100000000);
+    uint32_t middle = (uint32_t)(high % 100000000);
+    len = decDigits32(top);
+    decWrite32(top, buffer, len);
+    decWrite32(middle, buffer + len, 8);
+    len += 8;
+  };
+  decWrite32(low, buffer + len, 8);
+  return len + 8;
+}
 
-  if (value < 0 && radix == 10) {
-    negative = 1;
-    val = - value;
+static size_t pow2ToStr(uint64_t value, char* buffer, uint8_t shift)
+{
+  uint8_t bits = value ? 64 - __builtin_clzll(value) : 1;
+  size_t len = (bits + shift - 1) / shift;
+  const uint8_t mask = (1 << shift) - 1;
+  char* pos = buffer + len;
+  if (value <= UINT32_MAX) {
+    uint32_t val = (uint32_t)value;
+    do {
+      *--pos = _digits[val & mask];
+      val >>= shift;
+    } while (pos > buffer);
   } else {
-    negative = 0;
-    val = value;
+    do {
+      *--pos = _digits[value & mask];
+      value >>= shift;
+    } while (pos > buffer);
   };
+  return len;
+}
 
+static size_t anyToStr(uint64_t value, char* buffer, uint8_t radix)
+{
+  // Other radixes are rare: digits are produced from the end into a temporary buffer
+  char temp[64];
+  char* pos = temp + sizeof(temp);
+  while (value > UINT32_MAX) {
+    *--pos = _digits[value % radix];
+    value /= radix;
+  };
+  uint32_t val = (uint32_t)value;
   do {
-    digit = val % radix;
-    val = val / radix;
-    if (digit < 10) {
-      *pos++ = '0' + digit;
-    } else {
-      *pos++ = 'a' + digit - 10;
-    };
-  } while (val != 0L);
-
-  if (negative) *pos++ = '-'; 
-  
-  *pos-- = '\0';
+    *--pos = _digits[val % radix];
+    val /= radix;
+  } while (val != 0);
+  size_t len = temp + sizeof(temp) - pos;
+  memcpy(buffer, pos, len);
+  return len;
+}
 
-  while(pos1 < pos) {
-    tmp = *pos;
-    *pos--= *pos1;
-    *pos1++ = tmp;
+static size_t uintToStr(uint64_t value, char* buffer, uint8_t radix)
+{
+  switch (radix) {
+    case 10: return decToStr(value, buffer);
+    case 16: return pow2ToStr(value, buffer, 4);
+    case 8:  return pow2ToStr(value, buffer, 3);
+    case 2:  return pow2ToStr(value, buffer, 1);
+    case 4:  return pow2ToStr(value, buffer, 2);
+    default: return anyToStr(value, buffer, radix);
   };
+}
 
-  return buffer;
+size_t ui64_to_str(uint64_t value, char* buffer, uint8_t radix)
+{
+  // Check radix
+  if (radix < 2 || radix > 16) { 
+    *buffer = '\0'; 
+    return 0; 
+  };
+  size_t len = uintToStr(value, buffer, radix);
+  buffer[len] = '\0';
+  return len;
 }
 
-char* _ui64toa(uint64_t value, char* buffer, uint8_t radix) 
+size_t i64_to_str(int64_t value, char* buffer, uint8_t radix)
 {
   // Check radix
   if (radix < 2 || radix > 16) { 
     *buffer = '\0'; 
-    return buffer; 
+    return 0; 
   };
+  size_t len;
+  if (value < 0) {
+    // the magnitude is computed in unsigned arithmetic, so INT64_MIN is handled too
+    *buffer = '-';
+    len = uintToStr(0 - (uint64_t)value, buffer + 1, radix) + 1;
+  } else {
+    len = uintToStr((uint64_t)value, buffer, radix);
+  };
+  buffer[len] = '\0';
+  return len;
+}
 
-  uint8_t digit;
-  uint64_t val;
-  char *pos = buffer, *pos1 = buffer, tmp;
+char* _i64toa(int64_t value, char* buffer, uint8_t radix) 
+{
+  i64_to_str(value, buffer, radix);
+  return buffer;
+}
 
-  val = value;
-  do {
-    digit = val % radix;
-    val = val / radix;
-    if (digit < 10) {
-      *pos++ = '0' + digit;
-    } else {
-      *pos++ = 'a' + digit - 10;
+char* _ui64toa(uint64_t value, char* buffer, uint8_t radix) 
+{
+  ui64_to_str(value, buffer, radix);
+  return buffer;
+}
+
+// -----------------------------------------------------------------------------------------------------------------------
+// ------------------------------------------------- Decimal to string ---------------------------------------------------
+// -----------------------------------------------------------------------------------------------------------------------
+
+static const uint64_t _pow10[] = {
+  1ULL, 10ULL, 100ULL, 1000ULL, 10000ULL, 100000ULL, 1000000ULL, 10000000ULL, 100000000ULL, 1000000000ULL,
+  10000000000ULL, 100000000000ULL, 1000000000000ULL, 10000000000000ULL, 100000000000000ULL,
+  1000000000000000ULL, 10000000000000000ULL, 100000000000000000ULL, 1000000000000000000ULL
+};
+
+static const rs_decimal_format_t _decimalDefault = { 2, RS_ROUND_HALF_UP, '.', "nan", "inf" };
+
+// Writes exactly digits characters (zero padded) of value < 10^digits
+static char* decWritePadded(uint64_t value, char* pos, uint8_t digits)
+{
+  if (digits > 9) {
+    decWrite32((uint32_t)(value / 1000000000), pos, digits - 9);
+    decWrite32((uint32_t)(value % 1000000000), pos + digits - 9, 9);
+  } else if (digits > 0) {
+    decWrite32((uint32_t)value, pos, digits);
+  };
+  return pos + digits;
+}
+
+// Decides whether the kept part must be incremented after dropping a remainder of rem / unit
+static inline bool roundUp(rs_rounding_t rounding, uint64_t kept, bool greater, bool equal)
+{
+  switch (rounding) {
+    case RS_ROUND_DOWN:      return false;
+    case RS_ROUND_HALF_EVEN: return greater || (equal && (kept & 1));
+    default:                 return greater || equal;
+  };
+}
+
+// Writes [-]integer[.fraction] to pos, returns the end of the output
+static char* decimalWrite(char* pos, bool negative, uint64_t integer, uint64_t fraction, const rs_decimal_format_t* format)
+{
+  if (negative) *pos++ = '-';
+  pos += decToStr(integer, pos);
+  if (format->precision > 0) {
+    *pos++ = format->point;
+    pos = decWritePadded(fraction, pos, format->precision);
+  };
+  return pos;
+}
+
+static size_t decimalCopy(const char* temp, size_t len, char* buffer, size_t buffer_size)
+{
+  if ((buffer == nullptr) || (buffer_size == 0)) return 0;
+  if (len + 1 > buffer_size) {
+    buffer[0] = '\0';
+    return 0;
+  };
+  memcpy(buffer, temp, len);
+  buffer[len] = '\0';
+  return len;
+}
+
+size_t double_to_str_ex(double value, const rs_decimal_format_t* format, char* buffer, size_t buffer_size)
+{
+  rs_decimal_format_t fmt = format ? *format : _decimalDefault;
+  if (fmt.precision > RS_DECIMAL_MAX_PRECISION) fmt.precision = RS_DECIMAL_MAX_PRECISION;
+  char temp[RS_DECIMAL_BUFFER_SIZE];
+  char* pos = temp;
+  bool negative = signbit(value);
+  double abs = fabs(value);
+
+  if (isnan(value)) {
+    return decimalCopy(fmt.nan ? fmt.nan : "nan", strlen(fmt.nan ? fmt.nan : "nan"), buffer, buffer_size);
+  } else if (isinf(value)) {
+    if (negative) *pos++ = '-';
+    const char* inf = fmt.inf ? fmt.inf : "inf";
+    size_t len = strlen(inf);
+    if (len > sizeof(temp) - 2) len = sizeof(temp) - 2;
+    memcpy(pos, inf, len);
+    pos += len;
+  } else if (abs < 1e18) {
+    // Fixed notation: the integer part is exact, the fraction is scaled to the precision and rounded
+    uint64_t integer = (uint64_t)abs;
+    double scaled = (abs - (double)integer) * (double)_pow10[fmt.precision];
+    uint64_t fraction = (uint64_t)scaled;
+    double rest = scaled - (double)fraction;
+    if (roundUp(fmt.rounding, fmt.precision ? fraction : integer, rest > 0.5, rest == 0.5)) {
+      if (++fraction >= _pow10[fmt.precision]) {
+        fraction = 0;
+        integer++;
+      };
     };
-  } while (val != 0L);
+    pos = decimalWrite(pos, negative, integer, fraction, &fmt);
+  } else {
+    // Exponential notation: mantissa 1...9.99 with the same precision
+    int exponent = (int)floor(log10(abs));
+    double mantissa = abs / pow(10.0, exponent);
+    if (mantissa >= 10.0) {
+      mantissa /= 10.0;
+      exponent++;
+    } else if (mantissa < 1.0) {
+      mantissa *= 10.0;
+      exponent--;
+    };
+    double scaled = mantissa * (double)_pow10[fmt.precision];
+    uint64_t digits = (uint64_t)scaled;
+    double rest = scaled - (double)digits;
+    if (roundUp(fmt.rounding, digits, rest > 0.5, rest == 0.5)) digits++;
+    if (digits >= 10 * _pow10[fmt.precision]) {
+      digits /= 10;
+      exponent++;
+    };
+    pos = decimalWrite(pos, negative, digits / _pow10[fmt.precision], digits % _pow10[fmt.precision], &fmt);
+    *pos++ = 'e';
+    *pos++ = exponent < 0 ? '-' : '+';
+    unsigned int exp = exponent < 0 ? -exponent : exponent;
+    if (exp < 10) *pos++ = '0';
+    pos += decToStr(exp, pos);
+  };
+  return decimalCopy(temp, pos - temp, buffer, buffer_size);
+}
 
-  *pos-- = '\0';
+size_t double_to_str(double value, uint8_t precision, char* buffer, size_t buffer_size)
+{
+  rs_decimal_format_t format = _decimalDefault;
+  format.precision = precision;
+  return double_to_str_ex(value, &format, buffer, buffer_size);
+}
 
-  while(pos1 < pos) {
-    tmp = *pos;
-    *pos--= *pos1;
-    *pos1++ = tmp;
+size_t fixed_to_str(int64_t value, uint8_t scale, const rs_decimal_format_t* format, char* buffer, size_t buffer_size)
+{
+  rs_decimal_format_t fmt = format ? *format : _decimalDefault;
+  if (format == nullptr) fmt.precision = scale;
+  if (scale > 18) scale = 18;
+  if (fmt.precision > RS_DECIMAL_MAX_PRECISION) fmt.precision = RS_DECIMAL_MAX_PRECISION;
+  char temp[RS_DECIMAL_BUFFER_SIZE];
+  bool negative = value < 0;
+  uint64_t abs = negative ? 0 - (uint64_t)value : (uint64_t)value;
+  uint64_t integer = abs / _pow10[scale];
+  uint64_t fraction = abs % _pow10[scale];
+  if (fmt.precision >= scale) {
+    // Extra digits are zeros
+    fraction *= _pow10[fmt.precision - scale];
+  } else {
+    // Dropped digits are rounded in integer arithmetic: exact
+    uint64_t unit = _pow10[scale - fmt.precision];
+    uint64_t rest = fraction % unit;
+    fraction /= unit;
+    if (roundUp(fmt.rounding, fmt.precision ? fraction : integer, rest > unit / 2, (unit > 1) && (rest * 2 == unit))) {
+      if (++fraction >= _pow10[fmt.precision]) {
+        fraction = 0;
+        integer++;
+      };
+    };
   };
+  char* pos = decimalWrite(temp, negative, integer, fraction, &fmt);
+  return decimalCopy(temp, pos - temp, buffer, buffer_size);
+}
 
-  return buffer;
+char* malloc_double(double value, uint8_t precision)
+{
+  char buffer[RS_DECIMAL_BUFFER_SIZE];
+  size_t len = double_to_str(value, precision, buffer, sizeof(buffer));
+  return len > 0 ? malloc_stringl(buffer, len) : nullptr;
 }
 
+char* malloc_fixed(int64_t value, uint8_t scale, uint8_t precision)
+{
+  char buffer[RS_DECIMAL_BUFFER_SIZE];
+  rs_decimal_format_t format = _decimalDefault;
+  format.precision = precision;
+  size_t len = fixed_to_str(value, scale, &format, buffer, sizeof(buffer));
+  return len > 0 ? malloc_stringl(buffer, len) : nullptr;
+}
+
+// -----------------------------------------------------------------------------------------------------------------------
+// -------------------------------------------------------- Time ---------------------------------------------------------
+// -----------------------------------------------------------------------------------------------------------------------
+
 size_t time2str(const char *format, time_t *value, char* buffer, size_t buffer_size)
 {
   if ((buffer == nullptr) || (value == nullptr) || (buffer_size == 0)) {
     return 0;
   };
-  memset(buffer, 0, buffer_size);
-  struct tm timeinfo;
-  localtime_r(value, &timeinfo);
-  return strftime(buffer, buffer_size, format, &timeinfo);
+  return time2str_cached(format, *value, buffer, buffer_size);
 }
 
 size_t time2str_empty(const char *format, time_t *value, char* buffer, size_t buffer_size)
@@ -204,75 +490,135 @@ size_t time2str_empty(const char *format, time_t *value, char* buffer, size_t bu
   if ((buffer == nullptr) || (value == nullptr) || (buffer_size == 0)) {
     return 0;
   };
-  memset(buffer, 0, buffer_size);
   if (*value > 0) {
-    struct tm timeinfo;
-    localtime_r(value, &timeinfo);
-    return strftime(buffer, buffer_size, format, &timeinfo);
+    return time2str_cached(format, *value, buffer, buffer_size);
   } else {
-    strcpy(buffer, CONFIG_FORMAT_EMPTY_DATETIME);
-    return strlen(CONFIG_FORMAT_EMPTY_DATETIME);
+    size_t len = strlen(CONFIG_FORMAT_EMPTY_DATETIME);
+    if (len >= buffer_size) {
+      buffer[0] = 0;
+      return 0;
+    };
+    memcpy(buffer, CONFIG_FORMAT_EMPTY_DATETIME, len + 1);
+    return len;
   };
 }
 
 char * malloc_timestr(const char *format, time_t value)
 {
-  struct tm timeinfo;
-  localtime_r(&value, &timeinfo);
   char buffer[CONFIG_FORMAT_STRFTIME_BUFFER_SIZE];
-  memset(buffer, 0, sizeof(buffer));
-  strftime(buffer, sizeof(buffer), format, &timeinfo);
+  time2str_cached(format, value, buffer, sizeof(buffer));
   return malloc_string(buffer);
 }
 
 char * malloc_timestr_empty(const char *format, time_t value)
 {
   if (value > 0) {
-    struct tm timeinfo;
-    localtime_r(&value, &timeinfo);
-    char buffer[CONFIG_FORMAT_STRFTIME_BUFFER_SIZE];
-    memset(buffer, 0, sizeof(buffer));
-    strftime(buffer, sizeof(buffer), format, &timeinfo);
-    return malloc_string(buffer);
+    return malloc_timestr(format, value);
   } else {
     return malloc_string(CONFIG_FORMAT_EMPTY_DATETIME);
   }
 }
 
-char * malloc_timespan_hms(time_t value)
+static inline char* write2(char* pos, uint32_t value)
 {
-  uint16_t h = value / 3600;
-  uint16_t m = value % 3600 / 60;
-  uint16_t s = value % 3600 % 60;
-
-  return malloc_stringf("%.2d:%.2d:%.2d", h, m, s);
+  memcpy(pos, &_digits2[value * 2], 2);
+  return pos + 2;
 }
 
-char * malloc_timespan_dhms(time_t value)
+// Two units of the compact style: "1d 2h", "5m", "1s 250ms"
+static char* timespanCompact(char* pos, uint64_t seconds, uint32_t fraction, rs_timespan_unit_t unit)
 {
-  uint16_t d = value / 86400;
-  uint16_t h = value % 86400 / 3600;
-  uint16_t m = value % 86400 % 3600 / 60;
-  uint16_t s = value % 86400 % 3600 % 60;
-
-  return malloc_stringf("%d.%.2d:%.2d:%.2d", d, h, m, s);
+  static const char* const names[] = { "d", "h", "m", "s", "ms", "us" };
+  uint64_t parts[6] = { seconds / 86400, seconds % 86400 / 3600, seconds % 3600 / 60, seconds % 60, 0, 0 };
+  uint8_t count = 4;
+  if (unit == RS_TIMESPAN_MILLISECONDS) {
+    parts[count++] = fraction;
+  } else if (unit == RS_TIMESPAN_MICROSECONDS) {
+    parts[count++] = fraction / 1000;
+    parts[count++] = fraction % 1000;
+  };
+  uint8_t first = 0;
+  while ((first < count - 1) && (parts[first] == 0)) first++;
+  // Zero is always shown in seconds
+  if (parts[first] == 0) first = 3;
+  pos += decToStr(parts[first], pos);
+  pos = (char*)memcpy(pos, names[first], strlen(names[first])) + strlen(names[first]);
+  if ((first + 1 < count) && (parts[first + 1] > 0)) {
+    *pos++ = ' ';
+    pos += decToStr(parts[first + 1], pos);
+    pos = (char*)memcpy(pos, names[first + 1], strlen(names[first + 1])) + strlen(names[first + 1]);
+  };
+  return pos;
 }
 
-char * concat_strings(char * part1, char * part2)
+size_t timespan_to_str(int64_t value, rs_timespan_unit_t unit, rs_timespan_style_t style, char* buffer, size_t buffer_size)
 {
-  char * ret = nullptr;
-  if (part1) {
-    if (part2) {
-      ret = malloc_stringf("%s%s", part1, part2);
-      free(part1);
-      free(part2);
+  char temp[RS_TIMESPAN_BUFFER_SIZE];
+  char* pos = temp;
+  // The magnitude is computed in unsigned arithmetic, so INT64_MIN is handled too
+  uint64_t magnitude = value < 0 ? 0 - (uint64_t)value : (uint64_t)value;
+  if (value < 0) *pos++ = '-';
+  uint64_t seconds = magnitude;
+  uint32_t fraction = 0;
+  uint8_t fraction_digits = 0;
+  if (unit == RS_TIMESPAN_MILLISECONDS) {
+    seconds = magnitude / 1000;
+    fraction = (uint32_t)(magnitude % 1000);
+    fraction_digits = 3;
+  } else if (unit == RS_TIMESPAN_MICROSECONDS) {
+    seconds = magnitude / 1000000;
+    fraction = (uint32_t)(magnitude % 1000000);
+    fraction_digits = 6;
+  };
+
+  if (style == RS_TIMESPAN_COMPACT) {
+    pos = timespanCompact(pos, seconds, fraction, unit);
+  } else {
+    uint64_t hours = seconds / 3600;
+    if (style == RS_TIMESPAN_DHMS) {
+      pos += decToStr(seconds / 86400, pos);
+      *pos++ = '.';
+      hours %= 24;
+    };
+    if (hours < 100) {
+      pos = write2(pos, (uint32_t)hours);
     } else {
-      ret = part1;
+      pos += decToStr(hours, pos);
+    };
+    uint32_t rest = (uint32_t)(seconds % 3600);
+    *pos++ = ':';
+    pos = write2(pos, rest / 60);
+    *pos++ = ':';
+    pos = write2(pos, rest % 60);
+    if (fraction_digits > 0) {
+      *pos++ = '.';
+      decWrite32(fraction, pos, fraction_digits);
+      pos += fraction_digits;
     };
-  } else {
-    ret = part2;
   };
-  return ret;
+  return decimalCopy(temp, pos - temp, buffer, buffer_size);
+}
+
+char * malloc_timespan(int64_t value, rs_timespan_unit_t unit, rs_timespan_style_t style)
+{
+  char buffer[RS_TIMESPAN_BUFFER_SIZE];
+  size_t len = timespan_to_str(value, unit, style, buffer, sizeof(buffer));
+  return malloc_stringl(buffer, len);
+}
+
+char * malloc_timespan_hms(time_t value)
+{
+  return malloc_timespan(value, RS_TIMESPAN_SECONDS, RS_TIMESPAN_HMS);
+}
+
+char * malloc_timespan_dhms(time_t value)
+{
+  return malloc_timespan(value, RS_TIMESPAN_SECONDS, RS_TIMESPAN_DHMS);
+}
+
+char * concat_strings(char * part1, char * part2)
+{
+  return concat_strings_div(part1, part2, nullptr);
 }
 
 char * concat_strings_div(char * part1, char * part2, const char* divider)
@@ -280,9 +626,14 @@ char * concat_strings_div(char * part1, char * part2, const char* divider)
   char * ret = nullptr;
   if (part1) {
     if (part2) {
-      ret = malloc_stringf("%s%s%s", part1, divider, part2);
-      free(part1);
-      free(part2);
+      // part1 is extended in place: a chain of calls grows one block geometrically
+      rs_builder_t builder;
+      rs_builder_adopt(&builder, part1);
+      rs_builder_reserve(&builder, (divider ? strlen(divider) : 0) + strlen(part2));
+      rs_builder_append(&builder, divider);
+      rs_builder_append(&builder, part2);
+      rs_free(part2);
+      ret = rs_builder_detach(&builder);
     } else {
       ret = part1;
     };
@@ -301,559 +652,185 @@ char * mqttGetSubTopic(const char *topic, const char *subtopic)
   return malloc_stringf("%s/%s", topic, subtopic);
 }
 
-// 
-// MQTT1 LOCAL
-// 
-#if defined(CONFIG_MQTT1_LOC_PREFIX)
-  // PREFIX + ...
-  #if defined(CONFIG_MQTT1_LOC_LOCATION)
-    // PREFIX + LOCATION + ...
-    #define MQTT1_LOC_HEADER_LOCATION CONFIG_MQTT1_LOC_PREFIX CONFIG_MQTT1_LOC_LOCATION "/"
-    #if defined(CONFIG_MQTT1_LOC_DEVICE)
-      // PREFIX + LOCATION + "/" + DEVICE + "/"
-      #define MQTT1_LOC_HEADER_DEVICE CONFIG_MQTT1_LOC_PREFIX CONFIG_MQTT1_LOC_LOCATION "/" CONFIG_MQTT1_LOC_DEVICE "/"
-    #else
-      // PREFIX + LOCATION + "/"
-      #define MQTT1_LOC_HEADER_DEVICE CONFIG_MQTT1_LOC_PREFIX CONFIG_MQTT1_LOC_LOCATION
-    #endif // defined(CONFIG_MQTT1_LOC_DEVICE)
-  #else
-    // PREFIX + ...
-    #define MQTT1_LOC_HEADER_LOCATION CONFIG_MQTT1_LOC_PREFIX
-    #if defined(CONFIG_MQTT1_LOC_DEVICE)
-      // PREFIX + DEVICE
-      #define MQTT1_LOC_HEADER_DEVICE CONFIG_MQTT1_LOC_PREFIX CONFIG_MQTT1_LOC_DEVICE "/"
-    #else
-      // PREFIX
-      #define MQTT1_LOC_HEADER_DEVICE CONFIG_MQTT1_LOC_PREFIX
-    #endif // defined(CONFIG_MQTT1_LOC_DEVICE)
-  #endif // defined(CONFIG_MQTT1_LOC_LOCATION)
-#else
-  // ...
-  #if defined(CONFIG_MQTT1_LOC_LOCATION)
-    // LOCATION + ...
-    #define MQTT1_LOC_HEADER_LOCATION CONFIG_MQTT1_LOC_LOCATION "/"
-    #if defined(CONFIG_MQTT1_LOC_DEVICE)
-      // LOCATION + "/" + DEVICE
-      #define MQTT1_LOC_HEADER_DEVICE CONFIG_MQTT1_LOC_LOCATION "/" CONFIG_MQTT1_LOC_DEVICE "/"
-    #else
-      // LOCATION
-      #define MQTT1_LOC_HEADER_DEVICE CONFIG_MQTT1_LOC_LOCATION "/"
-    #endif // defined(CONFIG_MQTT1_LOC_DEVICE)
-  #else
-    // ...
-    #define MQTT1_LOC_HEADER_LOCATION ""
-    #if defined(CONFIG_MQTT1_LOC_DEVICE)
-      // DEVICE
-      #define MQTT1_LOC_HEADER_DEVICE CONFIG_MQTT1_LOC_DEVICE "/"
-    #else
-      // EMPTY
-      #define MQTT1_LOC_HEADER_DEVICE ""
-    #endif // defined(CONFIG_MQTT1_LOC_DEVICE)
-  #endif // defined(CONFIG_MQTT1_LOC_LOCATION)
-#endif // defined(CONFIG_MQTT1_LOC_PREFIX)
-
-// 
-// MQTT2 LOCAL
-// 
-#if defined(CONFIG_MQTT2_LOC_PREFIX)
-  // PREFIX + ...
-  #if defined(CONFIG_MQTT2_LOC_LOCATION)
-    // PREFIX + LOCATION + ...
-    #define MQTT2_LOC_HEADER_LOCATION CONFIG_MQTT2_LOC_PREFIX CONFIG_MQTT2_LOC_LOCATION "/"
-    #if defined(CONFIG_MQTT2_LOC_DEVICE)
-      // PREFIX + LOCATION + "/" + DEVICE + "/"
-      #define MQTT2_LOC_HEADER_DEVICE CONFIG_MQTT2_LOC_PREFIX CONFIG_MQTT2_LOC_LOCATION "/" CONFIG_MQTT2_LOC_DEVICE "/"
-    #else
-      // PREFIX + LOCATION + "/"
-      #define MQTT2_LOC_HEADER_DEVICE CONFIG_MQTT2_LOC_PREFIX CONFIG_MQTT2_LOC_LOCATION
-    #endif // defined(CONFIG_MQTT2_LOC_DEVICE)
-  #else
-    // PREFIX + ...
-    #define MQTT2_LOC_HEADER_LOCATION CONFIG_MQTT2_LOC_PREFIX
-    #if defined(CONFIG_MQTT2_LOC_DEVICE)
-      // PREFIX + DEVICE
-      #define MQTT2_LOC_HEADER_DEVICE CONFIG_MQTT2_LOC_PREFIX CONFIG_MQTT2_LOC_DEVICE "/"
-    #else
-      // PREFIX
-      #define MQTT2_LOC_HEADER_DEVICE CONFIG_MQTT2_LOC_PREFIX
-    #endif // defined(CONFIG_MQTT2_LOC_DEVICE)
-  #endif // defined(CONFIG_MQTT2_LOC_LOCATION)
-#else
-  // ...
-  #if defined(CONFIG_MQTT2_LOC_LOCATION)
-    // LOCATION + ...
-    #define MQTT2_LOC_HEADER_LOCATION CONFIG_MQTT2_LOC_LOCATION "/"
-    #if defined(CONFIG_MQTT2_LOC_DEVICE)
-      // LOCATION + "/" + DEVICE
-      #define MQTT2_LOC_HEADER_DEVICE CONFIG_MQTT2_LOC_LOCATION "/" CONFIG_MQTT2_LOC_DEVICE "/"
-    #else
-      // LOCATION
-      #define MQTT2_LOC_HEADER_DEVICE CONFIG_MQTT2_LOC_LOCATION "/"
-    #endif // defined(CONFIG_MQTT2_LOC_DEVICE)
-  #else
-    // ...
-    #define MQTT2_LOC_HEADER_LOCATION ""
-    #if defined(CONFIG_MQTT2_LOC_DEVICE)
-      // DEVICE
-      #define MQTT2_LOC_HEADER_DEVICE CONFIG_MQTT2_LOC_DEVICE "/"
-    #else
-      // EMPTY
-      #define MQTT2_LOC_HEADER_DEVICE ""
-    #endif // defined(CONFIG_MQTT2_LOC_DEVICE)
-  #endif // defined(CONFIG_MQTT2_LOC_LOCATION)
-#endif // defined(CONFIG_MQTT2_LOC_PREFIX)
-
-// 
-// MQTT1 PUBLIC
-// 
-#if defined(CONFIG_MQTT1_PUB_PREFIX)
-  // PREFIX + ...
-  #if defined(CONFIG_MQTT1_PUB_LOCATION)
-    // PREFIX + LOCATION + ...
-    #define MQTT1_PUB_HEADER_LOCATION CONFIG_MQTT1_PUB_PREFIX CONFIG_MQTT1_PUB_LOCATION "/"
-    #if defined(CONFIG_MQTT1_PUB_DEVICE)
-      // PREFIX + LOCATION + "/" + DEVICE + "/"
-      #define MQTT1_PUB_HEADER_DEVICE CONFIG_MQTT1_PUB_PREFIX CONFIG_MQTT1_PUB_LOCATION "/" CONFIG_MQTT1_PUB_DEVICE "/"
-    #else
-      // PREFIX + LOCATION + "/"
-      #define MQTT1_PUB_HEADER_DEVICE CONFIG_MQTT1_PUB_PREFIX CONFIG_MQTT1_PUB_LOCATION
-    #endif // defined(CONFIG_MQTT1_PUB_DEVICE)
-  #else
-    // PREFIX + ...
-    #define MQTT1_PUB_HEADER_LOCATION CONFIG_MQTT1_PUB_PREFIX
-    #if defined(CONFIG_MQTT1_PUB_DEVICE)
-      // PREFIX + DEVICE
-      #define MQTT1_PUB_HEADER_DEVICE CONFIG_MQTT1_PUB_PREFIX CONFIG_MQTT1_PUB_DEVICE "/"
-    #else
-      // PREFIX
-      #define MQTT1_PUB_HEADER_DEVICE CONFIG_MQTT1_PUB_PREFIX
-    #endif // defined(CONFIG_MQTT1_PUB_DEVICE)
-  #endif // defined(CONFIG_MQTT1_PUB_LOCATION)
-#else
-  // ...
-  #if defined(CONFIG_MQTT1_PUB_LOCATION)
-    // LOCATION + ...
-    #define MQTT1_PUB_HEADER_LOCATION CONFIG_MQTT1_PUB_LOCATION "/"
-    #if defined(CONFIG_MQTT1_PUB_DEVICE)
-      // LOCATION + "/" + DEVICE
-      #define MQTT1_PUB_HEADER_DEVICE CONFIG_MQTT1_PUB_LOCATION "/" CONFIG_MQTT1_PUB_DEVICE "/"
-    #else
-      // LOCATION
-      #define MQTT1_PUB_HEADER_DEVICE CONFIG_MQTT1_PUB_LOCATION "/"
-    #endif // defined(CONFIG_MQTT1_PUB_DEVICE)
-  #else
-    // ...
-    #define MQTT1_PUB_HEADER_LOCATION ""
-    #if defined(CONFIG_MQTT1_PUB_DEVICE)
-      // DEVICE
-      #define MQTT1_PUB_HEADER_DEVICE CONFIG_MQTT1_PUB_DEVICE "/"
-    #else
-      // EMPTY
-      #define MQTT1_PUB_HEADER_DEVICE ""
-    #endif // defined(CONFIG_MQTT1_PUB_DEVICE)
-  #endif // defined(CONFIG_MQTT1_PUB_LOCATION)
-#endif // defined(CONFIG_MQTT1_PUB_PREFIX)
-
-// 
-// MQTT2 PUBLIC
-// 
-#if defined(CONFIG_MQTT2_PUB_PREFIX)
-  // PREFIX + ...
-  #if defined(CONFIG_MQTT2_PUB_LOCATION)
-    // PREFIX + LOCATION + ...
-    #define MQTT2_PUB_HEADER_LOCATION CONFIG_MQTT2_PUB_PREFIX CONFIG_MQTT2_PUB_LOCATION "/"
-    #if defined(CONFIG_MQTT2_PUB_DEVICE)
-      // PREFIX + LOCATION + "/" + DEVICE + "/"
-      #define MQTT2_PUB_HEADER_DEVICE CONFIG_MQTT2_PUB_PREFIX CONFIG_MQTT2_PUB_LOCATION "/" CONFIG_MQTT2_PUB_DEVICE "/"
-    #else
-      // PREFIX + LOCATION + "/"
-      #define MQTT2_PUB_HEADER_DEVICE CONFIG_MQTT2_PUB_PREFIX CONFIG_MQTT2_PUB_LOCATION
-    #endif // defined(CONFIG_MQTT2_PUB_DEVICE)
-  #else
-    // PREFIX + ...
-    #define MQTT2_PUB_HEADER_LOCATION CONFIG_MQTT2_PUB_PREFIX
-    #if defined(CONFIG_MQTT2_PUB_DEVICE)
-      // PREFIX + DEVICE
-      #define MQTT2_PUB_HEADER_DEVICE CONFIG_MQTT2_PUB_PREFIX CONFIG_MQTT2_PUB_DEVICE "/"
-    #else
-      // PREFIX
-      #define MQTT2_PUB_HEADER_DEVICE CONFIG_MQTT2_PUB_PREFIX
-    #endif // defined(CONFIG_MQTT2_PUB_DEVICE)
-  #endif // defined(CONFIG_MQTT2_PUB_LOCATION)
-#else
-  // ...
-  #if defined(CONFIG_MQTT2_PUB_LOCATION)
-    // LOCATION + ...
-    #define MQTT2_PUB_HEADER_LOCATION CONFIG_MQTT2_PUB_LOCATION "/"
-    #if defined(CONFIG_MQTT2_PUB_DEVICE)
-      // LOCATION + "/" + DEVICE
-      #define MQTT2_PUB_HEADER_DEVICE CONFIG_MQTT2_PUB_LOCATION "/" CONFIG_MQTT2_PUB_DEVICE "/"
-    #else
-      // LOCATION
-      #define MQTT2_PUB_HEADER_DEVICE CONFIG_MQTT2_PUB_LOCATION "/"
-    #endif // defined(CONFIG_MQTT2_PUB_DEVICE)
-  #else
-    // ...
-    #define MQTT2_PUB_HEADER_LOCATION ""
-    #if defined(CONFIG_MQTT2_PUB_DEVICE)
-      // DEVICE
-      #define MQTT2_PUB_HEADER_DEVICE CONFIG_MQTT2_PUB_DEVICE "/"
-    #else
-      // EMPTY
-      #define MQTT2_PUB_HEADER_DEVICE ""
-    #endif // defined(CONFIG_MQTT2_PUB_DEVICE)
-  #endif // defined(CONFIG_MQTT2_PUB_LOCATION)
-#endif // defined(CONFIG_MQTT2_PUB_PREFIX)
-
-// Generation of a name of a topic: prefix + location + / + topic 
-char * mqttGetTopicLocation1(const bool primary, const bool local, const char *topic)
+// Length of header + [special + /] + segments joined by "/", NULL items are skipped
+size_t topicLength(const topic_header_t* header, const char *special, const char * const *segments, const uint8_t count)
 {
-  if (local) {
-    if (primary) {
-      return malloc_stringf("%s%s", MQTT1_LOC_HEADER_LOCATION, topic);
-    } else {
-      return malloc_stringf("%s%s", MQTT2_LOC_HEADER_LOCATION, topic);
-    };
-  } else {
-    if (primary) {
-      return malloc_stringf("%s%s", MQTT1_PUB_HEADER_LOCATION, topic);
-    } else {
-      return malloc_stringf("%s%s", MQTT2_PUB_HEADER_LOCATION, topic);
+  size_t len = 0;
+  uint8_t items = 0;
+  if (special) {
+    len += strlen(special);
+    items++;
+  };
+  for (uint8_t i = 0; i < count; i++) {
+    if (segments[i]) {
+      len += strlen(segments[i]);
+      items++;
     };
   };
+  return header->len + (items > 0 ? len + items - 1 : 0);
 }
 
-char * mqttGetTopicLocation2(const bool primary, const bool local, const char *topic1, const char *topic2)
+// Writes the topic with a terminating zero, the buffer must hold topicLength() + 1 bytes
+void topicWrite(char *pos, const topic_header_t* header, const char *special, const char * const *segments, const uint8_t count)
 {
-  if (local) {
-    if (primary) {
-      return malloc_stringf("%s%s/%s", MQTT1_LOC_HEADER_LOCATION, topic1, topic2);
-    } else {
-      return malloc_stringf("%s%s/%s", MQTT2_LOC_HEADER_LOCATION, topic1, topic2);
-    };
-  } else {
-    if (primary) {
-      return malloc_stringf("%s%s/%s", MQTT1_PUB_HEADER_LOCATION, topic1, topic2);
-    } else {
-      return malloc_stringf("%s%s/%s", MQTT2_PUB_HEADER_LOCATION, topic1, topic2);
+  bool first = true;
+  memcpy(pos, header->text, header->len);
+  pos += header->len;
+  if (special) {
+    size_t len = strlen(special);
+    memcpy(pos, special, len);
+    pos += len;
+    first = false;
+  };
+  for (uint8_t i = 0; i < count; i++) {
+    if (segments[i]) {
+      if (!first) *pos++ = '/';
+      size_t len = strlen(segments[i]);
+      memcpy(pos, segments[i], len);
+      pos += len;
+      first = false;
     };
   };
+  *pos = '\0';
 }
 
-char * mqttGetTopicLocation3(const bool primary, const bool local, const char *topic1, const char *topic2, const char *topic3)
+char * mqttGetTopic(const bool primary, const bool local, const mqtt_header_t kind, const char *special, const char * const *segments, const uint8_t count)
 {
-  if (local) {
-    if (primary) {
-      return malloc_stringf("%s%s/%s/%s", MQTT1_LOC_HEADER_LOCATION, topic1, topic2, topic3);
-    } else {
-      return malloc_stringf("%s%s/%s/%s", MQTT2_LOC_HEADER_LOCATION, topic1, topic2, topic3);
-    };
-  } else {
-    if (primary) {
-      return malloc_stringf("%s%s/%s/%s", MQTT1_PUB_HEADER_LOCATION, topic1, topic2, topic3);
-    } else {
-      return malloc_stringf("%s%s/%s/%s", MQTT2_PUB_HEADER_LOCATION, topic1, topic2, topic3);
-    };
+  if ((segments == nullptr) && (count > 0)) return nullptr;
+  const topic_headers_t* headers = topicHeadersAcquire();
+  const topic_header_t* header = &headers->items[topicHeaderIndex(primary, local, kind)];
+  size_t len = topicLength(header, special, segments, count);
+  char *ret = (char*)rs_malloc(len+1);
+  if (ret) {
+    topicWrite(ret, header, special, segments, count);
+  };
+  topicHeadersRelease(headers);
+  if (ret == nullptr) {
+    rlog_e(tagHEAP, "Failed to create topic: out of memory!");
   };
+  return ret;
+}
+
+size_t mqttFormatTopic(const bool primary, const bool local, const mqtt_header_t kind, const char *special, const char * const *segments, const uint8_t count, 
+  char *buffer, size_t buffer_size)
+{
+  if ((buffer == nullptr) || (buffer_size == 0)) return 0;
+  buffer[0] = '\0';
+  if ((segments == nullptr) && (count > 0)) return 0;
+  const topic_headers_t* headers = topicHeadersAcquire();
+  const topic_header_t* header = &headers->items[topicHeaderIndex(primary, local, kind)];
+  size_t len = topicLength(header, special, segments, count);
+  bool fits = len+1 <= buffer_size;
+  if (fits) {
+    topicWrite(buffer, header, special, segments, count);
+  };
+  topicHeadersRelease(headers);
+  if (!fits) {
+    rlog_e(tagFMTS, "Buffer %d bytes too small to hold topic, %d bytes needed", (int)buffer_size, (int)(len+1));
+    return 0;
+  };
+  return len;
+}
+
+// Generation of a name of a topic: prefix + location + / + topic 
+char * mqttGetTopicLocation1(const bool primary, const bool local, const char *topic)
+{
+  const char* segments[] = { topic };
+  return mqttGetTopic(primary, local, MQTT_HEADER_LOCATION, nullptr, segments, 1);
+}
+
+char * mqttGetTopicLocation2(const bool primary, const bool local, const char *topic1, const char *topic2)
+{
+  const char* segments[] = { topic1, topic2 };
+  return mqttGetTopic(primary, local, MQTT_HEADER_LOCATION, nullptr, segments, 2);
+}
+
+char * mqttGetTopicLocation3(const bool primary, const bool local, const char *topic1, const char *topic2, const char *topic3)
+{
+  const char* segments[] = { topic1, topic2, topic3 };
+  return mqttGetTopic(primary, local, MQTT_HEADER_LOCATION, nullptr, segments, 3);
 }
 
 char * mqttGetTopicLocation(const bool primary, const bool local, const char *topic1, const char *topic2, const char *topic3)
 {
-  if (topic3) {
-    return mqttGetTopicLocation3(primary, local, topic1, topic2, topic3);
-  }
-  else if (topic2) {
-    return mqttGetTopicLocation2(primary, local, topic1, topic2);
-  }
-  else if (topic1) {
-    return mqttGetTopicLocation1(primary, local, topic1);
-  }
-  else {
-    return nullptr;
-  }
+  if (topic1 == nullptr) return nullptr;
+  const char* segments[] = { topic1, topic2, topic3 };
+  return mqttGetTopic(primary, local, MQTT_HEADER_LOCATION, nullptr, segments, topic3 ? 3 : (topic2 ? 2 : 1));
 }
 
 // Generation of a name of a topic: prefix + location + / + special + / + topic 
 char * mqttGetTopicSpecial1(const bool primary, const bool local, const char *special, const char *topic)
 {
-  if (special) {
-    if (local) {
-      if (primary) {
-        return malloc_stringf("%s%s/%s", MQTT1_LOC_HEADER_LOCATION, special, topic);
-      } else {
-        return malloc_stringf("%s%s/%s", MQTT2_LOC_HEADER_LOCATION, special, topic);
-      };
-    } else {
-      if (primary) {
-        return malloc_stringf("%s%s/%s", MQTT1_PUB_HEADER_LOCATION, special, topic);
-      } else {
-        return malloc_stringf("%s%s/%s", MQTT2_PUB_HEADER_LOCATION, special, topic);
-      };
-    };
-  } else {
-    if (local) {
-      if (primary) {
-        return malloc_stringf("%s%s", MQTT1_LOC_HEADER_LOCATION, topic);
-      } else {
-        return malloc_stringf("%s%s", MQTT2_LOC_HEADER_LOCATION, topic);
-      };
-    } else {
-      if (primary) {
-        return malloc_stringf("%s%s", MQTT1_PUB_HEADER_LOCATION, topic);
-      } else {
-        return malloc_stringf("%s%s", MQTT2_PUB_HEADER_LOCATION, topic);
-      };
-    };
-  };
+  const char* segments[] = { topic };
+  return mqttGetTopic(primary, local, MQTT_HEADER_LOCATION, special, segments, 1);
 }
 
 char * mqttGetTopicSpecial2(const bool primary, const bool local, const char *special, const char *topic1, const char *topic2)
 {
-  if (special) {
-    if (local) {
-      if (primary) {
-        return malloc_stringf("%s%s/%s/%s", MQTT1_LOC_HEADER_LOCATION, special, topic1, topic2);
-      } else {
-        return malloc_stringf("%s%s/%s/%s", MQTT2_LOC_HEADER_LOCATION, special, topic1, topic2);
-      };
-    } else {
-      if (primary) {
-        return malloc_stringf("%s%s/%s/%s", MQTT1_PUB_HEADER_LOCATION, special, topic1, topic2);
-      } else {
-        return malloc_stringf("%s%s/%s/%s", MQTT2_PUB_HEADER_LOCATION, special, topic1, topic2);
-      };
-    };
-  } else {
-    if (local) {
-      if (primary) {
-        return malloc_stringf("%s%s/%s", MQTT1_LOC_HEADER_LOCATION, topic1, topic2);
-      } else {
-        return malloc_stringf("%s%s/%s", MQTT2_LOC_HEADER_LOCATION, topic1, topic2);
-      };
-    } else {
-      if (primary) {
-        return malloc_stringf("%s%s/%s", MQTT1_PUB_HEADER_LOCATION, topic1, topic2);
-      } else {
-        return malloc_stringf("%s%s/%s", MQTT2_PUB_HEADER_LOCATION, topic1, topic2);
-      };
-    };
-  };
+  const char* segments[] = { topic1, topic2 };
+  return mqttGetTopic(primary, local, MQTT_HEADER_LOCATION, special, segments, 2);
 }
 
 char * mqttGetTopicSpecial3(const bool primary, const bool local, const char *special, const char *topic1, const char *topic2, const char *topic3)
 {
-  if (special) {
-    if (local) {
-      if (primary) {
-        return malloc_stringf("%s%s/%s/%s/%s", MQTT1_LOC_HEADER_LOCATION, special, topic1, topic2, topic3);
-      } else {
-        return malloc_stringf("%s%s/%s/%s/%s", MQTT2_LOC_HEADER_LOCATION, special, topic1, topic2, topic3);
-      };
-    } else {
-      if (primary) {
-        return malloc_stringf("%s%s/%s/%s/%s", MQTT1_PUB_HEADER_LOCATION, special, topic1, topic2, topic3);
-      } else {
-        return malloc_stringf("%s%s/%s/%s/%s", MQTT2_PUB_HEADER_LOCATION, special, topic1, topic2, topic3);
-      };
-    };
-  } else {
-    if (local) {
-      if (primary) {
-        return malloc_stringf("%s%s/%s/%s", MQTT1_LOC_HEADER_LOCATION, topic1, topic2, topic3);
-      } else {
-        return malloc_stringf("%s%s/%s/%s", MQTT2_LOC_HEADER_LOCATION, topic1, topic2, topic3);
-      };
-    } else {
-      if (primary) {
-        return malloc_stringf("%s%s/%s/%s", MQTT1_PUB_HEADER_LOCATION, topic1, topic2, topic3);
-      } else {
-        return malloc_stringf("%s%s/%s/%s", MQTT2_PUB_HEADER_LOCATION, topic1, topic2, topic3);
-      };
-    };
-  };
+  const char* segments[] = { topic1, topic2, topic3 };
+  return mqttGetTopic(primary, local, MQTT_HEADER_LOCATION, special, segments, 3);
 }
 
 char * mqttGetTopicSpecial4(const bool primary, const bool local, const char *special, const char *topic1, const char *topic2, const char *topic3, const char *topic4)
 {
-  if (special) {
-    if (local) {
-      if (primary) {
-        return malloc_stringf("%s%s/%s/%s/%s/%s", MQTT1_LOC_HEADER_LOCATION, special, topic1, topic2, topic3, topic4);
-      } else {
-        return malloc_stringf("%s%s/%s/%s/%s/%s", MQTT2_LOC_HEADER_LOCATION, special, topic1, topic2, topic3, topic4);
-      };
-    } else {
-      if (primary) {
-        return malloc_stringf("%s%s/%s/%s/%s/%s", MQTT1_PUB_HEADER_LOCATION, special, topic1, topic2, topic3, topic4);
-      } else {
-        return malloc_stringf("%s%s/%s/%s/%s/%s", MQTT2_PUB_HEADER_LOCATION, special, topic1, topic2, topic3, topic4);
-      };
-    };
-  } else {
-    if (local) {
-      if (primary) {
-        return malloc_stringf("%s%s/%s/%s/%s", MQTT1_LOC_HEADER_LOCATION, topic1, topic2, topic3, topic4);
-      } else {
-        return malloc_stringf("%s%s/%s/%s/%s", MQTT2_LOC_HEADER_LOCATION, topic1, topic2, topic3, topic4);
-      };
-    } else {
-      if (primary) {
-        return malloc_stringf("%s%s/%s/%s/%s", MQTT1_PUB_HEADER_LOCATION, topic1, topic2, topic3, topic4);
-      } else {
-        return malloc_stringf("%s%s/%s/%s/%s", MQTT2_PUB_HEADER_LOCATION, topic1, topic2, topic3, topic4);
-      };
-    };
-  };
+  const char* segments[] = { topic1, topic2, topic3, topic4 };
+  return mqttGetTopic(primary, local, MQTT_HEADER_LOCATION, special, segments, 4);
 }
 
 char * mqttGetTopicSpecial5(const bool primary, const bool local, const char *special, const char *topic1, const char *topic2, const char *topic3, const char *topic4, const char *topic5)
 {
-  if (special) {
-    if (local) {
-      if (primary) {
-        return malloc_stringf("%s%s/%s/%s/%s/%s/%s", MQTT1_LOC_HEADER_LOCATION, special, topic1, topic2, topic3, topic4, topic5);
-      } else {
-        return malloc_stringf("%s%s/%s/%s/%s/%s/%s", MQTT2_LOC_HEADER_LOCATION, special, topic1, topic2, topic3, topic4, topic5);
-      };
-    } else {
-      if (primary) {
-        return malloc_stringf("%s%s/%s/%s/%s/%s/%s", MQTT1_PUB_HEADER_LOCATION, special, topic1, topic2, topic3, topic4, topic5);
-      } else {
-        return malloc_stringf("%s%s/%s/%s/%s/%s/%s", MQTT2_PUB_HEADER_LOCATION, special, topic1, topic2, topic3, topic4, topic5);
-      };
-    };
-  } else {
-    if (local) {
-      if (primary) {
-        return malloc_stringf("%s%s/%s/%s/%s/%s", MQTT1_LOC_HEADER_LOCATION, topic1, topic2, topic3, topic4, topic5);
-      } else {
-        return malloc_stringf("%s%s/%s/%s/%s/%s", MQTT2_LOC_HEADER_LOCATION, topic1, topic2, topic3, topic4, topic5);
-      };
-    } else {
-      if (primary) {
-        return malloc_stringf("%s%s/%s/%s/%s/%s", MQTT1_PUB_HEADER_LOCATION, topic1, topic2, topic3, topic4, topic5);
-      } else {
-        return malloc_stringf("%s%s/%s/%s/%s/%s", MQTT2_PUB_HEADER_LOCATION, topic1, topic2, topic3, topic4, topic5);
-      };
-    };
-  };
+  const char* segments[] = { topic1, topic2, topic3, topic4, topic5 };
+  return mqttGetTopic(primary, local, MQTT_HEADER_LOCATION, special, segments, 5);
 }
 
 char * mqttGetTopicSpecial(const bool primary, const bool local, const char *special, const char *topic1, const char *topic2, const char *topic3)
 {
-  if (topic3) {
-    return mqttGetTopicSpecial3(primary, local, special, topic1, topic2, topic3);
-  }
-  else if (topic2) {
-    return mqttGetTopicSpecial2(primary, local, special, topic1, topic2);
-  }
-  else if (topic1) {
-    return mqttGetTopicSpecial1(primary, local, special, topic1);
-  }
-  else {
-    return nullptr;
-  }
+  if (topic1 == nullptr) return nullptr;
+  const char* segments[] = { topic1, topic2, topic3 };
+  return mqttGetTopic(primary, local, MQTT_HEADER_LOCATION, special, segments, topic3 ? 3 : (topic2 ? 2 : 1));
 }
 
 // Generation of a name of a topic: prefix + location + / + device + / + topic 
 char * mqttGetTopicDevice1(const bool primary, const bool local, const char *topic)
 {
-  if (local) {
-    if (primary) {
-      return malloc_stringf("%s%s", MQTT1_LOC_HEADER_DEVICE, topic);
-    } else {
-      return malloc_stringf("%s%s", MQTT2_LOC_HEADER_DEVICE, topic);
-    };
-  } else {
-    if (primary) {
-      return malloc_stringf("%s%s", MQTT1_PUB_HEADER_DEVICE, topic);
-    } else {
-      return malloc_stringf("%s%s", MQTT2_PUB_HEADER_DEVICE, topic);
-    };
-  };
+  const char* segments[] = { topic };
+  return mqttGetTopic(primary, local, MQTT_HEADER_DEVICE, nullptr, segments, 1);
 }
 
 char * mqttGetTopicDevice2(const bool primary, const bool local, const char *topic1, const char *topic2)
 {
-  if (local) {
-    if (primary) {
-      return malloc_stringf("%s%s/%s", MQTT1_LOC_HEADER_DEVICE, topic1, topic2);
-    } else {
-      return malloc_stringf("%s%s/%s", MQTT2_LOC_HEADER_DEVICE, topic1, topic2);
-    };
-  } else {
-    if (primary) {
-      return malloc_stringf("%s%s/%s", MQTT1_PUB_HEADER_DEVICE, topic1, topic2);
-    } else {
-      return malloc_stringf("%s%s/%s", MQTT2_PUB_HEADER_DEVICE, topic1, topic2);
-    };
-  };
+  const char* segments[] = { topic1, topic2 };
+  return mqttGetTopic(primary, local, MQTT_HEADER_DEVICE, nullptr, segments, 2);
 }
 
 char * mqttGetTopicDevice3(const bool primary, const bool local, const char *topic1, const char *topic2, const char *topic3)
 {
-  if (local) {
-    if (primary) {
-      return malloc_stringf("%s%s/%s/%s", MQTT1_LOC_HEADER_DEVICE, topic1, topic2, topic3);
-    } else {
-      return malloc_stringf("%s%s/%s/%s", MQTT2_LOC_HEADER_DEVICE, topic1, topic2, topic3);
-    };
-  } else {
-    if (primary) {
-      return malloc_stringf("%s%s/%s/%s", MQTT1_PUB_HEADER_DEVICE, topic1, topic2, topic3);
-    } else {
-      return malloc_stringf("%s%s/%s/%s", MQTT2_PUB_HEADER_DEVICE, topic1, topic2, topic3);
-    };
-  };
+  const char* segments[] = { topic1, topic2, topic3 };
+  return mqttGetTopic(primary, local, MQTT_HEADER_DEVICE, nullptr, segments, 3);
 }
 
 char * mqttGetTopicDevice4(const bool primary, const bool local, const char *topic1, const char *topic2, const char *topic3, const char *topic4)
 {
-  if (local) {
-    if (primary) {
-      return malloc_stringf("%s%s/%s/%s/%s", MQTT1_LOC_HEADER_DEVICE, topic1, topic2, topic3, topic4);
-    } else {
-      return malloc_stringf("%s%s/%s/%s/%s", MQTT2_LOC_HEADER_DEVICE, topic1, topic2, topic3, topic4);
-    };
-  } else {
-    if (primary) {
-      return malloc_stringf("%s%s/%s/%s/%s", MQTT1_PUB_HEADER_DEVICE, topic1, topic2, topic3, topic4);
-    } else {
-      return malloc_stringf("%s%s/%s/%s/%s", MQTT2_PUB_HEADER_DEVICE, topic1, topic2, topic3, topic4);
-    };
-  };
+  const char* segments[] = { topic1, topic2, topic3, topic4 };
+  return mqttGetTopic(primary, local, MQTT_HEADER_DEVICE, nullptr, segments, 4);
 }
 
 char * mqttGetTopicDevice5(const bool primary, const bool local, const char *topic1, const char *topic2, const char *topic3, const char *topic4, const char *topic5)
 {
-  if (local) {
-    if (primary) {
-      return malloc_stringf("%s%s/%s/%s/%s/%s", MQTT1_LOC_HEADER_DEVICE, topic1, topic2, topic3, topic4, topic5);
-    } else {
-      return malloc_stringf("%s%s/%s/%s/%s/%s", MQTT2_LOC_HEADER_DEVICE, topic1, topic2, topic3, topic4, topic5);
-    };
-  } else {
-    if (primary) {
-      return malloc_stringf("%s%s/%s/%s/%s/%s", MQTT1_PUB_HEADER_DEVICE, topic1, topic2, topic3, topic4, topic5);
-    } else {
-      return malloc_stringf("%s%s/%s/%s/%s/%s", MQTT2_PUB_HEADER_DEVICE, topic1, topic2, topic3, topic4, topic5);
-    };
-  };
+  const char* segments[] = { topic1, topic2, topic3, topic4, topic5 };
+  return mqttGetTopic(primary, local, MQTT_HEADER_DEVICE, nullptr, segments, 5);
 }
 
 char * mqttGetTopicDevice(const bool primary, const bool local, const char *topic1, const char *topic2, const char *topic3)
 {
-  if (topic3) {
-    return mqttGetTopicDevice3(primary, local, topic1, topic2, topic3);
-  }
-  else if (topic2) {
-    return mqttGetTopicDevice2(primary, local, topic1, topic2);
-  }
-  else if (topic1) {
-    return mqttGetTopicDevice1(primary, local, topic1);
-  }
-  else {
-    return nullptr;
-  }
+  if (topic1 == nullptr) return nullptr;
+  const char* segments[] = { topic1, topic2, topic3 };
+  return mqttGetTopic(primary, local, MQTT_HEADER_DEVICE, nullptr, segments, topic3 ? 3 : (topic2 ? 2 : 1));
 }
 
@@ -0,0 +1,175 @@
+#include "rStringsAlloc.h"
+#include "rStringsPort.h"
+#include <stdlib.h>
+#include <string.h>
+#if defined(__has_include) && __has_include("reEsp32.h")
+  #include "reEsp32.h"
+  #define USE_ESP_MALLOC 1
+#else
+  #define USE_ESP_MALLOC 0
+#endif
+#if defined(ESP_PLATFORM)
+  #include "esp_heap_caps.h"
+#elif defined(__GLIBC__)
+  #include <malloc.h>
+#endif
+
+// -----------------------------------------------------------------------------------------------------------------------
+// ------------------------------------------------ Default allocator ----------------------------------------------------
+// -----------------------------------------------------------------------------------------------------------------------
+
+static void* def_alloc(void* ctx, size_t size)
+{
+  (void)ctx;
+  #if USE_ESP_MALLOC
+    return psram_malloc(size);
+  #else
+    return malloc(size);
+  #endif
+}
+
+static void* def_realloc(void* ctx, void* ptr, size_t size)
+{
+  (void)ctx;
+  #if USE_ESP_MALLOC
+    // Like psram_malloc: plain realloc() could move a PSRAM block into internal RAM,
+    // internal RAM is used only if PSRAM is missing or full
+    if (size > 0) {
+      void* ret = heap_caps_realloc(ptr, size, MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
+      if (ret) return ret;
+    };
+  #endif
+  return realloc(ptr, size);
+}
+
+static void def_free(void* ctx, void* ptr)
+{
+  (void)ctx;
+  free(ptr);
+}
+
+#if defined(ESP_PLATFORM)
+  static size_t def_size(void* ctx, const void* ptr)
+  {
+    (void)ctx;
+    return heap_caps_get_allocated_size((void*)ptr);
+  }
+  #define DEF_SIZE def_size
+#elif defined(__GLIBC__)
+  static size_t def_size(void* ctx, const void* ptr)
+  {
+    (void)ctx;
+    return malloc_usable_size((void*)ptr);
+  }
+  #define DEF_SIZE def_size
+#else
+  #define DEF_SIZE nullptr
+#endif
+
+static const rs_allocator_t _defAllocator = { def_alloc, def_realloc, def_free, DEF_SIZE, nullptr };
+static const rs_allocator_t* _allocator = &_defAllocator;
+
+void rs_set_allocator(const rs_allocator_t* allocator)
+{
+  RS_ATOMIC_STORE(&_allocator, allocator ? allocator : &_defAllocator);
+}
+
+const rs_allocator_t* rs_get_allocator(void)
+{
+  return RS_ATOMIC_LOAD(&_allocator);
+}
+
+const rs_allocator_t* rs_default_allocator(void)
+{
+  return &_defAllocator;
+}
+
+// -----------------------------------------------------------------------------------------------------------------------
+// --------------------------------------------------- Statistics --------------------------------------------------------
+// -----------------------------------------------------------------------------------------------------------------------
+
+static rs_alloc_stats_t _stats = { 0, 0, 0, 0, 0, 0 };
+
+static inline size_t blockSize(const rs_allocator_t* allocator, const void* ptr)
+{
+  return (ptr && allocator->size) ? allocator->size(allocator->ctx, ptr) : 0;
+}
+
+static inline void statsAcquired(size_t size)
+{
+  if (size > 0) {
+    size_t current = RS_ATOMIC_ADD(&_stats.current, size);
+    RS_ATOMIC_MAX(&_stats.peak, current);
+  };
+}
+
+void rs_get_alloc_stats(rs_alloc_stats_t* stats)
+{
+  if (stats) {
+    stats->calls = RS_ATOMIC_LOAD(&_stats.calls);
+    stats->frees = RS_ATOMIC_LOAD(&_stats.frees);
+    stats->bytes = RS_ATOMIC_LOAD(&_stats.bytes);
+    stats->current = RS_ATOMIC_LOAD(&_stats.current);
+    stats->peak = RS_ATOMIC_LOAD(&_stats.peak);
+    stats->failures = RS_ATOMIC_LOAD(&_stats.failures);
+  };
+}
+
+void rs_reset_alloc_stats(void)
+{
+  RS_ATOMIC_STORE(&_stats.calls, (uint64_t)0);
+  RS_ATOMIC_STORE(&_stats.frees, (uint64_t)0);
+  RS_ATOMIC_STORE(&_stats.bytes, (uint64_t)0);
+  RS_ATOMIC_STORE(&_stats.failures, (uint32_t)0);
+  RS_ATOMIC_STORE(&_stats.peak, RS_ATOMIC_LOAD(&_stats.current));
+}
+
+// -----------------------------------------------------------------------------------------------------------------------
+// ----------------------------------------------- Memory management -----------------------------------------------------
+// -----------------------------------------------------------------------------------------------------------------------
+
+void* rs_malloc(size_t size)
+{
+  const rs_allocator_t* allocator = RS_ATOMIC_LOAD(&_allocator);
+  RS_ATOMIC_ADD(&_stats.calls, (uint64_t)1);
+  RS_ATOMIC_ADD(&_stats.bytes, (uint64_t)size);
+  void* ret = allocator->alloc(allocator->ctx, size);
+  if (ret) {
+    statsAcquired(blockSize(allocator, ret));
+  } else {
+    RS_ATOMIC_ADD(&_stats.failures, (uint32_t)1);
+  };
+  return ret;
+}
+
+void* rs_realloc(void* ptr, size_t size)
+{
+  const rs_allocator_t* allocator = RS_ATOMIC_LOAD(&_allocator);
+  RS_ATOMIC_ADD(&_stats.calls, (uint64_t)1);
+  RS_ATOMIC_ADD(&_stats.bytes, (uint64_t)size);
+  size_t prev = blockSize(allocator, ptr);
+  void* ret = allocator->realloc(allocator->ctx, ptr, size);
+  if (ret) {
+    if (prev > 0) RS_ATOMIC_SUB(&_stats.current, prev);
+    statsAcquired(blockSize(allocator, ret));
+  } else {
+    RS_ATOMIC_ADD(&_stats.failures, (uint32_t)1);
+  };
+  return ret;
+}
+
+void rs_free(void* ptr)
+{
+  if (ptr) {
+    const rs_allocator_t* allocator = RS_ATOMIC_LOAD(&_allocator);
+    size_t size = blockSize(allocator, ptr);
+    if (size > 0) RS_ATOMIC_SUB(&_stats.current, size);
+    RS_ATOMIC_ADD(&_stats.frees, (uint64_t)1);
+    allocator->free(allocator->ctx, ptr);
+  };
+}
+
+size_t rs_usable_size(const void* ptr)
+{
+  return blockSize(RS_ATOMIC_LOAD(&_allocator), ptr);
+}
@@ -0,0 +1,266 @@
+#include "rStringsArena.h"
+#include "rStrings.h"
+#include "rStringsTopicHeaders.h"
+#include "rLog.h"
+#include <stdio.h>
+#include <string.h>
+
+#if CONFIG_RLOG_PROJECT_LEVEL > RLOG_LEVEL_NONE
+static const char * tagARENA = "ARENA";
+#endif // CONFIG_RLOG_PROJECT_LEVEL
+
+// -----------------------------------------------------------------------------------------------------------------------
+// ------------------------------------------------------ Arena ----------------------------------------------------------
+// -----------------------------------------------------------------------------------------------------------------------
+
+bool rs_arena_init(rs_arena_t* arena, void* buffer, size_t size)
+{
+  if ((arena == nullptr) || (size == 0)) return false;
+  memset(arena, 0, sizeof(rs_arena_t));
+  if (buffer) {
+    arena->base = (char*)buffer;
+  } else {
+    arena->base = (char*)rs_malloc(size);
+    if (arena->base == nullptr) {
+      rlog_e(tagARENA, "Failed to create arena of %d bytes: out of memory!", (int)size);
+      return false;
+    };
+    arena->owned = true;
+  };
+  arena->size = size;
+  return true;
+}
+
+void rs_arena_reset(rs_arena_t* arena)
+{
+  if (arena) arena->used = 0;
+}
+
+void rs_arena_free(rs_arena_t* arena)
+{
+  if (arena) {
+    if (arena->owned) rs_free(arena->base);
+    memset(arena, 0, sizeof(rs_arena_t));
+  };
+}
+
+size_t rs_arena_available(const rs_arena_t* arena)
+{
+  return arena ? arena->size - arena->used : 0;
+}
+
+// Commits pad + size bytes at the current position and returns the block after the padding
+static char* arenaReserve(rs_arena_t* arena, size_t pad, size_t size)
+{
+  size_t available = arena->size - arena->used;
+  if ((pad > available) || (size > available - pad)) {
+    arena->failures++;
+    rlog_e(tagARENA, "Arena exhausted: %d bytes requested, %d bytes available", (int)(pad + size), (int)available);
+    return nullptr;
+  };
+  char* ret = arena->base + arena->used + pad;
+  arena->used += pad + size;
+  if (arena->used > arena->peak) arena->peak = arena->used;
+  return ret;
+}
+
+// No alignment (strings)
+static inline char* arenaCommit(rs_arena_t* arena, size_t size)
+{
+  return arenaReserve(arena, 0, size);
+}
+
+void* rs_arena_alloc(rs_arena_t* arena, size_t size)
+{
+  if ((arena == nullptr) || (arena->base == nullptr)) return nullptr;
+  size_t pad = (sizeof(void*) - ((uintptr_t)(arena->base + arena->used) & (sizeof(void*) - 1))) & (sizeof(void*) - 1);
+  return arenaReserve(arena, pad, size);
+}
+
+// -----------------------------------------------------------------------------------------------------------------------
+// -------------------------------------------------- Format strings -----------------------------------------------------
+// -----------------------------------------------------------------------------------------------------------------------
+
+char* malloc_stringl_arena(rs_arena_t* arena, const char *source, const uint32_t len)
+{
+  if ((arena == nullptr) || (arena->base == nullptr) || (source == nullptr)) return nullptr;
+  // Copy up to len characters, the source may be shorter (as malloc_stringl)
+  const char *end = (const char*)memchr(source, 0, len);
+  size_t size = end ? (size_t)(end - source) : len;
+  char* ret = arenaCommit(arena, size+1);
+  if (ret) {
+    memcpy(ret, source, size);
+    ret[size] = '\0';
+  };
+  return ret;
+}
+
+char* malloc_string_arena(rs_arena_t* arena, const char *source)
+{
+  if (source == nullptr) return nullptr;
+  size_t len = strlen(source);
+  char* ret = (arena && arena->base) ? arenaCommit(arena, len+1) : nullptr;
+  if (ret) memcpy(ret, source, len+1);
+  return ret;
+}
+
+char* vmalloc_stringf_arena(rs_arena_t* arena, const char *format, va_list args)
+{
+  if ((arena == nullptr) || (arena->base == nullptr) || (format == nullptr)) return nullptr;
+  // Format directly into the free space of the arena: a single pass, nothing to copy
+  size_t available = arena->size - arena->used;
+  int len = vsnprintf(arena->base + arena->used, available, format, args);
+  if (len <= 0) return nullptr;
+  return arenaCommit(arena, len+1);
+}
+
+char* malloc_stringf_arena(rs_arena_t* arena, const char *format, ...)
+{
+  va_list args;
+  va_start(args, format);
+  char* ret = vmalloc_stringf_arena(arena, format, args);
+  va_end(args);
+  return ret;
+}
+
+char* malloc_timespan_arena(rs_arena_t* arena, int64_t value, rs_timespan_unit_t unit, rs_timespan_style_t style)
+{
+  char buffer[RS_TIMESPAN_BUFFER_SIZE];
+  size_t len = timespan_to_str(value, unit, style, buffer, sizeof(buffer));
+  return malloc_stringl_arena(arena, buffer, len);
+}
+
+char* malloc_timespan_hms_arena(rs_arena_t* arena, time_t value)
+{
+  return malloc_timespan_arena(arena, value, RS_TIMESPAN_SECONDS, RS_TIMESPAN_HMS);
+}
+
+char* malloc_timespan_dhms_arena(rs_arena_t* arena, time_t value)
+{
+  return malloc_timespan_arena(arena, value, RS_TIMESPAN_SECONDS, RS_TIMESPAN_DHMS);
+}
+
+// -----------------------------------------------------------------------------------------------------------------------
+// -------------------------------------------------- Create topics ------------------------------------------------------
+// -----------------------------------------------------------------------------------------------------------------------
+
+char* mqttGetSubTopic_arena(rs_arena_t* arena, const char *topic, const char *subtopic)
+{
+  return malloc_stringf_arena(arena, "%s/%s", topic, subtopic);
+}
+
+// The exact length is reserved in the arena and the topic is written into it, as mqttGetTopic does in the heap
+char* mqttGetTopic_arena(rs_arena_t* arena, const bool primary, const bool local, const mqtt_header_t kind, const char *special, const char * const *segments, const uint8_t count)
+{
+  if ((arena == nullptr) || (arena->base == nullptr) || ((segments == nullptr) && (count > 0))) return nullptr;
+  const topic_headers_t* headers = topicHeadersAcquire();
+  const topic_header_t* header = &headers->items[topicHeaderIndex(primary, local, kind)];
+  char* ret = arenaCommit(arena, topicLength(header, special, segments, count) + 1);
+  if (ret) {
+    topicWrite(ret, header, special, segments, count);
+  };
+  topicHeadersRelease(headers);
+  return ret;
+}
+
+// Generation of a name of a topic: prefix + location + / + topic 
+char* mqttGetTopicLocation1_arena(rs_arena_t* arena, const bool primary, const bool local, const char *topic)
+{
+  const char* segments[] = { topic };
+  return mqttGetTopic_arena(arena, primary, local, MQTT_HEADER_LOCATION, nullptr, segments, 1);
+}
+
+char* mqttGetTopicLocation2_arena(rs_arena_t* arena, const bool primary, const bool local, const char *topic1, const char *topic2)
+{
+  const char* segments[] = { topic1, topic2 };
+  return mqttGetTopic_arena(arena, primary, local, MQTT_HEADER_LOCATION, nullptr, segments, 2);
+}
+
+char* mqttGetTopicLocation3_arena(rs_arena_t* arena, const bool primary, const bool local, const char *topic1, const char *topic2, const char *topic3)
+{
+  const char* segments[] = { topic1, topic2, topic3 };
+  return mqttGetTopic_arena(arena, primary, local, MQTT_HEADER_LOCATION, nullptr, segments, 3);
+}
+
+char* mqttGetTopicLocation_arena(rs_arena_t* arena, const bool primary, const bool local, const char *topic1, const char *topic2, const char *topic3)
+{
+  if (topic1 == nullptr) return nullptr;
+  const char* segments[] = { topic1, topic2, topic3 };
+  return mqttGetTopic_arena(arena, primary, local, MQTT_HEADER_LOCATION, nullptr, segments, topic3 ? 3 : (topic2 ? 2 : 1));
+}
+
+// Generation of a name of a topic: prefix + location + / + special + / + topic 
+char* mqttGetTopicSpecial1_arena(rs_arena_t* arena, const bool primary, const bool local, const char *special, const char *topic)
+{
+  const char* segments[] = { topic };
+  return mqttGetTopic_arena(arena, primary, local, MQTT_HEADER_LOCATION, special, segments, 1);
+}
+
+char* mqttGetTopicSpecial2_arena(rs_arena_t* arena, const bool primary, const bool local, const char *special, const char *topic1, const char *topic2)
+{
+  const char* segments[] = { topic1, topic2 };
+  return mqttGetTopic_arena(arena, primary, local, MQTT_HEADER_LOCATION, special, segments, 2);
+}
+
+char* mqttGetTopicSpecial3_arena(rs_arena_t* arena, const bool primary, const bool local, const char *special, const char *topic1, const char *topic2, const char *topic3)
+{
+  const char* segments[] = { topic1, topic2, topic3 };
+  return mqttGetTopic_arena(arena, primary, local, MQTT_HEADER_LOCATION, special, segments, 3);
+}
+
+char* mqttGetTopicSpecial4_arena(rs_arena_t* arena, const bool primary, const bool local, const char *special, const char *topic1, const char *topic2, const char *topic3, const char *topic4)
+{
+  const char* segments[] = { topic1, topic2, topic3, topic4 };
+  return mqttGetTopic_arena(arena, primary, local, MQTT_HEADER_LOCATION, special, segments, 4);
+}
+
+char* mqttGetTopicSpecial5_arena(rs_arena_t* arena, const bool primary, const bool local, const char *special, const char *topic1, const char *topic2, const char *topic3, const char *topic4, const char *topic5)
+{
+  const char* segments[] = { topic1, topic2, topic3, topic4, topic5 };
+  return mqttGetTopic_arena(arena, primary, local, MQTT_HEADER_LOCATION, special, segments, 5);
+}
+
+char* mqttGetTopicSpecial_arena(rs_arena_t* arena, const bool primary, const bool local, const char *special, const char *topic1, const char *topic2, const char *topic3)
+{
+  if (topic1 == nullptr) return nullptr;
+  const char* segments[] = { topic1, topic2, topic3 };
+  return mqttGetTopic_arena(arena, primary, local, MQTT_HEADER_LOCATION, special, segments, topic3 ? 3 : (topic2 ? 2 : 1));
+}
+
+// Generation of a name of a topic: prefix + location + / + device + / + topic 
+char* mqttGetTopicDevice1_arena(rs_arena_t* arena, const bool primary, const bool local, const char *topic)
+{
+  const char* segments[] = { topic };
+  return mqttGetTopic_arena(arena, primary, local, MQTT_HEADER_DEVICE, nullptr, segments, 1);
+}
+
+char* mqttGetTopicDevice2_arena(rs_arena_t* arena, const bool primary, const bool local, const char *topic1, const char *topic2)
+{
+  const char* segments[] = { topic1, topic2 };
+  return mqttGetTopic_arena(arena, primary, local, MQTT_HEADER_DEVICE, nullptr, segments, 2);
+}
+
+char* mqttGetTopicDevice3_arena(rs_arena_t* arena, const bool primary, const bool local, const char *topic1, const char *topic2, const char *topic3)
+{
+  const char* segments[] = { topic1, topic2, topic3 };
+  return mqttGetTopic_arena(arena, primary, local, MQTT_HEADER_DEVICE, nullptr, segments, 3);
+}
+
+char* mqttGetTopicDevice4_arena(rs_arena_t* arena, const bool primary, const bool local, const char *topic1, const char *topic2, const char *topic3, const char *topic4)
+{
+  const char* segments[] = { topic1, topic2, topic3, topic4 };
+  return mqttGetTopic_arena(arena, primary, local, MQTT_HEADER_DEVICE, nullptr, segments, 4);
+}
+
+char* mqttGetTopicDevice5_arena(rs_arena_t* arena, const bool primary, const bool local, const char *topic1, const char *topic2, const char *topic3, const char *topic4, const char *topic5)
+{
+  const char* segments[] = { topic1, topic2, topic3, topic4, topic5 };
+  return mqttGetTopic_arena(arena, primary, local, MQTT_HEADER_DEVICE, nullptr, segments, 5);
+}
+
+char* mqttGetTopicDevice_arena(rs_arena_t* arena, const bool primary, const bool local, const char *topic1, const char *topic2, const char *topic3)
+{
+  if (topic1 == nullptr) return nullptr;
+  const char* segments[] = { topic1, topic2, topic3 };
+  return mqttGetTopic_arena(arena, primary, local, MQTT_HEADER_DEVICE, nullptr, segments, topic3 ? 3 : (topic2 ? 2 : 1));
+}
@@ -0,0 +1,184 @@
+#include "rStringsBuilder.h"
+#include "rStrings.h"
+#include "rStringsTime.h"
+#include "def_consts.h"
+#include "rLog.h"
+#include <stdio.h>
+#include <string.h>
+
+#if CONFIG_RLOG_PROJECT_LEVEL > RLOG_LEVEL_NONE
+static const char * tagBUILDER = "BUILDER";
+#endif // CONFIG_RLOG_PROJECT_LEVEL
+
+// -----------------------------------------------------------------------------------------------------------------------
+// ----------------------------------------------------- Buffer ----------------------------------------------------------
+// -----------------------------------------------------------------------------------------------------------------------
+
+bool rs_builder_init(rs_builder_t* builder, size_t reserve)
+{
+  if (builder == nullptr) return false;
+  memset(builder, 0, sizeof(rs_builder_t));
+  return (reserve == 0) || rs_builder_reserve(builder, reserve);
+}
+
+void rs_builder_adopt(rs_builder_t* builder, char* str)
+{
+  if (builder == nullptr) return;
+  memset(builder, 0, sizeof(rs_builder_t));
+  if (str) {
+    builder->data = str;
+    builder->len = strlen(str);
+    // The allocator may know that the block is bigger than the string (spare room of a previous detach)
+    size_t usable = rs_usable_size(str);
+    builder->capacity = usable > builder->len ? usable : builder->len + 1;
+  };
+}
+
+bool rs_builder_reserve(rs_builder_t* builder, size_t additional)
+{
+  if ((builder == nullptr) || builder->failed) return false;
+  size_t needed = builder->len + additional + 1;
+  if (needed <= builder->capacity) return true;
+  size_t capacity = builder->capacity + builder->capacity / 2;
+  if (capacity < needed) capacity = needed;
+  char* data = (char*)rs_realloc(builder->data, capacity);
+  if (data == nullptr) {
+    rlog_e(tagBUILDER, "Failed to grow string to %d bytes: out of memory!", (int)capacity);
+    builder->failed = true;
+    return false;
+  };
+  if (builder->data == nullptr) data[0] = '\0';
+  builder->data = data;
+  builder->capacity = capacity;
+  return true;
+}
+
+// -----------------------------------------------------------------------------------------------------------------------
+// ----------------------------------------------------- Append ----------------------------------------------------------
+// -----------------------------------------------------------------------------------------------------------------------
+
+bool rs_builder_appendl(rs_builder_t* builder, const char* str, size_t len)
+{
+  if (!rs_builder_reserve(builder, len)) return false;
+  memcpy(builder->data + builder->len, str, len);
+  builder->len += len;
+  builder->data[builder->len] = '\0';
+  return true;
+}
+
+bool rs_builder_append(rs_builder_t* builder, const char* str)
+{
+  if (str == nullptr) return (builder != nullptr) && !builder->failed;
+  return rs_builder_appendl(builder, str, strlen(str));
+}
+
+bool rs_builder_append_char(rs_builder_t* builder, char c)
+{
+  if (!rs_builder_reserve(builder, 1)) return false;
+  builder->data[builder->len++] = c;
+  builder->data[builder->len] = '\0';
+  return true;
+}
+
+bool rs_builder_append_sep(rs_builder_t* builder, const char* separator, const char* str)
+{
+  if ((builder != nullptr) && (builder->len > 0) && !rs_builder_append(builder, separator)) return false;
+  return rs_builder_append(builder, str);
+}
+
+bool rs_builder_append_vfmt(rs_builder_t* builder, const char* format, va_list args)
+{
+  if ((builder == nullptr) || builder->failed || (format == nullptr)) return false;
+  // Usually the result fits into the spare room and is formatted once
+  va_list copy;
+  va_copy(copy, args);
+  size_t available = builder->capacity > builder->len ? builder->capacity - builder->len : 0;
+  int len = vsnprintf(available > 0 ? builder->data + builder->len : nullptr, available, format, copy);
+  va_end(copy);
+  if (len < 0) return false;
+  if ((size_t)len >= available) {
+    if (!rs_builder_reserve(builder, len)) return false;
+    vsnprintf(builder->data + builder->len, len + 1, format, args);
+  };
+  builder->len += len;
+  return true;
+}
+
+bool rs_builder_append_fmt(rs_builder_t* builder, const char* format, ...)
+{
+  va_list args;
+  va_start(args, format);
+  bool ret = rs_builder_append_vfmt(builder, format, args);
+  va_end(args);
+  return ret;
+}
+
+bool rs_builder_append_int(rs_builder_t* builder, int64_t value)
+{
+  if (!rs_builder_reserve(builder, 20)) return false;
+  builder->len += i64_to_str(value, builder->data + builder->len, 10);
+  return true;
+}
+
+bool rs_builder_append_time(rs_builder_t* builder, const char* format, time_t value)
+{
+  if ((format == nullptr) || (*format == '\0')) return (builder != nullptr) && !builder->failed;
+  // strftime returns 0 if the result does not fit: more room is reserved until it fits or the result
+  // is longer than any conversion could make it (more than 32 characters per character of the format)
+  size_t limit = CONFIG_FORMAT_STRFTIME_BUFFER_SIZE + 32 * strlen(format);
+  size_t reserve = CONFIG_FORMAT_STRFTIME_BUFFER_SIZE - 1;
+  while (rs_builder_reserve(builder, reserve)) {
+    size_t len = time2str_cached(format, value, builder->data + builder->len, builder->capacity - builder->len);
+    if (len > 0) {
+      builder->len += len;
+      return true;
+    };
+    if (reserve >= limit) {
+      rlog_e(tagBUILDER, "Failed to format time \"%.16s...\"", format);
+      builder->failed = true;
+      return false;
+    };
+    reserve *= 2;
+  };
+  return false;
+}
+
+// -----------------------------------------------------------------------------------------------------------------------
+// ----------------------------------------------------- Result ----------------------------------------------------------
+// -----------------------------------------------------------------------------------------------------------------------
+
+char* rs_builder_detach(rs_builder_t* builder)
+{
+  if (builder == nullptr) return nullptr;
+  if (builder->failed) {
+    rs_builder_free(builder);
+    return nullptr;
+  };
+  if ((builder->data == nullptr) && !rs_builder_reserve(builder, 0)) {
+    rs_builder_free(builder);
+    return nullptr;
+  };
+  char* ret = builder->data;
+  memset(builder, 0, sizeof(rs_builder_t));
+  return ret;
+}
+
+char* rs_builder_detach_fit(rs_builder_t* builder)
+{
+  if ((builder != nullptr) && !builder->failed && builder->data && (builder->capacity > builder->len + 1)) {
+    // Shrinking should not fail, but if it does the original block is still valid
+    char* data = (char*)rs_realloc(builder->data, builder->len + 1);
+    if (data) {
+      builder->data = data;
+      builder->capacity = builder->len + 1;
+    };
+  };
+  return rs_builder_detach(builder);
+}
+
+void rs_builder_free(rs_builder_t* builder)
+{
+  if (builder == nullptr) return;
+  rs_free(builder->data);
+  memset(builder, 0, sizeof(rs_builder_t));
+}
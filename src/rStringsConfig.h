@@ -0,0 +1,56 @@
+/* 
+   EN: Default values of the rStrings options, any of them can be overridden in project_config.h
+   RU: Значения параметров rStrings по умолчанию, любой из них можно переопределить в project_config.h
+*/
+
+#ifndef __R_STRINGS_CONFIG_H__
+#define __R_STRINGS_CONFIG_H__
+
+#include "project_config.h"
+
+// Number of topics kept by mqttInternTopic(), power of two
+#ifndef CONFIG_RSTRINGS_INTERN_CAPACITY
+#define CONFIG_RSTRINGS_INTERN_CAPACITY 64
+#endif // CONFIG_RSTRINGS_INTERN_CAPACITY
+
+// Scratch buffer of malloc_stringf(): strings that fit are formatted once and copied, 0 - always measure first
+#ifndef CONFIG_RSTRINGS_FORMAT_SCRATCH_SIZE
+#define CONFIG_RSTRINGS_FORMAT_SCRATCH_SIZE 128
+#endif // CONFIG_RSTRINGS_FORMAT_SCRATCH_SIZE
+
+// Placement of the scratch buffer: 0 - on the stack of the caller, 1 - one static buffer per task (thread-local)
+#ifndef CONFIG_RSTRINGS_FORMAT_SCRATCH_TLS
+#define CONFIG_RSTRINGS_FORMAT_SCRATCH_TLS 0
+#endif // CONFIG_RSTRINGS_FORMAT_SCRATCH_TLS
+
+// Number of formats kept by the time cache of time2str(), 0 - time2str() calls localtime_r and strftime every time
+#ifndef CONFIG_RSTRINGS_TIME_CACHE_SLOTS
+#define CONFIG_RSTRINGS_TIME_CACHE_SLOTS 4
+#endif // CONFIG_RSTRINGS_TIME_CACHE_SLOTS
+
+// Longest format (and rendered string) kept by the time cache, longer ones are rendered every time
+#ifndef CONFIG_RSTRINGS_TIME_CACHE_LENGTH
+#define CONFIG_RSTRINGS_TIME_CACHE_LENGTH 32
+#endif // CONFIG_RSTRINGS_TIME_CACHE_LENGTH
+
+// Days after rs_tz_update() covered by the time zone table of rs_localtime_r(), later times use localtime_r()
+#ifndef CONFIG_RSTRINGS_TZ_WINDOW_DAYS
+#define CONFIG_RSTRINGS_TZ_WINDOW_DAYS 400
+#endif // CONFIG_RSTRINGS_TZ_WINDOW_DAYS
+
+// Maximum number of offset changes (DST transitions) within the window
+#ifndef CONFIG_RSTRINGS_TZ_TRANSITIONS
+#define CONFIG_RSTRINGS_TZ_TRANSITIONS 8
+#endif // CONFIG_RSTRINGS_TZ_TRANSITIONS
+
+// Deepest filter (number of levels) accepted by mqttTrieSubscribe(), deeper topics are matched by # filters only
+#ifndef CONFIG_RSTRINGS_TRIE_MAX_LEVELS
+#define CONFIG_RSTRINGS_TRIE_MAX_LEVELS 32
+#endif // CONFIG_RSTRINGS_TRIE_MAX_LEVELS
+
+// Memory for the text of topic headers changed by mqttSetTopicHeaders(), allocated twice (current and next table)
+#ifndef CONFIG_RSTRINGS_TOPIC_HEADERS_SIZE
+#define CONFIG_RSTRINGS_TOPIC_HEADERS_SIZE 256
+#endif // CONFIG_RSTRINGS_TOPIC_HEADERS_SIZE
+
+#endif // __R_STRINGS_CONFIG_H__
@@ -0,0 +1,265 @@
+#include "rStringsJson.h"
+#include "rStringsConfig.h"
+#include "def_consts.h"
+#include "rLog.h"
+#include <math.h>
+#include <string.h>
+
+#if CONFIG_RLOG_PROJECT_LEVEL > RLOG_LEVEL_NONE
+static const char * tagJSON = "JSON";
+#endif // CONFIG_RLOG_PROJECT_LEVEL
+
+void rs_json_init(rs_json_t* json, rs_sink_t* sink)
+{
+  if (json) {
+    json->sink = sink;
+    json->arrays = 0;
+    json->depth = 0;
+    json->first = true;
+    json->failed = (sink == nullptr) || sink->failed;
+  };
+}
+
+// Output of one call is collected on the stack and passed to the sink at once, sink calls cost more than copying
+#define JSON_CHUNK_SIZE 96
+
+typedef struct {
+  rs_json_t* json;
+  size_t     len;
+  char       data[JSON_CHUNK_SIZE];
+} json_chunk_t;
+
+static bool jsonFlush(json_chunk_t* chunk)
+{
+  if (chunk->len > 0) {
+    if (!sink_write(chunk->json->sink, chunk->data, chunk->len)) chunk->json->failed = true;
+    chunk->len = 0;
+  };
+  return !chunk->json->failed;
+}
+
+static bool jsonPut(json_chunk_t* chunk, const char* data, size_t len)
+{
+  if (len > JSON_CHUNK_SIZE - chunk->len) {
+    if (!jsonFlush(chunk)) return false;
+    if (len > JSON_CHUNK_SIZE) {
+      if (!sink_write(chunk->json->sink, data, len)) chunk->json->failed = true;
+      return !chunk->json->failed;
+    };
+  };
+  memcpy(chunk->data + chunk->len, data, len);
+  chunk->len += len;
+  return true;
+}
+
+static inline bool jsonPutChar(json_chunk_t* chunk, char c)
+{
+  if ((chunk->len == JSON_CHUNK_SIZE) && !jsonFlush(chunk)) return false;
+  chunk->data[chunk->len++] = c;
+  return true;
+}
+
+// -----------------------------------------------------------------------------------------------------------------------
+// ---------------------------------------------------- Strings ----------------------------------------------------------
+// -----------------------------------------------------------------------------------------------------------------------
+
+// Quotes, backslashes and control characters are escaped, everything else (including UTF-8) is copied in runs
+static bool jsonQuoted(json_chunk_t* chunk, const char* str, size_t len)
+{
+  static const char hex[] = "0123456789abcdef";
+  if (!jsonPutChar(chunk, '"')) return false;
+  size_t run = 0;
+  for (size_t i = 0; i < len; i++) {
+    uint8_t c = (uint8_t)str[i];
+    if ((c >= 0x20) && (c != '"') && (c != '\\')) continue;
+    if ((i > run) && !jsonPut(chunk, str + run, i - run)) return false;
+    char escape[6] = { '\\', (char)c, 0, 0, 0, 0 };
+    size_t size = 2;
+    switch (c) {
+      case '"': case '\\': break;
+      case '\b': escape[1] = 'b'; break;
+      case '\f': escape[1] = 'f'; break;
+      case '\n': escape[1] = 'n'; break;
+      case '\r': escape[1] = 'r'; break;
+      case '\t': escape[1] = 't'; break;
+      default:
+        escape[1] = 'u'; escape[2] = '0'; escape[3] = '0';
+        escape[4] = hex[c >> 4]; escape[5] = hex[c & 0x0F];
+        size = 6;
+        break;
+    };
+    if (!jsonPut(chunk, escape, size)) return false;
+    run = i + 1;
+  };
+  if ((len > run) && !jsonPut(chunk, str + run, len - run)) return false;
+  return jsonPutChar(chunk, '"');
+}
+
+// -----------------------------------------------------------------------------------------------------------------------
+// --------------------------------------------------- Structure ---------------------------------------------------------
+// -----------------------------------------------------------------------------------------------------------------------
+
+static inline bool jsonInArray(const rs_json_t* json)
+{
+  return (json->depth > 0) && (json->arrays & ((uint32_t)1 << (json->depth - 1)));
+}
+
+static bool jsonMisuse(rs_json_t* json, const char* reason)
+{
+  rlog_e(tagJSON, "Invalid JSON output: %s", reason);
+  json->failed = true;
+  return false;
+}
+
+// Separator and key before the next value, the chunk is started for the output of the call
+static bool jsonValue(rs_json_t* json, const char* key, json_chunk_t* chunk)
+{
+  if ((json == nullptr) || json->failed) return false;
+  if ((json->depth == 0) && !json->first) return jsonMisuse(json, "more than one top-level value");
+  bool inObject = (json->depth > 0) && !jsonInArray(json);
+  if (inObject != (key != nullptr)) return jsonMisuse(json, inObject ? "value without a key in an object" : "key outside of an object");
+  chunk->json = json;
+  chunk->len = 0;
+  if (!json->first) chunk->data[chunk->len++] = ',';
+  json->first = false;
+  if (key) {
+    return jsonQuoted(chunk, key, strlen(key)) && jsonPutChar(chunk, ':');
+  };
+  return true;
+}
+
+// Ends the output of the call
+static inline bool jsonDone(json_chunk_t* chunk, bool ok)
+{
+  return jsonFlush(chunk) && ok;
+}
+
+static bool jsonBegin(rs_json_t* json, const char* key, bool array)
+{
+  json_chunk_t chunk;
+  if (!jsonValue(json, key, &chunk)) return false;
+  if (json->depth >= RS_JSON_MAX_DEPTH) return jsonMisuse(json, "nesting is too deep");
+  if (array) {
+    json->arrays |= (uint32_t)1 << json->depth;
+  } else {
+    json->arrays &= ~((uint32_t)1 << json->depth);
+  };
+  json->depth++;
+  json->first = true;
+  return jsonDone(&chunk, jsonPutChar(&chunk, array ? '[' : '{'));
+}
+
+static bool jsonEnd(rs_json_t* json, bool array)
+{
+  if ((json == nullptr) || json->failed) return false;
+  if ((json->depth == 0) || (jsonInArray(json) != array)) return jsonMisuse(json, array ? "no array to close" : "no object to close");
+  json->depth--;
+  json->first = false;
+  if (!sink_write(json->sink, array ? "]" : "}", 1)) json->failed = true;
+  return !json->failed;
+}
+
+bool rs_json_object_begin(rs_json_t* json, const char* key)
+{
+  return jsonBegin(json, key, false);
+}
+
+bool rs_json_object_end(rs_json_t* json)
+{
+  return jsonEnd(json, false);
+}
+
+bool rs_json_array_begin(rs_json_t* json, const char* key)
+{
+  return jsonBegin(json, key, true);
+}
+
+bool rs_json_array_end(rs_json_t* json)
+{
+  return jsonEnd(json, true);
+}
+
+bool rs_json_finish(rs_json_t* json)
+{
+  return json && !json->failed && (json->depth == 0) && !json->first;
+}
+
+// -----------------------------------------------------------------------------------------------------------------------
+// ----------------------------------------------------- Values ----------------------------------------------------------
+// -----------------------------------------------------------------------------------------------------------------------
+
+bool rs_json_stringl(rs_json_t* json, const char* key, const char* value, size_t len)
+{
+  json_chunk_t chunk;
+  if (!jsonValue(json, key, &chunk)) return false;
+  return jsonDone(&chunk, value ? jsonQuoted(&chunk, value, len) : jsonPut(&chunk, "null", 4));
+}
+
+bool rs_json_string(rs_json_t* json, const char* key, const char* value)
+{
+  return rs_json_stringl(json, key, value, value ? strlen(value) : 0);
+}
+
+bool rs_json_int(rs_json_t* json, const char* key, int64_t value)
+{
+  json_chunk_t chunk;
+  if (!jsonValue(json, key, &chunk)) return false;
+  char buffer[24];
+  return jsonDone(&chunk, jsonPut(&chunk, buffer, i64_to_str(value, buffer, 10)));
+}
+
+bool rs_json_uint(rs_json_t* json, const char* key, uint64_t value)
+{
+  json_chunk_t chunk;
+  if (!jsonValue(json, key, &chunk)) return false;
+  char buffer[24];
+  return jsonDone(&chunk, jsonPut(&chunk, buffer, ui64_to_str(value, buffer, 10)));
+}
+
+bool rs_json_double(rs_json_t* json, const char* key, double value, uint8_t precision)
+{
+  json_chunk_t chunk;
+  if (!jsonValue(json, key, &chunk)) return false;
+  // JSON has no NaN and infinity
+  if (!isfinite(value)) return jsonDone(&chunk, jsonPut(&chunk, "null", 4));
+  char buffer[RS_DECIMAL_BUFFER_SIZE];
+  return jsonDone(&chunk, jsonPut(&chunk, buffer, double_to_str(value, precision, buffer, sizeof(buffer))));
+}
+
+bool rs_json_fixed(rs_json_t* json, const char* key, int64_t value, uint8_t scale)
+{
+  json_chunk_t chunk;
+  if (!jsonValue(json, key, &chunk)) return false;
+  char buffer[RS_DECIMAL_BUFFER_SIZE];
+  return jsonDone(&chunk, jsonPut(&chunk, buffer, fixed_to_str(value, scale, nullptr, buffer, sizeof(buffer))));
+}
+
+bool rs_json_bool(rs_json_t* json, const char* key, bool value)
+{
+  json_chunk_t chunk;
+  if (!jsonValue(json, key, &chunk)) return false;
+  return jsonDone(&chunk, value ? jsonPut(&chunk, "true", 4) : jsonPut(&chunk, "false", 5));
+}
+
+bool rs_json_null(rs_json_t* json, const char* key)
+{
+  json_chunk_t chunk;
+  if (!jsonValue(json, key, &chunk)) return false;
+  return jsonDone(&chunk, jsonPut(&chunk, "null", 4));
+}
+
+bool rs_json_time(rs_json_t* json, const char* key, const char* format, time_t value)
+{
+  json_chunk_t chunk;
+  if (!jsonValue(json, key, &chunk)) return false;
+  char buffer[CONFIG_FORMAT_STRFTIME_BUFFER_SIZE];
+  size_t len = time2str(format, &value, buffer, sizeof(buffer));
+  return jsonDone(&chunk, jsonQuoted(&chunk, buffer, len));
+}
+
+bool rs_json_raw(rs_json_t* json, const char* key, const char* value)
+{
+  json_chunk_t chunk;
+  if (!jsonValue(json, key, &chunk)) return false;
+  return jsonDone(&chunk, value ? jsonPut(&chunk, value, strlen(value)) : jsonPut(&chunk, "null", 4));
+}
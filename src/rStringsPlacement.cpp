@@ -0,0 +1,331 @@
+#include "rStringsAlloc.h"
+#include "rStringsPort.h"
+#include "rLog.h"
+#include <stdlib.h>
+#include <string.h>
+#if defined(ESP_PLATFORM)
+  #include "esp_heap_caps.h"
+  #if defined(__has_include) && __has_include("esp_memory_utils.h")
+    #include "esp_memory_utils.h"
+  #else
+    #include "soc/soc_memory_layout.h"
+  #endif
+  #define PLACEMENT_SIMULATED 0
+#else
+  #define PLACEMENT_SIMULATED 1
+#endif
+
+#if CONFIG_RLOG_PROJECT_LEVEL > RLOG_LEVEL_NONE
+static const char * tagPLACEMENT = "PLACEMENT";
+#endif // CONFIG_RLOG_PROJECT_LEVEL
+
+typedef struct {
+  uint32_t allocs;
+  uint32_t frees;
+  uint64_t bytes;
+  size_t   current;
+  size_t   peak;
+  uint32_t fallbacks;
+  uint32_t failures;
+  uint64_t cost_ps;
+} placement_tier_t;
+
+struct rs_placement_t {
+  rs_placement_config_t config;
+  placement_tier_t      tiers[RS_TIERS];
+};
+
+RS_THREAD_LOCAL rs_alloc_hint_t _allocHint = RS_HINT_AUTO;
+
+rs_alloc_hint_t rs_set_alloc_hint(rs_alloc_hint_t hint)
+{
+  rs_alloc_hint_t prev = _allocHint;
+  _allocHint = hint;
+  return prev;
+}
+
+rs_alloc_hint_t rs_get_alloc_hint(void)
+{
+  return _allocHint;
+}
+
+// -----------------------------------------------------------------------------------------------------------------------
+// ------------------------------------------------------ Tiers ----------------------------------------------------------
+// -----------------------------------------------------------------------------------------------------------------------
+
+#if PLACEMENT_SIMULATED
+
+// Both tiers live on the heap, the header tells them apart and keeps the requested size
+typedef struct {
+  size_t   size;
+  uint32_t tag;
+} tier_header_t;
+
+#define TIER_TAG 0x52544900U
+#define TIER_HEADER_SIZE ((sizeof(tier_header_t) + 15) & ~(size_t)15)
+
+static inline tier_header_t* tierHeader(const void* ptr)
+{
+  return (tier_header_t*)((char*)ptr - TIER_HEADER_SIZE);
+}
+
+static void* tierAlloc(rs_tier_t tier, size_t size)
+{
+  const rs_allocator_t* heap = rs_default_allocator();
+  char* block = (char*)heap->alloc(heap->ctx, TIER_HEADER_SIZE + size);
+  if (block == nullptr) return nullptr;
+  tier_header_t* header = (tier_header_t*)block;
+  header->size = size;
+  header->tag = TIER_TAG | (uint32_t)tier;
+  return block + TIER_HEADER_SIZE;
+}
+
+static void* tierRealloc(rs_tier_t tier, void* ptr, size_t size)
+{
+  const rs_allocator_t* heap = rs_default_allocator();
+  char* block = (char*)heap->realloc(heap->ctx, tierHeader(ptr), TIER_HEADER_SIZE + size);
+  if (block == nullptr) return nullptr;
+  tier_header_t* header = (tier_header_t*)block;
+  header->size = size;
+  header->tag = TIER_TAG | (uint32_t)tier;
+  return block + TIER_HEADER_SIZE;
+}
+
+static void tierFree(void* ptr)
+{
+  const rs_allocator_t* heap = rs_default_allocator();
+  heap->free(heap->ctx, tierHeader(ptr));
+}
+
+static inline size_t tierSize(const void* ptr)
+{
+  return tierHeader(ptr)->size;
+}
+
+static inline rs_tier_t tierOf(const void* ptr)
+{
+  return (rs_tier_t)(tierHeader(ptr)->tag & 0xFF);
+}
+
+#else
+
+static inline uint32_t tierCaps(rs_tier_t tier)
+{
+  return tier == RS_TIER_INTERNAL ? (MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT) : (MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
+}
+
+static void* tierAlloc(rs_tier_t tier, size_t size)
+{
+  return heap_caps_malloc(size, tierCaps(tier));
+}
+
+static void* tierRealloc(rs_tier_t tier, void* ptr, size_t size)
+{
+  return heap_caps_realloc(ptr, size, tierCaps(tier));
+}
+
+static void tierFree(void* ptr)
+{
+  heap_caps_free(ptr);
+}
+
+static inline size_t tierSize(const void* ptr)
+{
+  return heap_caps_get_allocated_size((void*)ptr);
+}
+
+static inline rs_tier_t tierOf(const void* ptr)
+{
+  return esp_ptr_external_ram(ptr) ? RS_TIER_PSRAM : RS_TIER_INTERNAL;
+}
+
+#endif // PLACEMENT_SIMULATED
+
+// -----------------------------------------------------------------------------------------------------------------------
+// ----------------------------------------------------- Policy ----------------------------------------------------------
+// -----------------------------------------------------------------------------------------------------------------------
+
+static rs_tier_t placementChoose(rs_placement_t* placement, size_t size, rs_alloc_hint_t hint)
+{
+  switch (hint) {
+    case RS_HINT_TRANSIENT:
+      return size <= placement->config.transient_max ? RS_TIER_INTERNAL : RS_TIER_PSRAM;
+    case RS_HINT_LONG_LIVED:
+      return RS_TIER_PSRAM;
+    default:
+      return size <= placement->config.internal_max ? RS_TIER_INTERNAL : RS_TIER_PSRAM;
+  };
+}
+
+// Cost model: the block is written once after allocation and read once before release
+static inline void placementCost(rs_placement_t* placement, rs_tier_t tier, size_t size, bool alloc)
+{
+  uint64_t cost = (uint64_t)size * placement->config.cost_byte_ps[tier];
+  if (alloc) cost += (uint64_t)placement->config.cost_alloc_ns[tier] * 1000;
+  if (cost) RS_ATOMIC_ADD(&placement->tiers[tier].cost_ps, cost);
+}
+
+static void placementAcquired(rs_placement_t* placement, rs_tier_t tier, size_t size)
+{
+  placement_tier_t* stats = &placement->tiers[tier];
+  RS_ATOMIC_ADD(&stats->allocs, (uint32_t)1);
+  RS_ATOMIC_ADD(&stats->bytes, (uint64_t)size);
+  size_t current = RS_ATOMIC_ADD(&stats->current, size);
+  RS_ATOMIC_MAX(&stats->peak, current);
+  placementCost(placement, tier, size, true);
+}
+
+static void placementReleased(rs_placement_t* placement, rs_tier_t tier, size_t size)
+{
+  placement_tier_t* stats = &placement->tiers[tier];
+  RS_ATOMIC_ADD(&stats->frees, (uint32_t)1);
+  RS_ATOMIC_SUB(&stats->current, size);
+  placementCost(placement, tier, size, false);
+}
+
+void* rs_placement_alloc(rs_placement_t* placement, size_t size, rs_alloc_hint_t hint)
+{
+  rs_tier_t tier = placementChoose(placement, size, hint);
+  if ((tier == RS_TIER_INTERNAL) && (placement->config.internal_budget > 0)
+   && (RS_ATOMIC_LOAD(&placement->tiers[RS_TIER_INTERNAL].current) + size > placement->config.internal_budget)) {
+    RS_ATOMIC_ADD(&placement->tiers[RS_TIER_INTERNAL].fallbacks, (uint32_t)1);
+    tier = RS_TIER_PSRAM;
+  };
+  void* ret = tierAlloc(tier, size);
+  if (ret == nullptr) {
+    // The other tier is better than nothing
+    RS_ATOMIC_ADD(&placement->tiers[tier].fallbacks, (uint32_t)1);
+    tier = tier == RS_TIER_INTERNAL ? RS_TIER_PSRAM : RS_TIER_INTERNAL;
+    ret = tierAlloc(tier, size);
+    if (ret == nullptr) {
+      RS_ATOMIC_ADD(&placement->tiers[tier].failures, (uint32_t)1);
+      return nullptr;
+    };
+  };
+  placementAcquired(placement, tierOf(ret), tierSize(ret));
+  return ret;
+}
+
+rs_tier_t rs_placement_tier(rs_placement_t* placement, const void* ptr)
+{
+  (void)placement;
+  return tierOf(ptr);
+}
+
+// -----------------------------------------------------------------------------------------------------------------------
+// --------------------------------------------------- Allocator ---------------------------------------------------------
+// -----------------------------------------------------------------------------------------------------------------------
+
+static void* placement_alloc(void* ctx, size_t size)
+{
+  return rs_placement_alloc((rs_placement_t*)ctx, size, _allocHint);
+}
+
+static void placement_free(void* ctx, void* ptr)
+{
+  if (ptr) {
+    placementReleased((rs_placement_t*)ctx, tierOf(ptr), tierSize(ptr));
+    tierFree(ptr);
+  };
+}
+
+// A block grows within its tier
+static void* placement_realloc(void* ctx, void* ptr, size_t size)
+{
+  rs_placement_t* placement = (rs_placement_t*)ctx;
+  if (ptr == nullptr) return placement_alloc(ctx, size);
+  rs_tier_t tier = tierOf(ptr);
+  size_t prev = tierSize(ptr);
+  void* ret = tierRealloc(tier, ptr, size);
+  if (ret == nullptr) {
+    RS_ATOMIC_ADD(&placement->tiers[tier].failures, (uint32_t)1);
+    return nullptr;
+  };
+  placementReleased(placement, tier, prev);
+  placementAcquired(placement, tier, tierSize(ret));
+  return ret;
+}
+
+static size_t placement_size(void* ctx, const void* ptr)
+{
+  (void)ctx;
+  return tierSize(ptr);
+}
+
+// -----------------------------------------------------------------------------------------------------------------------
+// ---------------------------------------------------- Placement --------------------------------------------------------
+// -----------------------------------------------------------------------------------------------------------------------
+
+rs_placement_t* rs_placement_create(const rs_placement_config_t* config)
+{
+  const rs_allocator_t* heap = rs_default_allocator();
+  rs_placement_t* placement = (rs_placement_t*)heap->alloc(heap->ctx, sizeof(rs_placement_t));
+  if (placement == nullptr) {
+    rlog_e(tagPLACEMENT, "Failed to create placement policy: out of memory!");
+    return nullptr;
+  };
+  memset(placement, 0, sizeof(rs_placement_t));
+  if (config) {
+    placement->config = *config;
+  } else {
+    placement->config.internal_max = 64;
+    placement->config.transient_max = 256;
+  };
+  return placement;
+}
+
+void rs_placement_delete(rs_placement_t* placement)
+{
+  if (placement) {
+    if (RS_ATOMIC_LOAD(&placement->tiers[RS_TIER_INTERNAL].current) + RS_ATOMIC_LOAD(&placement->tiers[RS_TIER_PSRAM].current) > 0) {
+      rlog_e(tagPLACEMENT, "Placement policy deleted with %d bytes outstanding",
+        (int)(placement->tiers[RS_TIER_INTERNAL].current + placement->tiers[RS_TIER_PSRAM].current));
+    };
+    const rs_allocator_t* heap = rs_default_allocator();
+    heap->free(heap->ctx, placement);
+  };
+}
+
+void rs_placement_allocator(rs_placement_t* placement, rs_allocator_t* allocator)
+{
+  if (allocator) {
+    allocator->alloc = placement_alloc;
+    allocator->realloc = placement_realloc;
+    allocator->free = placement_free;
+    allocator->size = placement_size;
+    allocator->ctx = placement;
+  };
+}
+
+bool rs_placement_get_stats(rs_placement_t* placement, rs_tier_t tier, rs_tier_stats_t* stats)
+{
+  if (placement && stats && ((unsigned)tier < RS_TIERS)) {
+    placement_tier_t* source = &placement->tiers[tier];
+    stats->allocs = RS_ATOMIC_LOAD(&source->allocs);
+    stats->frees = RS_ATOMIC_LOAD(&source->frees);
+    stats->bytes = RS_ATOMIC_LOAD(&source->bytes);
+    stats->current = RS_ATOMIC_LOAD(&source->current);
+    stats->peak = RS_ATOMIC_LOAD(&source->peak);
+    stats->fallbacks = RS_ATOMIC_LOAD(&source->fallbacks);
+    stats->failures = RS_ATOMIC_LOAD(&source->failures);
+    stats->cost_ns = RS_ATOMIC_LOAD(&source->cost_ps) / 1000;
+    return true;
+  };
+  return false;
+}
+
+void rs_placement_reset_stats(rs_placement_t* placement)
+{
+  if (placement) {
+    for (uint8_t i = 0; i < RS_TIERS; i++) {
+      placement_tier_t* stats = &placement->tiers[i];
+      RS_ATOMIC_STORE(&stats->allocs, (uint32_t)0);
+      RS_ATOMIC_STORE(&stats->frees, (uint32_t)0);
+      RS_ATOMIC_STORE(&stats->bytes, (uint64_t)0);
+      RS_ATOMIC_STORE(&stats->fallbacks, (uint32_t)0);
+      RS_ATOMIC_STORE(&stats->failures, (uint32_t)0);
+      RS_ATOMIC_STORE(&stats->cost_ps, (uint64_t)0);
+      RS_ATOMIC_STORE(&stats->peak, RS_ATOMIC_LOAD(&stats->current));
+    };
+  };
+}
@@ -0,0 +1,98 @@
+/* 
+   EN: Internal platform layer of rStrings: atomic counters, per-task values, short critical sections and yielding
+   RU: Внутренний платформенный слой rStrings: атомарные счетчики, значения задач, короткие критические секции и передача управления
+*/
+
+#ifndef __R_STRINGS_PORT_H__
+#define __R_STRINGS_PORT_H__
+
+#include <stddef.h>
+#include <stdint.h>
+
+#if defined(__AVR__)
+  // Single core and no preemptive tasks: plain memory access is enough
+  #define RS_ATOMIC_LOAD(ptr)             (*(ptr))
+  #define RS_ATOMIC_STORE(ptr, val)       (*(ptr) = (val))
+  #define RS_ATOMIC_ADD(ptr, val)         (*(ptr) += (val))
+  #define RS_ATOMIC_SUB(ptr, val)         (*(ptr) -= (val))
+  #define RS_ATOMIC_CAS(ptr, expected, desired) \
+    ((*(ptr) == *(expected)) ? (*(ptr) = (desired), true) : (*(expected) = *(ptr), false))
+  #define RS_ATOMIC_FENCE()               __asm__ __volatile__("" ::: "memory")
+#else
+  #define RS_ATOMIC_LOAD(ptr)             __atomic_load_n(ptr, __ATOMIC_ACQUIRE)
+  #define RS_ATOMIC_STORE(ptr, val)       __atomic_store_n(ptr, val, __ATOMIC_RELEASE)
+  #define RS_ATOMIC_ADD(ptr, val)         __atomic_add_fetch(ptr, val, __ATOMIC_RELAXED)
+  #define RS_ATOMIC_SUB(ptr, val)         __atomic_sub_fetch(ptr, val, __ATOMIC_RELAXED)
+  #define RS_ATOMIC_CAS(ptr, expected, desired) \
+    __atomic_compare_exchange_n(ptr, expected, desired, false, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE)
+  #define RS_ATOMIC_FENCE()               __atomic_thread_fence(__ATOMIC_SEQ_CST)
+#endif // __AVR__
+
+// Storage that is separate for every task (thread)
+#if defined(__AVR__) || defined(ESP8266)
+  #define RS_THREAD_LOCAL static
+#else
+  #define RS_THREAD_LOCAL static __thread
+#endif // __AVR__
+
+// Per-task values with a destructor called when the task (thread) exits
+#if defined(__AVR__) || defined(ESP8266)
+  // The only task: the key holds the value itself
+  typedef void* rs_tls_key_t;
+  #define RS_TLS_CREATE(key, destructor)  (*(key) = nullptr, (void)(destructor), true)
+  #define RS_TLS_DELETE(key)              (void)(key)
+  #define RS_TLS_GET(key)                 (*(key))
+  #define RS_TLS_SET(key, value)          (*(key) = (value))
+#else
+  #include <pthread.h>
+  typedef pthread_key_t rs_tls_key_t;
+  #define RS_TLS_CREATE(key, destructor)  (pthread_key_create(key, destructor) == 0)
+  #define RS_TLS_DELETE(key)              pthread_key_delete(*(key))
+  #define RS_TLS_GET(key)                 pthread_getspecific(*(key))
+  #define RS_TLS_SET(key, value)          pthread_setspecific(*(key), value)
+#endif // __AVR__
+
+// Raises *ptr to value if value is greater (peak tracking)
+#define RS_ATOMIC_MAX(ptr, value) do { \
+  __typeof__(*(ptr)) _rs_prev = RS_ATOMIC_LOAD(ptr); \
+  while ((_rs_prev < (value)) && !RS_ATOMIC_CAS(ptr, &_rs_prev, (value))) {}; \
+} while (0)
+
+// Short critical sections (a few instructions: list manipulation, table updates)
+#if defined(ESP_PLATFORM)
+  #include "freertos/FreeRTOS.h"
+  typedef portMUX_TYPE rs_lock_t;
+  #define RS_LOCK_INITIALIZER             portMUX_INITIALIZER_UNLOCKED
+  #define RS_LOCK_INIT(lock)              portMUX_INITIALIZE(lock)
+  #define RS_LOCK_DEINIT(lock)            (void)(lock)
+  #define RS_LOCK(lock)                   portENTER_CRITICAL(lock)
+  #define RS_UNLOCK(lock)                 portEXIT_CRITICAL(lock)
+#elif defined(__AVR__) || defined(ESP8266)
+  typedef uint8_t rs_lock_t;
+  #define RS_LOCK_INITIALIZER             0
+  #define RS_LOCK_INIT(lock)              (void)(lock)
+  #define RS_LOCK_DEINIT(lock)            (void)(lock)
+  #define RS_LOCK(lock)                   (void)(lock)
+  #define RS_UNLOCK(lock)                 (void)(lock)
+#else
+  #include <pthread.h>
+  typedef pthread_mutex_t rs_lock_t;
+  #define RS_LOCK_INITIALIZER             PTHREAD_MUTEX_INITIALIZER
+  #define RS_LOCK_INIT(lock)              pthread_mutex_init(lock, nullptr)
+  #define RS_LOCK_DEINIT(lock)            pthread_mutex_destroy(lock)
+  #define RS_LOCK(lock)                   pthread_mutex_lock(lock)
+  #define RS_UNLOCK(lock)                 pthread_mutex_unlock(lock)
+#endif // ESP_PLATFORM
+
+// Letting other tasks run while waiting for them (a lower priority task must be able to finish its work)
+#if defined(ESP_PLATFORM)
+  #include "freertos/task.h"
+  #define RS_YIELD()                      vTaskDelay(1)
+#elif defined(__AVR__) || defined(ESP8266)
+  #define RS_YIELD()                      do {} while (0)
+#else
+  #include <sched.h>
+  #define RS_YIELD()                      sched_yield()
+#endif // ESP_PLATFORM
+
+#endif // __R_STRINGS_PORT_H__
@@ -0,0 +1,187 @@
+#include "rStringsSink.h"
+#include "rStringsTopicHeaders.h"
+#include "rStringsConfig.h"
+#include "def_consts.h"
+#include "rLog.h"
+#include <stdio.h>
+#include <string.h>
+
+#if CONFIG_RLOG_PROJECT_LEVEL > RLOG_LEVEL_NONE
+static const char * tagSINK = "SINK";
+#endif // CONFIG_RLOG_PROJECT_LEVEL
+
+// -----------------------------------------------------------------------------------------------------------------------
+// ------------------------------------------------------ Sinks ----------------------------------------------------------
+// -----------------------------------------------------------------------------------------------------------------------
+
+void rs_sink_init(rs_sink_t* sink, rs_sink_write_t write, void* ctx)
+{
+  if (sink) {
+    sink->write = write;
+    sink->ctx = ctx;
+    sink->written = 0;
+    sink->failed = (write == nullptr);
+  };
+}
+
+static size_t bufferWrite(void* ctx, const char* data, size_t len)
+{
+  rs_sink_buffer_t* target = (rs_sink_buffer_t*)ctx;
+  // One byte is always reserved for the terminating zero
+  size_t free = target->size - target->len - 1;
+  size_t size = len < free ? len : free;
+  memcpy(target->buffer + target->len, data, size);
+  target->len += size;
+  target->buffer[target->len] = '\0';
+  return size;
+}
+
+void rs_sink_init_buffer(rs_sink_t* sink, rs_sink_buffer_t* target, char* buffer, size_t size)
+{
+  if (target) {
+    target->buffer = buffer;
+    target->size = size;
+    target->len = 0;
+    if (buffer && size) buffer[0] = '\0';
+  };
+  rs_sink_init(sink, (target && buffer && size) ? bufferWrite : nullptr, target);
+}
+
+static size_t builderWrite(void* ctx, const char* data, size_t len)
+{
+  return rs_builder_appendl((rs_builder_t*)ctx, data, len) ? len : 0;
+}
+
+void rs_sink_init_builder(rs_sink_t* sink, rs_builder_t* builder)
+{
+  rs_sink_init(sink, builder ? builderWrite : nullptr, builder);
+}
+
+// -----------------------------------------------------------------------------------------------------------------------
+// ----------------------------------------------------- Output ----------------------------------------------------------
+// -----------------------------------------------------------------------------------------------------------------------
+
+bool sink_write(rs_sink_t* sink, const char* data, size_t len)
+{
+  if ((sink == nullptr) || sink->failed) return false;
+  if (len > 0) {
+    size_t accepted = sink->write(sink->ctx, data, len);
+    sink->written += accepted;
+    if (accepted < len) sink->failed = true;
+  };
+  return !sink->failed;
+}
+
+bool sink_string(rs_sink_t* sink, const char* str)
+{
+  if (sink == nullptr) return false;
+  return str ? sink_write(sink, str, strlen(str)) : !sink->failed;
+}
+
+bool sink_vstringf(rs_sink_t* sink, const char* format, va_list args)
+{
+  if ((sink == nullptr) || sink->failed || (format == nullptr)) return false;
+  va_list args2;
+  va_copy(args2, args);
+  char chunk[CONFIG_RSTRINGS_FORMAT_SCRATCH_SIZE > 0 ? CONFIG_RSTRINGS_FORMAT_SCRATCH_SIZE : 64];
+  int len = vsnprintf(chunk, sizeof(chunk), format, args);
+  bool ret = false;
+  if (len < 0) {
+    sink->failed = true;
+  } else if (len < (int)sizeof(chunk)) {
+    ret = sink_write(sink, chunk, len);
+  } else {
+    // Rare case: a single formatted result does not fit into the chunk
+    char* temp = (char*)rs_malloc(len + 1);
+    if (temp) {
+      vsnprintf(temp, len + 1, format, args2);
+      ret = sink_write(sink, temp, len);
+      rs_free(temp);
+    } else {
+      rlog_e(tagSINK, "Failed to format string: out of memory!");
+      sink->failed = true;
+    };
+  };
+  va_end(args2);
+  return ret;
+}
+
+bool sink_stringf(rs_sink_t* sink, const char* format, ...)
+{
+  va_list args;
+  va_start(args, format);
+  bool ret = sink_vstringf(sink, format, args);
+  va_end(args);
+  return ret;
+}
+
+// -----------------------------------------------------------------------------------------------------------------------
+// ------------------------------------------------------- Time ----------------------------------------------------------
+// -----------------------------------------------------------------------------------------------------------------------
+
+bool sink_time2str(rs_sink_t* sink, const char* format, time_t* value)
+{
+  if ((sink == nullptr) || (value == nullptr)) return false;
+  char buffer[CONFIG_FORMAT_STRFTIME_BUFFER_SIZE];
+  size_t len = time2str(format, value, buffer, sizeof(buffer));
+  return sink_write(sink, buffer, len);
+}
+
+bool sink_time2str_empty(rs_sink_t* sink, const char* format, time_t* value)
+{
+  if ((sink == nullptr) || (value == nullptr)) return false;
+  if (*value > 0) {
+    return sink_time2str(sink, format, value);
+  } else {
+    return sink_write(sink, CONFIG_FORMAT_EMPTY_DATETIME, sizeof(CONFIG_FORMAT_EMPTY_DATETIME) - 1);
+  };
+}
+
+bool sink_timespan(rs_sink_t* sink, int64_t value, rs_timespan_unit_t unit, rs_timespan_style_t style)
+{
+  char buffer[RS_TIMESPAN_BUFFER_SIZE];
+  size_t len = timespan_to_str(value, unit, style, buffer, sizeof(buffer));
+  return sink_write(sink, buffer, len);
+}
+
+bool sink_timespan_hms(rs_sink_t* sink, time_t value)
+{
+  return sink_timespan(sink, value, RS_TIMESPAN_SECONDS, RS_TIMESPAN_HMS);
+}
+
+bool sink_timespan_dhms(rs_sink_t* sink, time_t value)
+{
+  return sink_timespan(sink, value, RS_TIMESPAN_SECONDS, RS_TIMESPAN_DHMS);
+}
+
+// -----------------------------------------------------------------------------------------------------------------------
+// ------------------------------------------------------ Topics ---------------------------------------------------------
+// -----------------------------------------------------------------------------------------------------------------------
+
+bool mqttSinkSubTopic(rs_sink_t* sink, const char* topic, const char* subtopic)
+{
+  return sink_string(sink, topic) && sink_write(sink, "/", 1) && sink_string(sink, subtopic);
+}
+
+bool mqttSinkTopic(rs_sink_t* sink, const bool primary, const bool local, const mqtt_header_t kind, const char* special, const char* const* topics, const uint8_t count)
+{
+  if ((topics == nullptr) && (count > 0)) return false;
+  bool first = true;
+  // The header is written while the table is held, it may be switched by another task right after that
+  const topic_headers_t* headers = topicHeadersAcquire();
+  const topic_header_t* header = &headers->items[topicHeaderIndex(primary, local, kind)];
+  bool ret = sink_write(sink, header->text, header->len);
+  topicHeadersRelease(headers);
+  if (special) {
+    ret = ret && sink_string(sink, special);
+    first = false;
+  };
+  for (uint8_t i = 0; ret && (i < count); i++) {
+    if (topics[i]) {
+      if (!first) ret = sink_write(sink, "/", 1);
+      ret = ret && sink_string(sink, topics[i]);
+      first = false;
+    };
+  };
+  return ret;
+}
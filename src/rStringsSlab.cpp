@@ -0,0 +1,216 @@
+#include "rStringsAlloc.h"
+#include "rStringsPort.h"
+#include "rLog.h"
+#include <string.h>
+
+#if CONFIG_RLOG_PROJECT_LEVEL > RLOG_LEVEL_NONE
+static const char * tagSLAB = "SLAB";
+#endif // CONFIG_RLOG_PROJECT_LEVEL
+
+// Free blocks are linked through their first bytes
+typedef struct rs_slab_block_t {
+  struct rs_slab_block_t* next;
+} rs_slab_block_t;
+
+typedef struct {
+  char*            begin;
+  char*            end;
+  rs_slab_block_t* free;
+  size_t           block_size;
+  uint16_t         capacity;
+  uint16_t         used;
+  uint16_t         peak;
+  uint32_t         hits;
+  uint32_t         misses;
+} rs_slab_class_t;
+
+struct rs_slab_t {
+  rs_lock_t        lock;
+  char*            begin;
+  char*            end;
+  uint32_t         oversize;
+  rs_slab_class_t  classes[RS_SLAB_CLASSES];
+};
+
+// -----------------------------------------------------------------------------------------------------------------------
+// ---------------------------------------------------- Pool -------------------------------------------------------------
+// -----------------------------------------------------------------------------------------------------------------------
+
+rs_slab_t* rs_slab_create(const uint16_t blocks[RS_SLAB_CLASSES])
+{
+  if (blocks == nullptr) return nullptr;
+  // The pool header and all blocks are placed in one region
+  size_t header = (sizeof(rs_slab_t) + sizeof(void*) - 1) & ~(sizeof(void*) - 1);
+  size_t total = header;
+  for (uint8_t i = 0; i < RS_SLAB_CLASSES; i++) {
+    total += (size_t)blocks[i] * (RS_SLAB_MIN_BLOCK << i);
+  };
+  const rs_allocator_t* heap = rs_default_allocator();
+  char* region = (char*)heap->alloc(heap->ctx, total);
+  if (region == nullptr) {
+    rlog_e(tagSLAB, "Failed to create slab pool of %d bytes: out of memory!", (int)total);
+    return nullptr;
+  };
+  rs_slab_t* slab = (rs_slab_t*)region;
+  memset(slab, 0, sizeof(rs_slab_t));
+  RS_LOCK_INIT(&slab->lock);
+  slab->begin = region + header;
+  slab->end = region + total;
+  char* pos = slab->begin;
+  for (uint8_t i = 0; i < RS_SLAB_CLASSES; i++) {
+    rs_slab_class_t* cls = &slab->classes[i];
+    cls->block_size = RS_SLAB_MIN_BLOCK << i;
+    cls->capacity = blocks[i];
+    cls->begin = pos;
+    // Link blocks in address order
+    rs_slab_block_t** tail = &cls->free;
+    for (uint16_t n = 0; n < blocks[i]; n++) {
+      *tail = (rs_slab_block_t*)pos;
+      tail = &((rs_slab_block_t*)pos)->next;
+      pos += cls->block_size;
+    };
+    *tail = nullptr;
+    cls->end = pos;
+  };
+  return slab;
+}
+
+void rs_slab_delete(rs_slab_t* slab)
+{
+  if (slab) {
+    for (uint8_t i = 0; i < RS_SLAB_CLASSES; i++) {
+      if (slab->classes[i].used > 0) {
+        rlog_e(tagSLAB, "Slab pool deleted with %d blocks of %d bytes in use", slab->classes[i].used, (int)slab->classes[i].block_size);
+      };
+    };
+    RS_LOCK_DEINIT(&slab->lock);
+    const rs_allocator_t* heap = rs_default_allocator();
+    heap->free(heap->ctx, slab);
+  };
+}
+
+static inline rs_slab_class_t* slabOwner(rs_slab_t* slab, const void* ptr)
+{
+  if (((const char*)ptr >= slab->begin) && ((const char*)ptr < slab->end)) {
+    for (uint8_t i = 0; i < RS_SLAB_CLASSES; i++) {
+      if ((const char*)ptr < slab->classes[i].end) return &slab->classes[i];
+    };
+  };
+  return nullptr;
+}
+
+static inline uint8_t slabIndex(size_t size)
+{
+  uint8_t index = 0;
+  while ((index < RS_SLAB_CLASSES) && (size > ((size_t)RS_SLAB_MIN_BLOCK << index))) index++;
+  return index;
+}
+
+// -----------------------------------------------------------------------------------------------------------------------
+// -------------------------------------------------- Allocator ----------------------------------------------------------
+// -----------------------------------------------------------------------------------------------------------------------
+
+static void* slab_alloc(void* ctx, size_t size)
+{
+  rs_slab_t* slab = (rs_slab_t*)ctx;
+  uint8_t index = slabIndex(size);
+  rs_slab_block_t* block = nullptr;
+  RS_LOCK(&slab->lock);
+  if (index < RS_SLAB_CLASSES) {
+    rs_slab_class_t* cls = &slab->classes[index];
+    block = cls->free;
+    if (block) {
+      cls->free = block->next;
+      cls->hits++;
+      if (++cls->used > cls->peak) cls->peak = cls->used;
+    } else {
+      cls->misses++;
+    };
+  } else {
+    slab->oversize++;
+  };
+  RS_UNLOCK(&slab->lock);
+  if (block) return block;
+  const rs_allocator_t* heap = rs_default_allocator();
+  return heap->alloc(heap->ctx, size);
+}
+
+static void slab_free(void* ctx, void* ptr)
+{
+  rs_slab_t* slab = (rs_slab_t*)ctx;
+  if (ptr == nullptr) return;
+  rs_slab_class_t* cls = slabOwner(slab, ptr);
+  if (cls) {
+    RS_LOCK(&slab->lock);
+    ((rs_slab_block_t*)ptr)->next = cls->free;
+    cls->free = (rs_slab_block_t*)ptr;
+    cls->used--;
+    RS_UNLOCK(&slab->lock);
+  } else {
+    const rs_allocator_t* heap = rs_default_allocator();
+    heap->free(heap->ctx, ptr);
+  };
+}
+
+static size_t slab_size(void* ctx, const void* ptr)
+{
+  rs_slab_t* slab = (rs_slab_t*)ctx;
+  rs_slab_class_t* cls = slabOwner(slab, ptr);
+  if (cls) return cls->block_size;
+  const rs_allocator_t* heap = rs_default_allocator();
+  return heap->size ? heap->size(heap->ctx, ptr) : 0;
+}
+
+static void* slab_realloc(void* ctx, void* ptr, size_t size)
+{
+  rs_slab_t* slab = (rs_slab_t*)ctx;
+  if (ptr == nullptr) return slab_alloc(ctx, size);
+  rs_slab_class_t* cls = slabOwner(slab, ptr);
+  if (cls == nullptr) {
+    // Heap blocks stay on the heap
+    const rs_allocator_t* heap = rs_default_allocator();
+    return heap->realloc(heap->ctx, ptr, size);
+  };
+  if (size <= cls->block_size) return ptr;
+  void* ret = slab_alloc(ctx, size);
+  if (ret) {
+    memcpy(ret, ptr, cls->block_size);
+    slab_free(ctx, ptr);
+  };
+  return ret;
+}
+
+void rs_slab_allocator(rs_slab_t* slab, rs_allocator_t* allocator)
+{
+  if (allocator) {
+    allocator->alloc = slab_alloc;
+    allocator->realloc = slab_realloc;
+    allocator->free = slab_free;
+    allocator->size = slab_size;
+    allocator->ctx = slab;
+  };
+}
+
+// -----------------------------------------------------------------------------------------------------------------------
+// --------------------------------------------------- Statistics --------------------------------------------------------
+// -----------------------------------------------------------------------------------------------------------------------
+
+bool rs_slab_get_stats(rs_slab_t* slab, uint8_t index, rs_slab_class_stats_t* stats)
+{
+  if ((slab == nullptr) || (stats == nullptr) || (index >= RS_SLAB_CLASSES)) return false;
+  RS_LOCK(&slab->lock);
+  const rs_slab_class_t* cls = &slab->classes[index];
+  stats->block_size = cls->block_size;
+  stats->capacity = cls->capacity;
+  stats->used = cls->used;
+  stats->peak = cls->peak;
+  stats->hits = cls->hits;
+  stats->misses = cls->misses;
+  RS_UNLOCK(&slab->lock);
+  return true;
+}
+
+uint32_t rs_slab_oversize(rs_slab_t* slab)
+{
+  return slab ? RS_ATOMIC_LOAD(&slab->oversize) : 0;
+}
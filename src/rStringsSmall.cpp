@@ -0,0 +1,190 @@
+#include "rStringsSmall.h"
+#include "rStringsTopicHeaders.h"
+#include "def_consts.h"
+#include "rLog.h"
+#include <stdio.h>
+#include <string.h>
+
+#if CONFIG_RLOG_PROJECT_LEVEL > RLOG_LEVEL_NONE
+static const char * tagRSTR = "RSTR";
+#endif // CONFIG_RLOG_PROJECT_LEVEL
+
+static_assert(sizeof(rstr_t) == RSTR_SIZE, "rstr_t must be RSTR_SIZE bytes");
+
+#define RSTR_TAG(s) ((uint8_t)(s)->bytes[RSTR_SIZE - 1])
+
+// -----------------------------------------------------------------------------------------------------------------------
+// ----------------------------------------------------- Storage ---------------------------------------------------------
+// -----------------------------------------------------------------------------------------------------------------------
+
+bool rstr_is_inline(const rstr_t* s)
+{
+  return RSTR_TAG(s) != RSTR_TAG_HEAP;
+}
+
+const char* rstr_c_str(const rstr_t* s)
+{
+  return rstr_is_inline(s) ? s->bytes : s->heap.data;
+}
+
+size_t rstr_len(const rstr_t* s)
+{
+  return rstr_is_inline(s) ? RSTR_TAG(s) : s->heap.len;
+}
+
+void rstr_init(rstr_t* s)
+{
+  memset(s, 0, sizeof(rstr_t));
+}
+
+void rstr_free(rstr_t* s)
+{
+  if (!rstr_is_inline(s)) rs_free(s->heap.data);
+  rstr_init(s);
+}
+
+// Prepares room for len characters (and a zero) and sets the length, the caller writes the characters
+static char* rstrPrepare(rstr_t* s, size_t len)
+{
+  rstr_free(s);
+  if (len <= RSTR_INLINE_MAX) {
+    s->bytes[len] = '\0';
+    s->bytes[RSTR_SIZE - 1] = (char)len;
+    return s->bytes;
+  };
+  char* data = (char*)rs_malloc(len + 1);
+  if (data == nullptr) {
+    rlog_e(tagRSTR, "Failed to create string: out of memory!");
+    return nullptr;
+  };
+  data[len] = '\0';
+  s->heap.data = data;
+  s->heap.len = len;
+  s->bytes[RSTR_SIZE - 1] = (char)RSTR_TAG_HEAP;
+  return data;
+}
+
+bool rstr_setl(rstr_t* s, const char* str, size_t len)
+{
+  if (str == nullptr) len = 0;
+  // The source may be a part of the string itself
+  if ((str >= s->bytes) && (str < s->bytes + RSTR_SIZE)) {
+    char copy[RSTR_SIZE];
+    memcpy(copy, str, len);
+    return rstr_setl(s, copy, len);
+  };
+  if (!rstr_is_inline(s) && (str >= s->heap.data) && (str <= s->heap.data + s->heap.len)) {
+    rstr_t old = *s;
+    rstr_init(s);
+    bool ret = rstr_setl(s, str, len);
+    rstr_free(&old);
+    return ret;
+  };
+  char* data = rstrPrepare(s, len);
+  if (data == nullptr) return false;
+  if (len > 0) memcpy(data, str, len);
+  return true;
+}
+
+bool rstr_set(rstr_t* s, const char* str)
+{
+  return rstr_setl(s, str, str ? strlen(str) : 0);
+}
+
+void rstr_move(rstr_t* dest, rstr_t* src)
+{
+  if (dest != src) {
+    rstr_free(dest);
+    *dest = *src;
+    rstr_init(src);
+  };
+}
+
+char* rstr_detach(rstr_t* s)
+{
+  char* ret;
+  if (rstr_is_inline(s)) {
+    size_t len = RSTR_TAG(s);
+    ret = (char*)rs_malloc(len + 1);
+    if (ret == nullptr) {
+      rlog_e(tagRSTR, "Failed to create string: out of memory!");
+    } else {
+      memcpy(ret, s->bytes, len + 1);
+    };
+  } else {
+    ret = s->heap.data;
+  };
+  rstr_init(s);
+  return ret;
+}
+
+// -----------------------------------------------------------------------------------------------------------------------
+// ----------------------------------------------------- Builders --------------------------------------------------------
+// -----------------------------------------------------------------------------------------------------------------------
+
+bool rstr_vformat(rstr_t* s, const char* format, va_list args)
+{
+  // The arguments may point into the string itself: the result is built aside and replaces it at the end
+  rstr_t result;
+  rstr_init(&result);
+  bool ret = format != nullptr;
+  if (ret) {
+    va_list args2;
+    va_copy(args2, args);
+    // Formatted once into the inline bytes, longer results a second time into a heap block of the exact size
+    int len = vsnprintf(result.bytes, RSTR_INLINE_MAX + 1, format, args);
+    ret = len >= 0;
+    if (!ret) {
+      rstr_init(&result);
+    } else if (len <= RSTR_INLINE_MAX) {
+      result.bytes[RSTR_SIZE - 1] = (char)len;
+    } else {
+      char* data = rstrPrepare(&result, len);
+      ret = data && (vsnprintf(data, len + 1, format, args2) == len);
+    };
+    va_end(args2);
+  };
+  rstr_move(s, &result);
+  return ret;
+}
+
+bool rstr_format(rstr_t* s, const char* format, ...)
+{
+  va_list args;
+  va_start(args, format);
+  bool ret = rstr_vformat(s, format, args);
+  va_end(args);
+  return ret;
+}
+
+bool rstr_time(rstr_t* s, const char* format, time_t value)
+{
+  char buffer[CONFIG_FORMAT_STRFTIME_BUFFER_SIZE];
+  size_t len = time2str(format, &value, buffer, sizeof(buffer));
+  return rstr_setl(s, buffer, len);
+}
+
+bool rstr_timespan(rstr_t* s, int64_t value, rs_timespan_unit_t unit, rs_timespan_style_t style)
+{
+  char buffer[RS_TIMESPAN_BUFFER_SIZE];
+  size_t len = timespan_to_str(value, unit, style, buffer, sizeof(buffer));
+  return rstr_setl(s, buffer, len);
+}
+
+bool rstr_topic(rstr_t* s, const bool primary, const bool local, const mqtt_header_t kind, const char *special,
+  const char * const *segments, const uint8_t count)
+{
+  // Segments may point into the string itself, as in rstr_vformat()
+  rstr_t result;
+  rstr_init(&result);
+  char* data = nullptr;
+  if ((segments != nullptr) || (count == 0)) {
+    const topic_headers_t* headers = topicHeadersAcquire();
+    const topic_header_t* header = &headers->items[topicHeaderIndex(primary, local, kind)];
+    data = rstrPrepare(&result, topicLength(header, special, segments, count));
+    if (data) topicWrite(data, header, special, segments, count);
+    topicHeadersRelease(headers);
+  };
+  rstr_move(s, &result);
+  return data != nullptr;
+}
@@ -0,0 +1,257 @@
+#include "rStringsAlloc.h"
+#include "rStringsPort.h"
+#include "rLog.h"
+#include <string.h>
+
+#if CONFIG_RLOG_PROJECT_LEVEL > RLOG_LEVEL_NONE
+static const char * tagTCACHE = "TCACHE";
+#endif // CONFIG_RLOG_PROJECT_LEVEL
+
+// Free blocks are linked through their first bytes
+typedef struct tcache_block_t {
+  struct tcache_block_t* next;
+} tcache_block_t;
+
+typedef struct {
+  tcache_block_t* head;
+  uint16_t        count;
+} tcache_bin_t;
+
+// Lists of one task, the size classes are the same as in the slab pool. Counters are added to the shared ones
+// every TCACHE_PUBLISH operations, so that tasks on different cores do not fight for one cache line
+#define TCACHE_PUBLISH 64
+
+typedef struct {
+  rs_tcache_t*    owner;
+  tcache_bin_t    bins[RS_SLAB_CLASSES];
+  uint32_t        hits;
+  uint32_t        misses;
+  uint32_t        overflows;
+  int32_t         cached;
+  uint8_t         pending;
+} tcache_local_t;
+
+struct rs_tcache_t {
+  const rs_allocator_t* backend;
+  rs_tls_key_t          key;
+  uint16_t              limit;
+  uint32_t              hits;
+  uint32_t              misses;
+  uint32_t              overflows;
+  uint32_t              cached;
+};
+
+// -----------------------------------------------------------------------------------------------------------------------
+// -------------------------------------------------- Task lists ---------------------------------------------------------
+// -----------------------------------------------------------------------------------------------------------------------
+
+static void tcachePublish(tcache_local_t* local)
+{
+  rs_tcache_t* tcache = local->owner;
+  if (local->hits) RS_ATOMIC_ADD(&tcache->hits, local->hits);
+  if (local->misses) RS_ATOMIC_ADD(&tcache->misses, local->misses);
+  if (local->overflows) RS_ATOMIC_ADD(&tcache->overflows, local->overflows);
+  if (local->cached) RS_ATOMIC_ADD(&tcache->cached, (uint32_t)local->cached);
+  local->hits = 0;
+  local->misses = 0;
+  local->overflows = 0;
+  local->cached = 0;
+  local->pending = 0;
+}
+
+static inline void tcacheCounted(tcache_local_t* local)
+{
+  if (++local->pending >= TCACHE_PUBLISH) tcachePublish(local);
+}
+
+// Returns all blocks of the task to the backend
+static void tcacheRelease(tcache_local_t* local)
+{
+  const rs_allocator_t* backend = local->owner->backend;
+  for (uint8_t i = 0; i < RS_SLAB_CLASSES; i++) {
+    tcache_block_t* block = local->bins[i].head;
+    while (block) {
+      tcache_block_t* next = block->next;
+      backend->free(backend->ctx, block);
+      block = next;
+    };
+    local->cached -= local->bins[i].count;
+    local->bins[i].head = nullptr;
+    local->bins[i].count = 0;
+  };
+  tcachePublish(local);
+}
+
+// Called when a task exits
+static void tcacheDestructor(void* value)
+{
+  tcache_local_t* local = (tcache_local_t*)value;
+  if (local) {
+    const rs_allocator_t* backend = local->owner->backend;
+    tcacheRelease(local);
+    backend->free(backend->ctx, local);
+  };
+}
+
+static tcache_local_t* tcacheLocal(rs_tcache_t* tcache)
+{
+  tcache_local_t* local = (tcache_local_t*)RS_TLS_GET(&tcache->key);
+  if (local == nullptr) {
+    local = (tcache_local_t*)tcache->backend->alloc(tcache->backend->ctx, sizeof(tcache_local_t));
+    if (local) {
+      memset(local, 0, sizeof(tcache_local_t));
+      local->owner = tcache;
+      RS_TLS_SET(&tcache->key, local);
+    };
+  };
+  return local;
+}
+
+// The smallest class that holds size
+static inline uint8_t tcacheIndex(size_t size)
+{
+  uint8_t index = 0;
+  while ((index < RS_SLAB_CLASSES) && (size > ((size_t)RS_SLAB_MIN_BLOCK << index))) index++;
+  return index;
+}
+
+// -----------------------------------------------------------------------------------------------------------------------
+// -------------------------------------------------- Allocator ----------------------------------------------------------
+// -----------------------------------------------------------------------------------------------------------------------
+
+static void* tcache_alloc(void* ctx, size_t size)
+{
+  rs_tcache_t* tcache = (rs_tcache_t*)ctx;
+  const rs_allocator_t* backend = tcache->backend;
+  uint8_t index = tcacheIndex(size);
+  tcache_local_t* local = nullptr;
+  if ((index < RS_SLAB_CLASSES) && backend->size) {
+    local = tcacheLocal(tcache);
+    if (local && local->bins[index].head) {
+      tcache_block_t* block = local->bins[index].head;
+      local->bins[index].head = block->next;
+      local->bins[index].count--;
+      local->cached--;
+      local->hits++;
+      tcacheCounted(local);
+      return block;
+    };
+    // Rounded up to the class, so that the block can be reused for any request of the class
+    size = (size_t)RS_SLAB_MIN_BLOCK << index;
+  };
+  if (local) {
+    local->misses++;
+    tcacheCounted(local);
+  } else {
+    RS_ATOMIC_ADD(&tcache->misses, (uint32_t)1);
+  };
+  return backend->alloc(backend->ctx, size);
+}
+
+static void tcache_free(void* ctx, void* ptr)
+{
+  rs_tcache_t* tcache = (rs_tcache_t*)ctx;
+  const rs_allocator_t* backend = tcache->backend;
+  if (ptr == nullptr) return;
+  size_t usable = backend->size ? backend->size(backend->ctx, ptr) : 0;
+  // Blocks are kept in the largest class they can serve, larger blocks go back to the backend
+  if ((usable >= RS_SLAB_MIN_BLOCK) && (usable < ((size_t)RS_SLAB_MIN_BLOCK << RS_SLAB_CLASSES))) {
+    uint8_t index = 0;
+    while ((index + 1 < RS_SLAB_CLASSES) && (usable >= ((size_t)RS_SLAB_MIN_BLOCK << (index + 1)))) index++;
+    tcache_local_t* local = tcacheLocal(tcache);
+    if (local && (local->bins[index].count < tcache->limit)) {
+      ((tcache_block_t*)ptr)->next = local->bins[index].head;
+      local->bins[index].head = (tcache_block_t*)ptr;
+      local->bins[index].count++;
+      local->cached++;
+      tcacheCounted(local);
+      return;
+    };
+    if (local) {
+      local->overflows++;
+      tcacheCounted(local);
+    };
+  };
+  backend->free(backend->ctx, ptr);
+}
+
+static void* tcache_realloc(void* ctx, void* ptr, size_t size)
+{
+  rs_tcache_t* tcache = (rs_tcache_t*)ctx;
+  if (ptr == nullptr) return tcache_alloc(ctx, size);
+  // Cached blocks are ordinary backend blocks
+  return tcache->backend->realloc(tcache->backend->ctx, ptr, size);
+}
+
+static size_t tcache_size(void* ctx, const void* ptr)
+{
+  rs_tcache_t* tcache = (rs_tcache_t*)ctx;
+  return tcache->backend->size ? tcache->backend->size(tcache->backend->ctx, ptr) : 0;
+}
+
+// -----------------------------------------------------------------------------------------------------------------------
+// ---------------------------------------------------- Cache ------------------------------------------------------------
+// -----------------------------------------------------------------------------------------------------------------------
+
+rs_tcache_t* rs_tcache_create(const rs_allocator_t* backend, uint16_t limit)
+{
+  if (backend == nullptr) backend = rs_default_allocator();
+  const rs_allocator_t* heap = rs_default_allocator();
+  rs_tcache_t* tcache = (rs_tcache_t*)heap->alloc(heap->ctx, sizeof(rs_tcache_t));
+  if (tcache == nullptr) {
+    rlog_e(tagTCACHE, "Failed to create task cache: out of memory!");
+    return nullptr;
+  };
+  memset(tcache, 0, sizeof(rs_tcache_t));
+  if (!RS_TLS_CREATE(&tcache->key, tcacheDestructor)) {
+    rlog_e(tagTCACHE, "Failed to create task cache: no free task storage keys");
+    heap->free(heap->ctx, tcache);
+    return nullptr;
+  };
+  tcache->backend = backend;
+  tcache->limit = limit;
+  return tcache;
+}
+
+void rs_tcache_flush(rs_tcache_t* tcache)
+{
+  if (tcache) {
+    tcache_local_t* local = (tcache_local_t*)RS_TLS_GET(&tcache->key);
+    if (local) tcacheRelease(local);
+  };
+}
+
+void rs_tcache_delete(rs_tcache_t* tcache)
+{
+  if (tcache) {
+    tcacheDestructor(RS_TLS_GET(&tcache->key));
+    RS_TLS_SET(&tcache->key, nullptr);
+    RS_TLS_DELETE(&tcache->key);
+    if (RS_ATOMIC_LOAD(&tcache->cached) > 0) {
+      rlog_e(tagTCACHE, "Task cache deleted with %d blocks cached by other tasks", (int)tcache->cached);
+    };
+    const rs_allocator_t* heap = rs_default_allocator();
+    heap->free(heap->ctx, tcache);
+  };
+}
+
+void rs_tcache_allocator(rs_tcache_t* tcache, rs_allocator_t* allocator)
+{
+  if (allocator) {
+    allocator->alloc = tcache_alloc;
+    allocator->realloc = tcache_realloc;
+    allocator->free = tcache_free;
+    allocator->size = tcache_size;
+    allocator->ctx = tcache;
+  };
+}
+
+void rs_tcache_get_stats(rs_tcache_t* tcache, rs_tcache_stats_t* stats)
+{
+  if (tcache && stats) {
+    stats->hits = RS_ATOMIC_LOAD(&tcache->hits);
+    stats->misses = RS_ATOMIC_LOAD(&tcache->misses);
+    stats->overflows = RS_ATOMIC_LOAD(&tcache->overflows);
+    stats->cached = RS_ATOMIC_LOAD(&tcache->cached);
+  };
+}
@@ -0,0 +1,329 @@
+#include "rStringsTemplate.h"
+#include "rLog.h"
+#include <string.h>
+
+#if CONFIG_RLOG_PROJECT_LEVEL > RLOG_LEVEL_NONE
+static const char * tagTEMPLATE = "TEMPLATE";
+#endif // CONFIG_RLOG_PROJECT_LEVEL
+
+#define TEMPLATE_LITERAL 0xFF
+
+// A literal (text of the pool) or a placeholder (index of the name)
+typedef struct {
+  uint32_t offset;
+  uint32_t len;
+  uint8_t  arg;
+} template_segment_t;
+
+typedef struct {
+  uint32_t offset;
+  uint32_t len;
+} template_name_t;
+
+// One heap block: this header, segments, names and the pool with literals and zero terminated names
+struct rs_template_t {
+  size_t              literal_len;
+  uint16_t            count;
+  uint8_t             args;
+  template_segment_t* items;
+  template_name_t*    names;
+  char*               pool;
+};
+
+// -----------------------------------------------------------------------------------------------------------------------
+// ---------------------------------------------------- Compiling --------------------------------------------------------
+// -----------------------------------------------------------------------------------------------------------------------
+
+// First pass: syntax check and the number of segments and placeholders
+static bool templateMeasure(const char* text, size_t* segments, size_t* placeholders)
+{
+  bool literal = false;
+  *segments = 0;
+  *placeholders = 0;
+  const char* pos = text;
+  while (*pos) {
+    if ((pos[0] == '$') && (pos[1] == '{')) {
+      const char* close = strchr(pos + 2, '}');
+      if (close == nullptr) {
+        rlog_e(tagTEMPLATE, "Template \"%s\": \"${\" without \"}\" at %d", text, (int)(pos - text));
+        return false;
+      };
+      if (close == pos + 2) {
+        rlog_e(tagTEMPLATE, "Template \"%s\": empty name at %d", text, (int)(pos - text));
+        return false;
+      };
+      (*segments)++;
+      (*placeholders)++;
+      literal = false;
+      pos = close + 1;
+    } else {
+      if (!literal) (*segments)++;
+      literal = true;
+      pos += ((pos[0] == '$') && (pos[1] == '$')) ? 2 : 1;
+    };
+  };
+  if (*segments > UINT16_MAX) {
+    rlog_e(tagTEMPLATE, "Template \"%.16s...\": too many segments", text);
+    return false;
+  };
+  return true;
+}
+
+// Second pass: filling the segments, repeated names share one argument
+static bool templateFill(rs_template_t* tpl, const char* text)
+{
+  size_t used = 0;
+  template_segment_t* last = nullptr;
+  const char* pos = text;
+  while (*pos) {
+    if ((pos[0] == '$') && (pos[1] == '{')) {
+      const char* name = pos + 2;
+      size_t len = strchr(name, '}') - name;
+      uint8_t arg = 0;
+      while ((arg < tpl->args) && ((tpl->names[arg].len != len) || (memcmp(tpl->pool + tpl->names[arg].offset, name, len) != 0))) arg++;
+      if (arg == tpl->args) {
+        if (tpl->args == RS_TEMPLATE_MAX_ARGS) {
+          rlog_e(tagTEMPLATE, "Template \"%.16s...\": more than %d different names", text, RS_TEMPLATE_MAX_ARGS);
+          return false;
+        };
+        tpl->names[arg].offset = used;
+        tpl->names[arg].len = len;
+        memcpy(tpl->pool + used, name, len);
+        tpl->pool[used + len] = '\0';
+        used += len + 1;
+        tpl->args++;
+      };
+      last = &tpl->items[tpl->count++];
+      last->offset = 0;
+      last->len = 0;
+      last->arg = arg;
+      pos = name + len + 1;
+    } else {
+      if ((last == nullptr) || (last->arg != TEMPLATE_LITERAL)) {
+        last = &tpl->items[tpl->count++];
+        last->offset = used;
+        last->len = 0;
+        last->arg = TEMPLATE_LITERAL;
+      };
+      tpl->pool[used++] = pos[0];
+      last->len++;
+      tpl->literal_len++;
+      pos += ((pos[0] == '$') && (pos[1] == '$')) ? 2 : 1;
+    };
+  };
+  return true;
+}
+
+rs_template_t* rs_template_compile(const char* text)
+{
+  if (text == nullptr) return nullptr;
+  size_t segments, placeholders;
+  if (!templateMeasure(text, &segments, &placeholders)) return nullptr;
+  size_t names = placeholders < RS_TEMPLATE_MAX_ARGS ? placeholders : RS_TEMPLATE_MAX_ARGS;
+  // The pool is never longer than the source: "${name}" becomes "name" + zero, "$$" becomes "$"
+  size_t size = sizeof(rs_template_t) + segments * sizeof(template_segment_t) + names * sizeof(template_name_t) + strlen(text) + 1;
+  rs_template_t* tpl = (rs_template_t*)rs_malloc(size);
+  if (tpl == nullptr) {
+    rlog_e(tagTEMPLATE, "Failed to compile template: out of memory!");
+    return nullptr;
+  };
+  memset(tpl, 0, sizeof(rs_template_t));
+  tpl->items = (template_segment_t*)(tpl + 1);
+  tpl->names = (template_name_t*)(tpl->items + segments);
+  tpl->pool = (char*)(tpl->names + names);
+  if (!templateFill(tpl, text)) {
+    rs_free(tpl);
+    return nullptr;
+  };
+  return tpl;
+}
+
+void rs_template_free(rs_template_t* tpl)
+{
+  rs_free(tpl);
+}
+
+uint8_t rs_template_arg_count(const rs_template_t* tpl)
+{
+  return tpl ? tpl->args : 0;
+}
+
+const char* rs_template_arg_name(const rs_template_t* tpl, uint8_t index)
+{
+  return (tpl && (index < tpl->args)) ? tpl->pool + tpl->names[index].offset : nullptr;
+}
+
+int rs_template_arg_index(const rs_template_t* tpl, const char* name)
+{
+  if (tpl && name) {
+    for (uint8_t i = 0; i < tpl->args; i++) {
+      if (strcmp(tpl->pool + tpl->names[i].offset, name) == 0) return i;
+    };
+  };
+  return -1;
+}
+
+// -----------------------------------------------------------------------------------------------------------------------
+// ---------------------------------------------------- Rendering --------------------------------------------------------
+// -----------------------------------------------------------------------------------------------------------------------
+
+// Values of all arguments with their lengths, measured once per render
+typedef struct {
+  const char* value[RS_TEMPLATE_MAX_ARGS];
+  size_t      len[RS_TEMPLATE_MAX_ARGS];
+  size_t      total;
+} template_values_t;
+
+static void templateMeasureValues(const rs_template_t* tpl, template_values_t* values)
+{
+  for (uint8_t i = 0; i < tpl->args; i++) {
+    values->len[i] = values->value[i] ? strlen(values->value[i]) : 0;
+  };
+  values->total = tpl->literal_len;
+  for (uint16_t i = 0; i < tpl->count; i++) {
+    if (tpl->items[i].arg != TEMPLATE_LITERAL) values->total += values->len[tpl->items[i].arg];
+  };
+}
+
+static void templateArgs(const rs_template_t* tpl, const char* const* args, size_t count, template_values_t* values)
+{
+  for (uint8_t i = 0; i < tpl->args; i++) {
+    values->value[i] = (args && (i < count)) ? args[i] : nullptr;
+  };
+  templateMeasureValues(tpl, values);
+}
+
+static void templateVars(const rs_template_t* tpl, const rs_template_var_t* vars, size_t count, template_values_t* values)
+{
+  for (uint8_t i = 0; i < tpl->args; i++) {
+    const char* name = tpl->pool + tpl->names[i].offset;
+    values->value[i] = nullptr;
+    for (size_t j = 0; vars && (j < count); j++) {
+      if (vars[j].name && (strcmp(vars[j].name, name) == 0)) {
+        values->value[i] = vars[j].value;
+        break;
+      };
+    };
+  };
+  templateMeasureValues(tpl, values);
+}
+
+// The buffer must hold values->total + 1 bytes
+static void templateWrite(const rs_template_t* tpl, const template_values_t* values, char* buffer)
+{
+  char* pos = buffer;
+  for (uint16_t i = 0; i < tpl->count; i++) {
+    const template_segment_t* item = &tpl->items[i];
+    if (item->arg == TEMPLATE_LITERAL) {
+      memcpy(pos, tpl->pool + item->offset, item->len);
+      pos += item->len;
+    } else if (values->len[item->arg] > 0) {
+      memcpy(pos, values->value[item->arg], values->len[item->arg]);
+      pos += values->len[item->arg];
+    };
+  };
+  *pos = '\0';
+}
+
+static char* templateRender(const rs_template_t* tpl, const template_values_t* values)
+{
+  char* ret = (char*)rs_malloc(values->total + 1);
+  if (ret) {
+    templateWrite(tpl, values, ret);
+  } else {
+    rlog_e(tagTEMPLATE, "Failed to render template: out of memory!");
+  };
+  return ret;
+}
+
+static size_t templateFormat(const rs_template_t* tpl, const template_values_t* values, char* buffer, size_t buffer_size)
+{
+  if (values->total + 1 > buffer_size) {
+    rlog_e(tagTEMPLATE, "Buffer %d bytes too small to hold template, %d bytes needed", (int)buffer_size, (int)(values->total + 1));
+    return 0;
+  };
+  templateWrite(tpl, values, buffer);
+  return values->total;
+}
+
+static bool templateSink(rs_sink_t* sink, const rs_template_t* tpl, const template_values_t* values)
+{
+  bool ret = true;
+  for (uint16_t i = 0; ret && (i < tpl->count); i++) {
+    const template_segment_t* item = &tpl->items[i];
+    if (item->arg == TEMPLATE_LITERAL) {
+      ret = sink_write(sink, tpl->pool + item->offset, item->len);
+    } else {
+      ret = sink_write(sink, values->value[item->arg], values->len[item->arg]);
+    };
+  };
+  return ret;
+}
+
+size_t rs_template_length_args(const rs_template_t* tpl, const char* const* args, size_t count)
+{
+  if (tpl == nullptr) return 0;
+  template_values_t values;
+  templateArgs(tpl, args, count, &values);
+  return values.total;
+}
+
+char* rs_template_render_args(const rs_template_t* tpl, const char* const* args, size_t count)
+{
+  if (tpl == nullptr) return nullptr;
+  template_values_t values;
+  templateArgs(tpl, args, count, &values);
+  return templateRender(tpl, &values);
+}
+
+size_t rs_template_format_args(const rs_template_t* tpl, const char* const* args, size_t count, char* buffer, size_t buffer_size)
+{
+  if ((buffer == nullptr) || (buffer_size == 0)) return 0;
+  buffer[0] = '\0';
+  if (tpl == nullptr) return 0;
+  template_values_t values;
+  templateArgs(tpl, args, count, &values);
+  return templateFormat(tpl, &values, buffer, buffer_size);
+}
+
+bool rs_template_sink_args(rs_sink_t* sink, const rs_template_t* tpl, const char* const* args, size_t count)
+{
+  if ((sink == nullptr) || (tpl == nullptr)) return false;
+  template_values_t values;
+  templateArgs(tpl, args, count, &values);
+  return templateSink(sink, tpl, &values);
+}
+
+size_t rs_template_length_vars(const rs_template_t* tpl, const rs_template_var_t* vars, size_t count)
+{
+  if (tpl == nullptr) return 0;
+  template_values_t values;
+  templateVars(tpl, vars, count, &values);
+  return values.total;
+}
+
+char* rs_template_render_vars(const rs_template_t* tpl, const rs_template_var_t* vars, size_t count)
+{
+  if (tpl == nullptr) return nullptr;
+  template_values_t values;
+  templateVars(tpl, vars, count, &values);
+  return templateRender(tpl, &values);
+}
+
+size_t rs_template_format_vars(const rs_template_t* tpl, const rs_template_var_t* vars, size_t count, char* buffer, size_t buffer_size)
+{
+  if ((buffer == nullptr) || (buffer_size == 0)) return 0;
+  buffer[0] = '\0';
+  if (tpl == nullptr) return 0;
+  template_values_t values;
+  templateVars(tpl, vars, count, &values);
+  return templateFormat(tpl, &values, buffer, buffer_size);
+}
+
+bool rs_template_sink_vars(rs_sink_t* sink, const rs_template_t* tpl, const rs_template_var_t* vars, size_t count)
+{
+  if ((sink == nullptr) || (tpl == nullptr)) return false;
+  template_values_t values;
+  templateVars(tpl, vars, count, &values);
+  return templateSink(sink, tpl, &values);
+}
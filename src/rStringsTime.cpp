@@ -0,0 +1,724 @@
+#include "rStringsTime.h"
+#include "rStringsConfig.h"
+#include "def_consts.h"
+#include "rStringsPort.h"
+#include <string.h>
+
+// -----------------------------------------------------------------------------------------------------------------------
+// ---------------------------------------------------- Format analysis --------------------------------------------------
+// -----------------------------------------------------------------------------------------------------------------------
+
+#define TIME_PATCH_MAX 2
+
+typedef struct {
+  uint8_t posM[TIME_PATCH_MAX];
+  uint8_t posS[TIME_PATCH_MAX];
+  uint8_t countM;
+  uint8_t countS;
+} time_patch_t;
+
+// Two digits of value are at text[pos]
+static inline bool digitsAt(const char *text, size_t len, size_t pos, int value)
+{
+  return (pos + 2 <= len) && (text[pos] == '0' + value / 10) && (text[pos + 1] == '0' + value % 10);
+}
+
+static bool patchAdd(uint8_t *list, uint8_t *count, size_t pos)
+{
+  if ((*count >= TIME_PATCH_MAX) || (pos > UINT8_MAX)) return false;
+  list[(*count)++] = (uint8_t)pos;
+  return true;
+}
+
+/**
+ * Finds the minutes and seconds digits in the text rendered from format and timeinfo. Every specifier is rendered
+ * alone to learn its width, so the result does not depend on the locale. Returns false if the text depends on the
+ * minutes or seconds in any other way (%s, %c, %X, modifiers and flags) - such formats are rendered every time
+ * */
+static bool patchAnalyze(const char *format, const struct tm *timeinfo, const char *text, size_t len, time_patch_t *patch)
+{
+  memset(patch, 0, sizeof(time_patch_t));
+  char piece[CONFIG_RSTRINGS_TIME_CACHE_LENGTH + 1];
+  char spec[3] = { '%', 0, 0 };
+  size_t pos = 0;
+  for (const char *fmt = format; *fmt; fmt++) {
+    if (*fmt != '%') {
+      pos++;
+      continue;
+    };
+    spec[1] = *++fmt;
+    switch (spec[1]) {
+      // Hour-stable specifiers
+      case '%': case 'a': case 'A': case 'b': case 'B': case 'C': case 'd': case 'D': case 'e': case 'F':
+      case 'g': case 'G': case 'h': case 'H': case 'I': case 'j': case 'k': case 'l': case 'm': case 'n':
+      case 'p': case 'P': case 't': case 'u': case 'U': case 'V': case 'w': case 'W': case 'x': case 'y':
+      case 'Y': case 'z': case 'Z':
+        pos += strftime(piece, sizeof(piece), spec, timeinfo);
+        break;
+      case 'M':
+        if (!digitsAt(text, len, pos, timeinfo->tm_min) || !patchAdd(patch->posM, &patch->countM, pos)) return false;
+        pos += 2;
+        break;
+      case 'S':
+        if (!digitsAt(text, len, pos, timeinfo->tm_sec) || !patchAdd(patch->posS, &patch->countS, pos)) return false;
+        pos += 2;
+        break;
+      // HH:MM, HH:MM:SS, II:MM:SS pp
+      case 'R': case 'T': case 'r':
+        if (!digitsAt(text, len, pos + 3, timeinfo->tm_min) || !patchAdd(patch->posM, &patch->countM, pos + 3)) return false;
+        if (spec[1] != 'R') {
+          if (!digitsAt(text, len, pos + 6, timeinfo->tm_sec) || !patchAdd(patch->posS, &patch->countS, pos + 6)) return false;
+        };
+        pos += strftime(piece, sizeof(piece), spec, timeinfo);
+        break;
+      default:
+        return false;
+    };
+    if (pos > len) return false;
+  };
+  return pos == len;
+}
+
+// -----------------------------------------------------------------------------------------------------------------------
+// -------------------------------------------------- Time zone table ----------------------------------------------------
+// -----------------------------------------------------------------------------------------------------------------------
+
+#if defined(__GLIBC__) && defined(__USE_MISC)
+  #define RS_TM_ZONE 1                    // struct tm has tm_gmtoff and tm_zone, strftime %z and %Z use them
+#else
+  #define RS_TM_ZONE 0
+#endif
+
+typedef struct {
+  time_t at;                              // First second with this offset
+  int32_t offset;                         // Local time - UTC, seconds
+  int8_t isdst;
+  #if RS_TM_ZONE
+  const char *zone;
+  #endif // RS_TM_ZONE
+} tz_period_t;
+
+// Two tables: the writer fills the unused one and switches _tzCurrent, seq is odd while a table is being written
+typedef struct {
+  uint32_t seq;
+  time_t until;                           // End of the window
+  uint8_t count;
+  tz_period_t periods[CONFIG_RSTRINGS_TZ_TRANSITIONS + 1];
+} tz_table_t;
+
+static tz_table_t _tzTables[2];
+static int8_t _tzCurrent = -1;
+static rs_lock_t _tzLock = RS_LOCK_INITIALIZER;
+
+// Days since 01.01.1970 of the civil date (proleptic Gregorian calendar)
+static int64_t daysFromCivil(int64_t y, int m, int d)
+{
+  y -= m <= 2;
+  int64_t era = (y >= 0 ? y : y - 399) / 400;
+  int64_t yoe = y - era * 400;
+  int64_t doy = (153 * (m + (m > 2 ? -3 : 9)) + 2) / 5 + d - 1;
+  int64_t doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+  return era * 146097 + doe - 719468;
+}
+
+static void civilFromDays(int64_t z, int64_t *y, int *m, int *d)
+{
+  z += 719468;
+  int64_t era = (z >= 0 ? z : z - 146096) / 146097;
+  int64_t doe = z - era * 146097;
+  int64_t yoe = (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365;
+  int64_t doy = doe - (365 * yoe + yoe / 4 - yoe / 100);
+  int64_t mp = (5 * doy + 2) / 153;
+  *d = (int)(doy - (153 * mp + 2) / 5 + 1);
+  *m = (int)(mp < 10 ? mp + 3 : mp - 9);
+  *y = yoe + era * 400 + (*m <= 2);
+}
+
+// Offset of the local time at value, obtained from localtime_r
+static void tzProbe(time_t value, tz_period_t *period)
+{
+  struct tm timeinfo;
+  localtime_r(&value, &timeinfo);
+  int64_t local = daysFromCivil(timeinfo.tm_year + 1900LL, timeinfo.tm_mon + 1, timeinfo.tm_mday) * 86400
+    + timeinfo.tm_hour * 3600 + timeinfo.tm_min * 60 + timeinfo.tm_sec;
+  period->at = value;
+  period->offset = (int32_t)(local - (int64_t)value);
+  period->isdst = (int8_t)timeinfo.tm_isdst;
+  #if RS_TM_ZONE
+  period->zone = timeinfo.tm_zone;
+  #endif // RS_TM_ZONE
+}
+
+static inline bool tzSame(const tz_period_t *a, const tz_period_t *b)
+{
+  return (a->offset == b->offset) && (a->isdst == b->isdst);
+}
+
+bool rs_tz_update(time_t now)
+{
+  if (now == 0) now = time(nullptr);
+  // Daily steps find the days with transitions, a binary search finds the second
+  tz_table_t table;
+  time_t from = now - 86400;
+  table.until = from + (time_t)(CONFIG_RSTRINGS_TZ_WINDOW_DAYS + 1) * 86400;
+  table.count = 1;
+  tzProbe(from, &table.periods[0]);
+  tz_period_t next;
+  for (time_t day = from + 86400; ; day += 86400) {
+    if (day > table.until) day = table.until;
+    tzProbe(day, &next);
+    if (!tzSame(&table.periods[table.count - 1], &next)) {
+      if (table.count > CONFIG_RSTRINGS_TZ_TRANSITIONS) {
+        rs_tz_invalidate();
+        return false;
+      };
+      time_t lo = day - 86400;
+      time_t hi = day;
+      while (hi - lo > 1) {
+        time_t mid = lo + (hi - lo) / 2;
+        tz_period_t probe;
+        tzProbe(mid, &probe);
+        if (tzSame(&table.periods[table.count - 1], &probe)) lo = mid; else hi = mid;
+      };
+      tzProbe(hi, &table.periods[table.count++]);
+    };
+    if (day >= table.until) break;
+  };
+
+  RS_LOCK(&_tzLock);
+  int8_t target = RS_ATOMIC_LOAD(&_tzCurrent) == 0 ? 1 : 0;
+  tz_table_t *slot = &_tzTables[target];
+  uint32_t seq = slot->seq;
+  RS_ATOMIC_STORE(&slot->seq, seq + 1);
+  RS_ATOMIC_FENCE();
+  slot->until = table.until;
+  slot->count = table.count;
+  memcpy(slot->periods, table.periods, sizeof(tz_period_t) * table.count);
+  RS_ATOMIC_STORE(&slot->seq, seq + 2);
+  RS_ATOMIC_STORE(&_tzCurrent, target);
+  RS_UNLOCK(&_tzLock);
+
+  time2str_cache_reset();
+  return true;
+}
+
+void rs_tz_invalidate(void)
+{
+  RS_ATOMIC_STORE(&_tzCurrent, (int8_t)-1);
+  time2str_cache_reset();
+}
+
+// Finds the offset of value in the current table, false - the value is outside the table or the table is changing
+static bool tzLookup(time_t value, tz_period_t *period)
+{
+  int8_t current = RS_ATOMIC_LOAD(&_tzCurrent);
+  if (current < 0) return false;
+  const tz_table_t *table = &_tzTables[current];
+  uint32_t seq = RS_ATOMIC_LOAD(&table->seq);
+  if (seq & 1) return false;
+  bool found = false;
+  uint8_t count = table->count;
+  if ((count > 0) && (count <= CONFIG_RSTRINGS_TZ_TRANSITIONS + 1) && (value >= table->periods[0].at) && (value < table->until)) {
+    uint8_t i = count - 1;
+    while (value < table->periods[i].at) i--;
+    *period = table->periods[i];
+    found = true;
+  };
+  RS_ATOMIC_FENCE();
+  return found && (RS_ATOMIC_LOAD(&table->seq) == seq);
+}
+
+struct tm* rs_localtime_r(const time_t* value, struct tm* result)
+{
+  if ((value == nullptr) || (result == nullptr)) return nullptr;
+  tz_period_t period;
+  if (!tzLookup(*value, &period)) {
+    return localtime_r(value, result);
+  };
+  int64_t local = (int64_t)*value + period.offset;
+  int64_t days = local / 86400;
+  int64_t secs = local % 86400;
+  if (secs < 0) {
+    secs += 86400;
+    days--;
+  };
+  int64_t year;
+  int month, day;
+  civilFromDays(days, &year, &month, &day);
+  memset(result, 0, sizeof(struct tm));
+  result->tm_sec = (int)(secs % 60);
+  result->tm_min = (int)(secs / 60 % 60);
+  result->tm_hour = (int)(secs / 3600);
+  result->tm_mday = day;
+  result->tm_mon = month - 1;
+  result->tm_year = (int)(year - 1900);
+  result->tm_wday = (int)(((days % 7) + 11) % 7);  // 01.01.1970 is Thursday
+  result->tm_yday = (int)(days - daysFromCivil(year, 1, 1));
+  result->tm_isdst = period.isdst;
+  #if RS_TM_ZONE
+  result->tm_gmtoff = period.offset;
+  result->tm_zone = period.zone;
+  #endif // RS_TM_ZONE
+  return result;
+}
+
+// -----------------------------------------------------------------------------------------------------------------------
+// ------------------------------------------------------ Time cache -----------------------------------------------------
+// -----------------------------------------------------------------------------------------------------------------------
+
+#if CONFIG_RSTRINGS_TIME_CACHE_SLOTS > 0
+
+typedef struct {
+  char format[CONFIG_RSTRINGS_TIME_CACHE_LENGTH + 1];
+  char text[CONFIG_RSTRINGS_TIME_CACHE_LENGTH + 1];
+  struct tm timeinfo;                     // Local time of the first rendering in this hour
+  time_t value;
+  time_t hour;                            // Time of the beginning of the local hour of value
+  uint32_t used;                          // Last use for replacement, 0 - empty slot
+  uint8_t length;
+  bool analyzed;                          // The format is analyzed for this hour (only when a patch is wanted)
+  bool patchable;
+  time_patch_t patch;
+} time_slot_t;
+
+// Copy of a slot for the analysis outside the lock
+typedef struct {
+  char text[CONFIG_RSTRINGS_TIME_CACHE_LENGTH + 1];
+  struct tm timeinfo;
+  time_t hour;
+  uint8_t length;
+} time_pending_t;
+
+static time_slot_t _timeSlots[CONFIG_RSTRINGS_TIME_CACHE_SLOTS];
+static rs_time_cache_stats_t _timeStats = { 0, 0, 0 };
+static uint32_t _timeTick = 0;
+static rs_lock_t _timeLock = RS_LOCK_INITIALIZER;
+
+static time_slot_t * timeSlotFind(const char *format)
+{
+  for (uint8_t i = 0; i < CONFIG_RSTRINGS_TIME_CACHE_SLOTS; i++) {
+    if ((_timeSlots[i].used > 0) && (strcmp(_timeSlots[i].format, format) == 0)) {
+      return &_timeSlots[i];
+    };
+  };
+  return nullptr;
+}
+
+static time_slot_t * timeSlotVictim()
+{
+  time_slot_t *victim = &_timeSlots[0];
+  for (uint8_t i = 1; i < CONFIG_RSTRINGS_TIME_CACHE_SLOTS; i++) {
+    if (_timeSlots[i].used < victim->used) victim = &_timeSlots[i];
+  };
+  return victim;
+}
+
+static inline void patchDigits(char *text, const uint8_t *list, uint8_t count, int value)
+{
+  for (uint8_t i = 0; i < count; i++) {
+    text[list[i]] = '0' + value / 10;
+    text[list[i] + 1] = '0' + value % 10;
+  };
+}
+
+typedef enum {
+  TIME_CACHE_MISS = 0,
+  TIME_CACHE_FOUND,
+  TIME_CACHE_OVERFLOW,
+  TIME_CACHE_PENDING                      // A patch is possible after the analysis of the format
+} time_cache_result_t;
+
+// Answers from the cache under the lock
+static time_cache_result_t timeCacheGet(const char *format, time_t value, char* buffer, size_t buffer_size, size_t *len, time_pending_t *pending)
+{
+  time_cache_result_t result = TIME_CACHE_MISS;
+  RS_LOCK(&_timeLock);
+  time_slot_t *slot = timeSlotFind(format);
+  if (slot) {
+    if (slot->value == value) {
+      _timeStats.hits++;
+      result = TIME_CACHE_FOUND;
+    } else if ((value >= slot->hour) && (value - slot->hour < 3600)) {
+      if (!slot->analyzed) {
+        memcpy(pending->text, slot->text, slot->length + 1);
+        pending->timeinfo = slot->timeinfo;
+        pending->hour = slot->hour;
+        pending->length = slot->length;
+        result = TIME_CACHE_PENDING;
+      } else if (slot->patchable) {
+        int offset = (int)(value - slot->hour);
+        patchDigits(slot->text, slot->patch.posM, slot->patch.countM, offset / 60);
+        patchDigits(slot->text, slot->patch.posS, slot->patch.countS, offset % 60);
+        slot->value = value;
+        _timeStats.patches++;
+        result = TIME_CACHE_FOUND;
+      };
+    };
+    if (result == TIME_CACHE_FOUND) {
+      slot->used = ++_timeTick;
+      if (slot->length < buffer_size) {
+        memcpy(buffer, slot->text, slot->length + 1);
+        *len = slot->length;
+      } else {
+        result = TIME_CACHE_OVERFLOW;
+      };
+    };
+  };
+  RS_UNLOCK(&_timeLock);
+  return result;
+}
+
+// Finds the positions of minutes and seconds outside the lock and stores them if the slot is still in the same hour
+static void timeCacheAnalyze(const char *format, const time_pending_t *pending)
+{
+  time_patch_t patch;
+  bool patchable = patchAnalyze(format, &pending->timeinfo, pending->text, pending->length, &patch);
+  if (patchable) {
+    // The local hour must really begin at hour: zones with half-hour transitions shift it
+    struct tm start;
+    rs_localtime_r(&pending->hour, &start);
+    patchable = (start.tm_hour == pending->timeinfo.tm_hour) && (start.tm_min == 0) && (start.tm_sec == 0);
+  };
+
+  RS_LOCK(&_timeLock);
+  time_slot_t *slot = timeSlotFind(format);
+  if (slot && !slot->analyzed && (slot->hour == pending->hour)) {
+    slot->analyzed = true;
+    slot->patchable = patchable;
+    slot->patch = patch;
+  };
+  RS_UNLOCK(&_timeLock);
+}
+
+// Stores the rendered text, len = 0 only counts the rendering
+static void timeCachePut(const char *format, size_t format_len, const struct tm *timeinfo, time_t value, const char *text, size_t len)
+{
+  time_t hour = value - (timeinfo->tm_min * 60 + timeinfo->tm_sec);
+  RS_LOCK(&_timeLock);
+  _timeStats.renders++;
+  if (len > 0) {
+    time_slot_t *slot = timeSlotFind(format);
+    if (!slot) {
+      slot = timeSlotVictim();
+      memcpy(slot->format, format, format_len + 1);
+    };
+    memcpy(slot->text, text, len + 1);
+    slot->timeinfo = *timeinfo;
+    slot->length = (uint8_t)len;
+    slot->value = value;
+    // The analysis of the previous rendering is valid for the same hour only
+    if (slot->hour != hour) {
+      slot->hour = hour;
+      slot->analyzed = false;
+    };
+    slot->used = ++_timeTick;
+  };
+  RS_UNLOCK(&_timeLock);
+}
+
+#endif // CONFIG_RSTRINGS_TIME_CACHE_SLOTS
+
+size_t time2str_cached(const char *format, time_t value, char* buffer, size_t buffer_size)
+{
+  if ((format == nullptr) || (buffer == nullptr) || (buffer_size == 0)) {
+    return 0;
+  };
+  buffer[0] = 0;
+
+  #if CONFIG_RSTRINGS_TIME_CACHE_SLOTS > 0
+    size_t format_len = strlen(format);
+    bool cacheable = format_len <= CONFIG_RSTRINGS_TIME_CACHE_LENGTH;
+    if (cacheable) {
+      size_t len = 0;
+      time_pending_t pending;
+      time_cache_result_t result = timeCacheGet(format, value, buffer, buffer_size, &len, &pending);
+      if (result == TIME_CACHE_PENDING) {
+        timeCacheAnalyze(format, &pending);
+        result = timeCacheGet(format, value, buffer, buffer_size, &len, &pending);
+      };
+      if (result == TIME_CACHE_FOUND) return len;
+      if (result == TIME_CACHE_OVERFLOW) return 0;
+    };
+  #endif // CONFIG_RSTRINGS_TIME_CACHE_SLOTS
+
+  struct tm timeinfo;
+  rs_localtime_r(&value, &timeinfo);
+  size_t len = strftime(buffer, buffer_size, format, &timeinfo);
+
+  #if CONFIG_RSTRINGS_TIME_CACHE_SLOTS > 0
+    if (cacheable) {
+      timeCachePut(format, format_len, &timeinfo, value, buffer, len <= CONFIG_RSTRINGS_TIME_CACHE_LENGTH ? len : 0);
+    };
+  #endif // CONFIG_RSTRINGS_TIME_CACHE_SLOTS
+
+  if (len == 0) buffer[0] = 0;
+  return len;
+}
+
+void time2str_cache_reset(void)
+{
+  #if CONFIG_RSTRINGS_TIME_CACHE_SLOTS > 0
+    RS_LOCK(&_timeLock);
+    for (uint8_t i = 0; i < CONFIG_RSTRINGS_TIME_CACHE_SLOTS; i++) {
+      _timeSlots[i].used = 0;
+    };
+    _timeTick = 0;
+    RS_UNLOCK(&_timeLock);
+  #endif // CONFIG_RSTRINGS_TIME_CACHE_SLOTS
+}
+
+void time2str_cache_stats(rs_time_cache_stats_t* stats)
+{
+  if (stats == nullptr) return;
+  #if CONFIG_RSTRINGS_TIME_CACHE_SLOTS > 0
+    RS_LOCK(&_timeLock);
+    *stats = _timeStats;
+    RS_UNLOCK(&_timeLock);
+  #else
+    memset(stats, 0, sizeof(rs_time_cache_stats_t));
+  #endif // CONFIG_RSTRINGS_TIME_CACHE_SLOTS
+}
+
+// -----------------------------------------------------------------------------------------------------------------------
+// ------------------------------------------------- Precompiled formats -------------------------------------------------
+// -----------------------------------------------------------------------------------------------------------------------
+
+typedef enum {
+  TF_LITERAL = 0,                         // arg - offset in text, len - length
+  TF_STRFTIME,                            // arg - offset of a zero-terminated piece of the format in text, len - length
+  TF_NUMBER,                              // arg - field, len - width padded with zeros (or spaces if TF_SPACES is set)
+  TF_YEAR,
+  TF_WDAY_SHORT,
+  TF_WDAY_LONG,
+  TF_MONTH_SHORT,
+  TF_MONTH_LONG,
+  TF_AMPM
+} timefmt_code_t;
+
+typedef enum {
+  TF_MDAY = 0, TF_MON, TF_HOUR, TF_HOUR12, TF_MIN, TF_SEC, TF_YEAR2, TF_CENTURY, TF_YDAY, TF_WDAY, TF_WDAY1, TF_WEEK_SUN, TF_WEEK_MON
+} timefmt_field_t;
+
+#define TF_SPACES 0x80
+
+static const char * const _wdayNames[7] = { "Sunday", "Monday", "Tuesday", "Wednesday", "Thursday", "Friday", "Saturday" };
+static const char * const _monthNames[12] = { "January", "February", "March", "April", "May", "June", "July", "August", "September", "October", "November", "December" };
+
+static bool timefmtOp(rs_timefmt_t* program, uint8_t code, uint8_t arg, uint8_t len)
+{
+  if (program->count >= RS_TIMEFMT_MAX_OPS) return false;
+  program->ops[program->count++] = { code, arg, len };
+  return true;
+}
+
+static bool timefmtText(rs_timefmt_t* program, uint8_t code, const char* text, size_t len)
+{
+  // Adjacent literals are merged into one run
+  if ((code == TF_LITERAL) && (program->count > 0)) {
+    rs_timefmt_op_t* last = &program->ops[program->count - 1];
+    if ((last->code == TF_LITERAL) && (last->arg + last->len == program->text_len)) {
+      if (program->text_len + len > RS_TIMEFMT_MAX_TEXT) return false;
+      memcpy(program->text + program->text_len, text, len);
+      program->text_len += len;
+      last->len += len;
+      return true;
+    };
+  };
+  size_t reserve = code == TF_STRFTIME ? len + 1 : len;
+  if (program->text_len + reserve > RS_TIMEFMT_MAX_TEXT) return false;
+  uint8_t offset = program->text_len;
+  memcpy(program->text + offset, text, len);
+  if (code == TF_STRFTIME) program->text[offset + len] = 0;
+  program->text_len += reserve;
+  return timefmtOp(program, code, offset, len);
+}
+
+static bool timefmtSpec(rs_timefmt_t* program, char spec)
+{
+  switch (spec) {
+    case 'd': return timefmtOp(program, TF_NUMBER, TF_MDAY, 2);
+    case 'e': return timefmtOp(program, TF_NUMBER, TF_MDAY, 2 | TF_SPACES);
+    case 'm': return timefmtOp(program, TF_NUMBER, TF_MON, 2);
+    case 'H': return timefmtOp(program, TF_NUMBER, TF_HOUR, 2);
+    case 'k': return timefmtOp(program, TF_NUMBER, TF_HOUR, 2 | TF_SPACES);
+    case 'I': return timefmtOp(program, TF_NUMBER, TF_HOUR12, 2);
+    case 'l': return timefmtOp(program, TF_NUMBER, TF_HOUR12, 2 | TF_SPACES);
+    case 'M': return timefmtOp(program, TF_NUMBER, TF_MIN, 2);
+    case 'S': return timefmtOp(program, TF_NUMBER, TF_SEC, 2);
+    case 'y': return timefmtOp(program, TF_NUMBER, TF_YEAR2, 2);
+    case 'C': return timefmtOp(program, TF_NUMBER, TF_CENTURY, 2);
+    case 'j': return timefmtOp(program, TF_NUMBER, TF_YDAY, 3);
+    case 'w': return timefmtOp(program, TF_NUMBER, TF_WDAY, 1);
+    case 'u': return timefmtOp(program, TF_NUMBER, TF_WDAY1, 1);
+    case 'U': return timefmtOp(program, TF_NUMBER, TF_WEEK_SUN, 2);
+    case 'W': return timefmtOp(program, TF_NUMBER, TF_WEEK_MON, 2);
+    case 'Y': return timefmtOp(program, TF_YEAR, 0, 0);
+    case 'a': return timefmtOp(program, TF_WDAY_SHORT, 0, 0);
+    case 'A': return timefmtOp(program, TF_WDAY_LONG, 0, 0);
+    case 'b': case 'h': return timefmtOp(program, TF_MONTH_SHORT, 0, 0);
+    case 'B': return timefmtOp(program, TF_MONTH_LONG, 0, 0);
+    case 'p': return timefmtOp(program, TF_AMPM, 0, 0);
+    case '%': return timefmtText(program, TF_LITERAL, "%", 1);
+    case 'n': return timefmtText(program, TF_LITERAL, "\n", 1);
+    case 't': return timefmtText(program, TF_LITERAL, "\t", 1);
+    // Composite specifiers of the "C" locale
+    case 'D': return timefmtSpec(program, 'm') && timefmtText(program, TF_LITERAL, "/", 1) && timefmtSpec(program, 'd') 
+                  && timefmtText(program, TF_LITERAL, "/", 1) && timefmtSpec(program, 'y');
+    case 'F': return timefmtSpec(program, 'Y') && timefmtText(program, TF_LITERAL, "-", 1) && timefmtSpec(program, 'm') 
+                  && timefmtText(program, TF_LITERAL, "-", 1) && timefmtSpec(program, 'd');
+    case 'R': return timefmtSpec(program, 'H') && timefmtText(program, TF_LITERAL, ":", 1) && timefmtSpec(program, 'M');
+    case 'T': return timefmtSpec(program, 'R') && timefmtText(program, TF_LITERAL, ":", 1) && timefmtSpec(program, 'S');
+    case 'r': return timefmtSpec(program, 'I') && timefmtText(program, TF_LITERAL, ":", 1) && timefmtSpec(program, 'M')
+                  && timefmtText(program, TF_LITERAL, ":", 1) && timefmtSpec(program, 'S') 
+                  && timefmtText(program, TF_LITERAL, " ", 1) && timefmtSpec(program, 'p');
+    default: return false;
+  };
+}
+
+bool rs_timefmt_compile(rs_timefmt_t* program, const char* format)
+{
+  if ((program == nullptr) || (format == nullptr)) return false;
+  program->count = 0;
+  program->text_len = 0;
+  const char *fmt = format;
+  while (*fmt) {
+    if (*fmt != '%') {
+      const char *run = fmt;
+      while (*fmt && (*fmt != '%')) fmt++;
+      if (!timefmtText(program, TF_LITERAL, run, fmt - run)) return false;
+      continue;
+    };
+    const char *spec = fmt++;
+    if (*fmt == 0) return false;
+    if (timefmtSpec(program, *fmt)) {
+      fmt++;
+      continue;
+    };
+    // Flags, width, E/O modifiers and other specifiers: the whole piece goes to strftime
+    while (*fmt && (strchr("_-0^#+EO", *fmt) || ((*fmt >= '0') && (*fmt <= '9')))) fmt++;
+    if (*fmt == 0) return false;
+    fmt++;
+    if (!timefmtText(program, TF_STRFTIME, spec, fmt - spec)) return false;
+  };
+  return true;
+}
+
+static int timefmtField(const struct tm* timeinfo, uint8_t field)
+{
+  switch (field) {
+    case TF_MDAY:     return timeinfo->tm_mday;
+    case TF_MON:      return timeinfo->tm_mon + 1;
+    case TF_HOUR:     return timeinfo->tm_hour;
+    case TF_HOUR12:   return timeinfo->tm_hour % 12 == 0 ? 12 : timeinfo->tm_hour % 12;
+    case TF_MIN:      return timeinfo->tm_min;
+    case TF_SEC:      return timeinfo->tm_sec;
+    case TF_YEAR2:    return ((timeinfo->tm_year + 1900) % 100 + 100) % 100;
+    case TF_CENTURY:  return (timeinfo->tm_year + 1900) / 100;
+    case TF_YDAY:     return timeinfo->tm_yday + 1;
+    case TF_WDAY:     return timeinfo->tm_wday;
+    case TF_WDAY1:    return timeinfo->tm_wday == 0 ? 7 : timeinfo->tm_wday;
+    case TF_WEEK_SUN: return (timeinfo->tm_yday + 7 - timeinfo->tm_wday) / 7;
+    case TF_WEEK_MON: return (timeinfo->tm_yday + 7 - (timeinfo->tm_wday + 6) % 7) / 7;
+    default:          return 0;
+  };
+}
+
+// Writes value padded to width, returns the length or 0 if it does not fit
+static size_t timefmtNumber(char* pos, size_t available, int value, uint8_t width, char pad)
+{
+  char digits[12];
+  size_t count = 0;
+  bool negative = value < 0;
+  unsigned int rest = negative ? 0U - (unsigned int)value : (unsigned int)value;
+  do {
+    digits[count++] = '0' + rest % 10;
+    rest /= 10;
+  } while (rest > 0);
+  size_t len = (count + negative < width) ? width : count + negative;
+  if (len >= available) return 0;
+  char* out = pos;
+  if (negative && (pad == '0')) *out++ = '-';
+  for (size_t i = count + negative; i < width; i++) *out++ = pad;
+  if (negative && (pad != '0')) *out++ = '-';
+  while (count > 0) *out++ = digits[--count];
+  return len;
+}
+
+size_t rs_timefmt_render(const rs_timefmt_t* program, const struct tm* timeinfo, char* buffer, size_t buffer_size)
+{
+  if ((program == nullptr) || (timeinfo == nullptr) || (buffer == nullptr) || (buffer_size == 0)) {
+    return 0;
+  };
+  size_t pos = 0;
+  for (uint8_t i = 0; i < program->count; i++) {
+    const rs_timefmt_op_t* op = &program->ops[i];
+    const char* text = nullptr;
+    size_t len = 0;
+    switch (op->code) {
+      case TF_LITERAL:
+        text = program->text + op->arg;
+        len = op->len;
+        break;
+      case TF_NUMBER:
+        // Two-digit fields in range are the usual case
+        if (((op->len & ~TF_SPACES) == 2) && (pos + 2 < buffer_size)) {
+          int value = timefmtField(timeinfo, op->arg);
+          if ((value >= 0) && (value < 100)) {
+            buffer[pos] = value < 10 ? ((op->len & TF_SPACES) ? ' ' : '0') : '0' + value / 10;
+            buffer[pos + 1] = '0' + value % 10;
+            pos += 2;
+            continue;
+          };
+        };
+        len = timefmtNumber(buffer + pos, buffer_size - pos, timefmtField(timeinfo, op->arg), op->len & ~TF_SPACES, (op->len & TF_SPACES) ? ' ' : '0');
+        if (len == 0) goto overflow;
+        pos += len;
+        continue;
+      case TF_YEAR:
+        len = timefmtNumber(buffer + pos, buffer_size - pos, timeinfo->tm_year + 1900, 1, '0');
+        if (len == 0) goto overflow;
+        pos += len;
+        continue;
+      case TF_WDAY_SHORT:
+      case TF_WDAY_LONG:
+        text = ((timeinfo->tm_wday >= 0) && (timeinfo->tm_wday < 7)) ? _wdayNames[timeinfo->tm_wday] : "?";
+        len = (op->code == TF_WDAY_SHORT) && (text[1] != 0) ? 3 : strlen(text);
+        break;
+      case TF_MONTH_SHORT:
+      case TF_MONTH_LONG:
+        text = ((timeinfo->tm_mon >= 0) && (timeinfo->tm_mon < 12)) ? _monthNames[timeinfo->tm_mon] : "?";
+        len = (op->code == TF_MONTH_SHORT) && (text[1] != 0) ? 3 : strlen(text);
+        break;
+      case TF_AMPM:
+        text = timeinfo->tm_hour < 12 ? "AM" : "PM";
+        len = 2;
+        break;
+      case TF_STRFTIME:
+        {
+          // strftime returns 0 both for an empty result and for an overflow: render into a separate buffer
+          char piece[CONFIG_FORMAT_STRFTIME_BUFFER_SIZE];
+          len = strftime(piece, sizeof(piece), program->text + op->arg, timeinfo);
+          if (pos + len >= buffer_size) goto overflow;
+          memcpy(buffer + pos, piece, len);
+          pos += len;
+        };
+        continue;
+    };
+    if (pos + len >= buffer_size) goto overflow;
+    memcpy(buffer + pos, text, len);
+    pos += len;
+  };
+  buffer[pos] = 0;
+  return pos;
+
+overflow:
+  buffer[0] = 0;
+  return 0;
+}
+
+size_t rs_timefmt_render_time(const rs_timefmt_t* program, time_t value, char* buffer, size_t buffer_size)
+{
+  struct tm timeinfo;
+  rs_localtime_r(&value, &timeinfo);
+  return rs_timefmt_render(program, &timeinfo, buffer, buffer_size);
+}
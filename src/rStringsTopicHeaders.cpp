@@ -0,0 +1,171 @@
+#include "rStringsTopicHeaders.h"
+#include "rStringsTopics.h"
+#include "rStringsHeaders.h"
+#include "rStringsConfig.h"
+#include "rStringsPort.h"
+#include "rLog.h"
+#include <string.h>
+
+#if CONFIG_RLOG_PROJECT_LEVEL > RLOG_LEVEL_NONE
+static const char * tagHEADERS = "HEADERS";
+#endif // CONFIG_RLOG_PROJECT_LEVEL
+
+// -----------------------------------------------------------------------------------------------------------------------
+// -------------------------------------------------- Header tables ------------------------------------------------------
+// -----------------------------------------------------------------------------------------------------------------------
+
+#define TOPIC_HEADER(header) { header, sizeof(header) - 1 }
+
+// Values from project_config.h, the lengths are computed at compile time
+#define TOPIC_HEADERS_DEFAULT { { \
+  TOPIC_HEADER(MQTT1_LOC_HEADER_LOCATION), \
+  TOPIC_HEADER(MQTT1_LOC_HEADER_DEVICE), \
+  TOPIC_HEADER(MQTT1_PUB_HEADER_LOCATION), \
+  TOPIC_HEADER(MQTT1_PUB_HEADER_DEVICE), \
+  TOPIC_HEADER(MQTT2_LOC_HEADER_LOCATION), \
+  TOPIC_HEADER(MQTT2_LOC_HEADER_DEVICE), \
+  TOPIC_HEADER(MQTT2_PUB_HEADER_LOCATION), \
+  TOPIC_HEADER(MQTT2_PUB_HEADER_DEVICE), \
+}, 0 }
+
+static const topic_headers_t _headersDefault = TOPIC_HEADERS_DEFAULT;
+
+// Two tables: readers announce themselves in readers of the current one, the writer fills the other one
+// as soon as nobody reads it any more and switches _headersCurrent. Changed headers are kept in pool
+typedef struct {
+  topic_headers_t table;
+  uint32_t        readers;
+  char            pool[CONFIG_RSTRINGS_TOPIC_HEADERS_SIZE];
+} headers_slot_t;
+
+static headers_slot_t _headersSlots[2] = { { TOPIC_HEADERS_DEFAULT, 0, { 0 } }, { TOPIC_HEADERS_DEFAULT, 0, { 0 } } };
+static uint8_t _headersCurrent = 0;
+static uint8_t _headersWriting = 0;
+
+const topic_headers_t* topicHeadersAcquire(void)
+{
+  while (true) {
+    uint8_t index = RS_ATOMIC_LOAD(&_headersCurrent);
+    RS_ATOMIC_ADD(&_headersSlots[index].readers, 1);
+    // The writer could have switched to the other table and started to fill this one before it saw the reader
+    RS_ATOMIC_FENCE();
+    if (RS_ATOMIC_LOAD(&_headersCurrent) == index) return &_headersSlots[index].table;
+    RS_ATOMIC_SUB(&_headersSlots[index].readers, 1);
+  };
+}
+
+void topicHeadersRelease(const topic_headers_t* headers)
+{
+  // All reads of the table are completed before the writer can see the counter drop
+  RS_ATOMIC_FENCE();
+  RS_ATOMIC_SUB(&_headersSlots[headers == &_headersSlots[1].table ? 1 : 0].readers, 1);
+}
+
+// -----------------------------------------------------------------------------------------------------------------------
+// ------------------------------------------------- Changing headers ----------------------------------------------------
+// -----------------------------------------------------------------------------------------------------------------------
+
+static bool headersAppend(headers_slot_t* slot, size_t* used, const char* text, size_t len)
+{
+  if (*used + len > sizeof(slot->pool)) return false;
+  memcpy(slot->pool + *used, text, len);
+  *used += len;
+  return true;
+}
+
+// Copies a header of the current table, headers from project_config.h are not copied
+static bool headersCopy(headers_slot_t* source, headers_slot_t* target, size_t* used, const uint8_t index)
+{
+  const topic_header_t* item = &source->table.items[index];
+  if ((item->text < source->pool) || (item->text >= source->pool + sizeof(source->pool))) {
+    target->table.items[index] = *item;
+    return true;
+  };
+  target->table.items[index].text = target->pool + *used;
+  target->table.items[index].len = item->len;
+  return headersAppend(target, used, item->text, item->len + 1);
+}
+
+// Builds a header like rStringsHeaders.h: prefix + [location + /] + [device + /]
+static bool headersCompose(headers_slot_t* target, size_t* used, const uint8_t index,
+  const char *prefix, const char *location, const char *device)
+{
+  size_t start = *used;
+  bool ok = true;
+  if (prefix) ok = headersAppend(target, used, prefix, strlen(prefix));
+  if (location && *location) ok = ok && headersAppend(target, used, location, strlen(location)) && headersAppend(target, used, "/", 1);
+  if (device && *device) ok = ok && headersAppend(target, used, device, strlen(device)) && headersAppend(target, used, "/", 1);
+  ok = ok && headersAppend(target, used, "", 1);
+  target->table.items[index].text = target->pool + start;
+  target->table.items[index].len = ok ? (uint16_t)(*used - start - 1) : 0;
+  return ok;
+}
+
+static bool headersWrite(const bool reset, const bool primary, const bool local, const char *prefix, const char *location, const char *device)
+{
+  // Writers take turns, readers are never blocked
+  uint8_t expected = 0;
+  while (!RS_ATOMIC_CAS(&_headersWriting, &expected, (uint8_t)1)) {
+    expected = 0;
+    RS_YIELD();
+  };
+  uint8_t current = RS_ATOMIC_LOAD(&_headersCurrent);
+  headers_slot_t* source = &_headersSlots[current];
+  headers_slot_t* target = &_headersSlots[current ^ 1];
+  // Tasks that acquired the previous table before the last change may still read it
+  RS_ATOMIC_FENCE();
+  while (RS_ATOMIC_LOAD(&target->readers) != 0) {
+    RS_YIELD();
+  };
+
+  bool ok = true;
+  size_t used = 0;
+  const uint8_t locIndex = topicHeaderIndex(primary, local, MQTT_HEADER_LOCATION);
+  const uint8_t devIndex = topicHeaderIndex(primary, local, MQTT_HEADER_DEVICE);
+  for (uint8_t i = 0; ok && (i < TOPIC_HEADERS_COUNT); i++) {
+    if (reset) {
+      target->table.items[i] = _headersDefault.items[i];
+    } else if ((i != locIndex) && (i != devIndex)) {
+      ok = headersCopy(source, target, &used, i);
+    };
+  };
+  if (!reset) {
+    ok = ok && headersCompose(target, &used, locIndex, prefix, location, nullptr)
+            && headersCompose(target, &used, devIndex, prefix, location, device);
+  };
+  if (ok) {
+    target->table.generation = source->table.generation + 1;
+    RS_ATOMIC_FENCE();
+    RS_ATOMIC_STORE(&_headersCurrent, (uint8_t)(current ^ 1));
+  } else {
+    rlog_e(tagHEADERS, "Topic headers do not fit into %d bytes", CONFIG_RSTRINGS_TOPIC_HEADERS_SIZE);
+  };
+  RS_ATOMIC_STORE(&_headersWriting, (uint8_t)0);
+  return ok;
+}
+
+bool mqttSetTopicHeaders(const bool primary, const bool local, const char *prefix, const char *location, const char *device)
+{
+  return headersWrite(false, primary, local, prefix, location, device);
+}
+
+void mqttResetTopicHeaders(void)
+{
+  headersWrite(true, true, true, nullptr, nullptr, nullptr);
+}
+
+uint32_t mqttGetTopicHeadersGeneration(void)
+{
+  const topic_headers_t* headers = topicHeadersAcquire();
+  uint32_t ret = headers->generation;
+  topicHeadersRelease(headers);
+  return ret;
+}
+
+const char * mqttGetTopicHeader(const bool primary, const bool local, const mqtt_header_t kind)
+{
+  const topic_headers_t* headers = topicHeadersAcquire();
+  const char* ret = headers->items[topicHeaderIndex(primary, local, kind)].text;
+  topicHeadersRelease(headers);
+  return ret;
+}
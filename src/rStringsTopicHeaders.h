@@ -0,0 +1,39 @@
+/*
+   EN: Internal table of the topic headers, switchable at runtime
+   RU: Внутренняя таблица заголовков топиков, переключаемая во время работы
+*/
+
+#ifndef __R_STRINGS_TOPIC_HEADERS_H__
+#define __R_STRINGS_TOPIC_HEADERS_H__
+
+#include <stddef.h>
+#include <stdint.h>
+#include "rStrings.h"
+
+#define TOPIC_HEADERS_COUNT 8
+
+typedef struct {
+  const char* text;
+  uint16_t    len;
+} topic_header_t;
+
+// Index: backup << 2 | public << 1 | device, generation changes with every mqttSetTopicHeaders()
+typedef struct {
+  topic_header_t items[TOPIC_HEADERS_COUNT];
+  uint32_t       generation;
+} topic_headers_t;
+
+static inline uint8_t topicHeaderIndex(const bool primary, const bool local, const mqtt_header_t kind)
+{
+  return (primary ? 0 : 4) | (local ? 0 : 2) | (kind == MQTT_HEADER_DEVICE ? 1 : 0);
+}
+
+// The current table stays unchanged (and its strings valid) until it is released, never hold it across blocking calls
+const topic_headers_t* topicHeadersAcquire(void);
+void topicHeadersRelease(const topic_headers_t* headers);
+
+// Topic assembly shared by all builders and the intern cache (rStrings.cpp): header + [special + /] + segments joined by "/"
+size_t topicLength(const topic_header_t* header, const char *special, const char * const *segments, const uint8_t count);
+void topicWrite(char *pos, const topic_header_t* header, const char *special, const char * const *segments, const uint8_t count);
+
+#endif // __R_STRINGS_TOPIC_HEADERS_H__
@@ -0,0 +1,362 @@
+#include "rStringsTopics.h"
+#include "rStringsTopicHeaders.h"
+#include "rStringsConfig.h"
+#include "rStringsPort.h"
+#include "rLog.h"
+#include <string.h>
+
+#if CONFIG_RLOG_PROJECT_LEVEL > RLOG_LEVEL_NONE
+static const char * tagTOPICS = "TOPICS";
+#endif // CONFIG_RLOG_PROJECT_LEVEL
+
+// -----------------------------------------------------------------------------------------------------------------------
+// -------------------------------------------------- Topic interning ----------------------------------------------------
+// -----------------------------------------------------------------------------------------------------------------------
+
+#define INTERN_SLOTS (CONFIG_RSTRINGS_INTERN_CAPACITY * 2)
+static_assert((INTERN_SLOTS & (INTERN_SLOTS - 1)) == 0, "CONFIG_RSTRINGS_INTERN_CAPACITY must be a power of two");
+
+typedef struct {
+  uint32_t hash;
+  uint32_t generation;  // of the topic headers, topics built with previous headers are not returned
+  uint16_t header;  // length of the header part of topic
+  uint8_t  flags;   // primary | local << 1 | kind << 2, 0xFF = empty slot
+  char*    topic;
+} intern_slot_t;
+
+static intern_slot_t _internSlots[INTERN_SLOTS];
+static bool _internReady = false;
+static rs_lock_t _internLock = RS_LOCK_INITIALIZER;
+static mqtt_intern_stats_t _internStats = { 0, 0, 0, 0, CONFIG_RSTRINGS_INTERN_CAPACITY, 0 };
+
+static inline uint32_t fnvString(uint32_t hash, const char *str)
+{
+  while (*str) {
+    hash = (hash ^ (uint8_t)*str++) * 16777619u;
+  };
+  return hash;
+}
+
+static uint32_t internHash(const uint8_t flags, const uint32_t generation, const char *special, const char * const *topics, const uint8_t count)
+{
+  uint32_t hash = (((2166136261u ^ flags) * 16777619u) ^ generation) * 16777619u;
+  if (special) hash = (fnvString(hash, special) ^ '/') * 16777619u;
+  for (uint8_t i = 0; i < count; i++) {
+    // The separator is hashed like a character: equal topic strings give equal hashes however they were split
+    if (topics[i]) hash = (fnvString(hash, topics[i]) ^ '/') * 16777619u;
+  };
+  return hash;
+}
+
+// Compares the stored segments part of a topic with the requested segments
+static bool internMatch(const char *stored, const char *special, const char * const *topics, const uint8_t count)
+{
+  bool first = true;
+  if (special) {
+    size_t len = strlen(special);
+    if (strncmp(stored, special, len) != 0) return false;
+    stored += len;
+    first = false;
+  };
+  for (uint8_t i = 0; i < count; i++) {
+    if (topics[i]) {
+      if (!first && (*stored++ != '/')) return false;
+      size_t len = strlen(topics[i]);
+      if (strncmp(stored, topics[i], len) != 0) return false;
+      stored += len;
+      first = false;
+    };
+  };
+  return *stored == '\0';
+}
+
+// Resets the table, returns the number of released topics copied to topics (memory is freed outside the lock)
+static size_t internClear(char **topics)
+{
+  size_t ret = 0;
+  for (size_t i = 0; i < INTERN_SLOTS; i++) {
+    if (_internReady && (_internSlots[i].flags != 0xFF) && topics) {
+      topics[ret++] = _internSlots[i].topic;
+    };
+    _internSlots[i].flags = 0xFF;
+    _internSlots[i].topic = nullptr;
+  };
+  _internStats.count = 0;
+  _internStats.bytes = 0;
+  _internReady = true;
+  return ret;
+}
+
+// Looks for the topic, returns the topic or NULL and the index of the slot where the search stopped
+static const char * internFind(const uint32_t hash, const uint32_t generation, const uint8_t flags, 
+  const char *special, const char * const *topics, const uint8_t count, size_t *index)
+{
+  if (!_internReady) internClear(nullptr);
+  *index = hash & (INTERN_SLOTS - 1);
+  while (_internSlots[*index].flags != 0xFF) {
+    intern_slot_t* slot = &_internSlots[*index];
+    if ((slot->hash == hash) && (slot->flags == flags) && (slot->generation == generation) && internMatch(slot->topic + slot->header, special, topics, count)) {
+      return slot->topic;
+    };
+    *index = (*index + 1) & (INTERN_SLOTS - 1);
+  };
+  return nullptr;
+}
+
+const char * mqttInternTopic(const bool primary, const bool local, const mqtt_header_t kind, const char *special, const char * const *topics, const uint8_t count)
+{
+  if ((topics == nullptr) && (count > 0)) return nullptr;
+  const uint8_t flags = (primary ? 1 : 0) | (local ? 2 : 0) | ((uint8_t)kind << 2);
+  // The headers do not change until the topic is stored
+  const topic_headers_t* headers = topicHeadersAcquire();
+  const uint32_t hash = internHash(flags, headers->generation, special, topics, count);
+  size_t index;
+
+  RS_LOCK(&_internLock);
+  const char* ret = internFind(hash, headers->generation, flags, special, topics, count, &index);
+  if (ret) {
+    _internStats.hits++;
+  } else if (_internStats.count >= CONFIG_RSTRINGS_INTERN_CAPACITY) {
+    _internStats.overflows++;
+  };
+  bool full = _internStats.count >= CONFIG_RSTRINGS_INTERN_CAPACITY;
+  RS_UNLOCK(&_internLock);
+  if (ret || full) {
+    topicHeadersRelease(headers);
+    return ret;
+  };
+
+  // Miss: the topic is generated once (outside of the lock) and kept until invalidation
+  const topic_header_t* header = &headers->items[topicHeaderIndex(primary, local, kind)];
+  size_t hlen = header->len;
+  size_t len = topicLength(header, special, topics, count);
+  const rs_allocator_t* heap = rs_default_allocator();
+  char* topic = (char*)heap->alloc(heap->ctx, len + 1);
+  if (topic == nullptr) {
+    topicHeadersRelease(headers);
+    rlog_e(tagTOPICS, "Failed to intern topic: out of memory!");
+    return nullptr;
+  };
+  topicWrite(topic, header, special, topics, count);
+
+  RS_LOCK(&_internLock);
+  // Another task could have added the same topic in the meantime
+  ret = internFind(hash, headers->generation, flags, special, topics, count, &index);
+  if (ret) {
+    _internStats.hits++;
+  } else if (_internStats.count < CONFIG_RSTRINGS_INTERN_CAPACITY) {
+    intern_slot_t* slot = &_internSlots[index];
+    slot->hash = hash;
+    slot->generation = headers->generation;
+    slot->header = hlen;
+    slot->flags = flags;
+    slot->topic = topic;
+    _internStats.count++;
+    _internStats.bytes += len + 1;
+    _internStats.misses++;
+    ret = topic;
+  } else {
+    _internStats.overflows++;
+  };
+  RS_UNLOCK(&_internLock);
+  topicHeadersRelease(headers);
+  if (ret != topic) heap->free(heap->ctx, topic);
+  return ret;
+}
+
+void mqttInternInvalidate(void)
+{
+  char* topics[CONFIG_RSTRINGS_INTERN_CAPACITY];
+  RS_LOCK(&_internLock);
+  size_t count = internClear(topics);
+  RS_UNLOCK(&_internLock);
+  const rs_allocator_t* heap = rs_default_allocator();
+  for (size_t i = 0; i < count; i++) {
+    heap->free(heap->ctx, topics[i]);
+  };
+}
+
+void mqttInternGetStats(mqtt_intern_stats_t *stats)
+{
+  if (stats) {
+    RS_LOCK(&_internLock);
+    *stats = _internStats;
+    RS_UNLOCK(&_internLock);
+  };
+}
+
+// -----------------------------------------------------------------------------------------------------------------------
+// -------------------------------------------------- Topic parsing ------------------------------------------------------
+// -----------------------------------------------------------------------------------------------------------------------
+
+// Length of the header matched by topic including the separator after it, -1 if it does not match
+static int parseHeaderMatch(const char *topic, size_t len, const char *header, size_t header_len)
+{
+  if ((header_len > len) || (memcmp(topic, header, header_len) != 0)) return -1;
+  // Headers normally end with "/", otherwise the header must end at a segment boundary
+  if ((header_len == 0) || (header[header_len - 1] == '/')) return (int)header_len;
+  if (header_len == len) return (int)header_len;
+  return topic[header_len] == '/' ? (int)header_len + 1 : -1;
+}
+
+bool mqttParseTopic(const char *topic, size_t len, const char * const *specials, const uint8_t specials_count, mqtt_topic_parts_t *parts)
+{
+  if ((topic == nullptr) || (parts == nullptr) || (len > UINT16_MAX)) return false;
+  // The index of the special segment is reported as int8_t
+  if (specials && (specials_count > INT8_MAX)) {
+    rlog_e(tagTOPICS, "Too many special segments: %d, at most %d", specials_count, INT8_MAX);
+    return false;
+  };
+  memset(parts, 0, sizeof(mqtt_topic_parts_t));
+  parts->special = -1;
+  // The table is in the order of preference for equal headers: primary, local, location first
+  int best = -1;
+  const topic_headers_t* headers = topicHeadersAcquire();
+  for (uint8_t i = 0; i < TOPIC_HEADERS_COUNT; i++) {
+    int matched = parseHeaderMatch(topic, len, headers->items[i].text, headers->items[i].len);
+    if (matched > best) {
+      best = matched;
+      parts->primary = (i & 4) == 0;
+      parts->local = (i & 2) == 0;
+      parts->kind = (i & 1) ? MQTT_HEADER_DEVICE : MQTT_HEADER_LOCATION;
+    };
+  };
+  topicHeadersRelease(headers);
+  if (best < 0) return false;
+  parts->header_len = (uint16_t)best;
+
+  // Segments: views between the separators
+  size_t pos = (size_t)best;
+  while (pos <= len) {
+    const char *end = (const char*)memchr(topic + pos, '/', len - pos);
+    size_t seg_len = end ? (size_t)(end - topic) - pos : len - pos;
+    bool special = false;
+    if ((pos == (size_t)best) && (parts->kind == MQTT_HEADER_LOCATION) && specials) {
+      for (uint8_t i = 0; i < specials_count; i++) {
+        if (specials[i] && (strlen(specials[i]) == seg_len) && (memcmp(specials[i], topic + pos, seg_len) == 0)) {
+          parts->special = (int8_t)i;
+          special = true;
+          break;
+        };
+      };
+    };
+    if (!special) {
+      if (end && (parts->count == MQTT_TOPIC_MAX_SEGMENTS - 1)) {
+        // The last view holds the rest of the topic
+        parts->segments[parts->count++] = { (uint16_t)pos, (uint16_t)(len - pos) };
+        parts->truncated = true;
+        break;
+      };
+      parts->segments[parts->count++] = { (uint16_t)pos, (uint16_t)seg_len };
+    };
+    if (!end) break;
+    pos += seg_len + 1;
+  };
+  return true;
+}
+
+bool mqttSegmentEquals(const char *topic, const mqtt_segment_t segment, const char *value)
+{
+  if ((topic == nullptr) || (value == nullptr)) return false;
+  return (strlen(value) == segment.len) && (memcmp(topic + segment.offset, value, segment.len) == 0);
+}
+
+size_t mqttSegmentCopy(const char *topic, const mqtt_segment_t segment, char *buffer, size_t buffer_size)
+{
+  if ((topic == nullptr) || (buffer == nullptr) || (buffer_size == 0)) return 0;
+  if (segment.len >= buffer_size) {
+    buffer[0] = '\0';
+    return 0;
+  };
+  memcpy(buffer, topic + segment.offset, segment.len);
+  buffer[segment.len] = '\0';
+  return segment.len;
+}
+
+// -----------------------------------------------------------------------------------------------------------------------
+// --------------------------------------------------- Topic tables ------------------------------------------------------
+// -----------------------------------------------------------------------------------------------------------------------
+
+// One heap block: this header, count + 1 offsets of the strings (the last one is the end of the text) and the text
+struct mqtt_topic_table_t {
+  size_t    size;
+  uint32_t  generation;
+  uint16_t  count;
+  uint32_t* offsets;
+  char*     text;
+};
+
+mqtt_topic_table_t * mqttTopicTableCreate(const mqtt_topic_desc_t *topics, const uint16_t count)
+{
+  if ((topics == nullptr) && (count > 0)) return nullptr;
+  for (uint16_t i = 0; i < count; i++) {
+    if ((topics[i].segments == nullptr) && (topics[i].count > 0)) {
+      rlog_e(tagTOPICS, "Topic table: no segments in item %d", i);
+      return nullptr;
+    };
+  };
+
+  // The headers are held through both passes, so that all topics use the same ones
+  const topic_headers_t* headers = topicHeadersAcquire();
+  size_t text = 0;
+  for (uint16_t i = 0; i < count; i++) {
+    const mqtt_topic_desc_t* topic = &topics[i];
+    text += topicLength(&headers->items[topicHeaderIndex(topic->primary, topic->local, topic->kind)], 
+      topic->special, topic->segments, topic->count) + 1;
+  };
+  size_t size = sizeof(mqtt_topic_table_t) + ((size_t)count + 1) * sizeof(uint32_t) + text;
+  mqtt_topic_table_t* table = (mqtt_topic_table_t*)rs_malloc(size);
+  if (table == nullptr) {
+    topicHeadersRelease(headers);
+    rlog_e(tagTOPICS, "Failed to create topic table: out of memory (%d bytes)!", (int)size);
+    return nullptr;
+  };
+  table->size = size;
+  table->generation = headers->generation;
+  table->count = count;
+  table->offsets = (uint32_t*)(table + 1);
+  table->text = (char*)(table->offsets + count + 1);
+  uint32_t offset = 0;
+  for (uint16_t i = 0; i < count; i++) {
+    const mqtt_topic_desc_t* topic = &topics[i];
+    const topic_header_t* header = &headers->items[topicHeaderIndex(topic->primary, topic->local, topic->kind)];
+    table->offsets[i] = offset;
+    topicWrite(table->text + offset, header, topic->special, topic->segments, topic->count);
+    offset += topicLength(header, topic->special, topic->segments, topic->count) + 1;
+  };
+  table->offsets[count] = offset;
+  topicHeadersRelease(headers);
+
+  rlog_i(tagTOPICS, "Topic table created: %d topics, %d bytes (%d bytes of text)", count, (int)size, (int)text);
+  return table;
+}
+
+void mqttTopicTableFree(mqtt_topic_table_t *table)
+{
+  rs_free(table);
+}
+
+uint16_t mqttTopicTableCount(const mqtt_topic_table_t *table)
+{
+  return table ? table->count : 0;
+}
+
+const char * mqttTopicTableGet(const mqtt_topic_table_t *table, const uint16_t index)
+{
+  return (table && (index < table->count)) ? table->text + table->offsets[index] : nullptr;
+}
+
+size_t mqttTopicTableLength(const mqtt_topic_table_t *table, const uint16_t index)
+{
+  return (table && (index < table->count)) ? table->offsets[index + 1] - table->offsets[index] - 1 : 0;
+}
+
+size_t mqttTopicTableSize(const mqtt_topic_table_t *table)
+{
+  return table ? table->size : 0;
+}
+
+uint32_t mqttTopicTableGeneration(const mqtt_topic_table_t *table)
+{
+  return table ? table->generation : 0;
+}
@@ -0,0 +1,358 @@
+#include "rStringsTrie.h"
+#include "rStringsTopicHeaders.h"
+#include "rStringsConfig.h"
+#include "rLog.h"
+#include <string.h>
+
+#if CONFIG_RLOG_PROJECT_LEVEL > RLOG_LEVEL_NONE
+static const char * tagTRIE = "TRIE";
+#endif // CONFIG_RLOG_PROJECT_LEVEL
+
+#define TRIE_NONE UINT32_MAX
+
+typedef struct {
+  uint32_t handlers;                      // Subscriptions ending at this level
+  uint32_t wildcard;                      // Subscriptions with # after this level
+  uint32_t plus;                          // Child node for +
+} trie_node_t;
+
+typedef struct {
+  uint32_t parent;
+  uint32_t child;                         // TRIE_NONE - free slot
+  uint32_t hash;
+  uint32_t text;                          // Offset of the level in the text pool
+  uint32_t len;
+} trie_edge_t;
+
+typedef struct {
+  mqtt_handler_t handler;
+  void*          ctx;
+  uint32_t       next;
+} trie_handler_t;
+
+struct mqtt_trie_t {
+  trie_node_t*    nodes;
+  uint32_t        nodeCount;
+  uint32_t        nodeCapacity;
+  trie_edge_t*    edges;
+  uint32_t        edgeCount;
+  uint32_t        edgeCapacity;           // Power of two
+  trie_handler_t* handlers;
+  uint32_t        handlerCount;
+  uint32_t        handlerCapacity;
+  uint32_t        handlerFree;            // List of released handler entries
+  char*           text;
+  uint32_t        textLen;
+  uint32_t        textCapacity;
+  uint32_t        subscriptions;
+};
+
+// -----------------------------------------------------------------------------------------------------------------------
+// ----------------------------------------------------- Storage ---------------------------------------------------------
+// -----------------------------------------------------------------------------------------------------------------------
+
+// Grows an array of items to hold at least needed items
+static bool trieGrow(void** items, uint32_t* capacity, uint32_t needed, size_t item_size)
+{
+  if (needed <= *capacity) return true;
+  uint32_t size = *capacity < 16 ? 16 : *capacity + *capacity / 2;
+  if (size < needed) size = needed;
+  void* data = rs_realloc(*items, (size_t)size * item_size);
+  if (data == nullptr) {
+    rlog_e(tagTRIE, "Failed to grow the subscription trie: out of memory!");
+    return false;
+  };
+  *items = data;
+  *capacity = size;
+  return true;
+}
+
+static uint32_t trieNode(mqtt_trie_t* trie)
+{
+  if (!trieGrow((void**)&trie->nodes, &trie->nodeCapacity, trie->nodeCount + 1, sizeof(trie_node_t))) return TRIE_NONE;
+  trie->nodes[trie->nodeCount] = { TRIE_NONE, TRIE_NONE, TRIE_NONE };
+  return trie->nodeCount++;
+}
+
+static inline uint32_t levelHash(uint32_t parent, const char* level, size_t len)
+{
+  uint32_t hash = 2166136261u ^ (parent * 0x9E3779B1u);
+  for (size_t i = 0; i < len; i++) {
+    hash ^= (uint8_t)level[i];
+    hash *= 16777619u;
+  };
+  return hash;
+}
+
+static uint32_t edgeFind(const mqtt_trie_t* trie, uint32_t parent, uint32_t hash, const char* level, size_t len)
+{
+  if (trie->edgeCapacity == 0) return TRIE_NONE;
+  uint32_t mask = trie->edgeCapacity - 1;
+  for (uint32_t i = hash & mask; ; i = (i + 1) & mask) {
+    const trie_edge_t* edge = &trie->edges[i];
+    if (edge->child == TRIE_NONE) return TRIE_NONE;
+    if ((edge->hash == hash) && (edge->parent == parent) && (edge->len == len) && (memcmp(trie->text + edge->text, level, len) == 0)) {
+      return edge->child;
+    };
+  };
+}
+
+static void edgePlace(trie_edge_t* edges, uint32_t capacity, const trie_edge_t* edge)
+{
+  uint32_t mask = capacity - 1;
+  uint32_t i = edge->hash & mask;
+  while (edges[i].child != TRIE_NONE) i = (i + 1) & mask;
+  edges[i] = *edge;
+}
+
+// Hash table of edges is kept at most half full
+static bool edgeReserve(mqtt_trie_t* trie)
+{
+  if ((trie->edgeCount + 1) * 2 <= trie->edgeCapacity) return true;
+  uint32_t capacity = trie->edgeCapacity == 0 ? 64 : trie->edgeCapacity * 2;
+  trie_edge_t* edges = (trie_edge_t*)rs_malloc((size_t)capacity * sizeof(trie_edge_t));
+  if (edges == nullptr) {
+    rlog_e(tagTRIE, "Failed to grow the subscription trie: out of memory!");
+    return false;
+  };
+  for (uint32_t i = 0; i < capacity; i++) edges[i].child = TRIE_NONE;
+  for (uint32_t i = 0; i < trie->edgeCapacity; i++) {
+    if (trie->edges[i].child != TRIE_NONE) edgePlace(edges, capacity, &trie->edges[i]);
+  };
+  rs_free(trie->edges);
+  trie->edges = edges;
+  trie->edgeCapacity = capacity;
+  return true;
+}
+
+static uint32_t edgeAdd(mqtt_trie_t* trie, uint32_t parent, uint32_t hash, const char* level, size_t len)
+{
+  if (!edgeReserve(trie)) return TRIE_NONE;
+  if (!trieGrow((void**)&trie->text, &trie->textCapacity, trie->textLen + (uint32_t)len, 1)) return TRIE_NONE;
+  uint32_t child = trieNode(trie);
+  if (child == TRIE_NONE) return TRIE_NONE;
+  trie_edge_t edge = { parent, child, hash, trie->textLen, (uint32_t)len };
+  memcpy(trie->text + trie->textLen, level, len);
+  trie->textLen += (uint32_t)len;
+  edgePlace(trie->edges, trie->edgeCapacity, &edge);
+  trie->edgeCount++;
+  return child;
+}
+
+// -----------------------------------------------------------------------------------------------------------------------
+// -------------------------------------------------- Subscriptions ------------------------------------------------------
+// -----------------------------------------------------------------------------------------------------------------------
+
+mqtt_trie_t* mqttTrieCreate(void)
+{
+  mqtt_trie_t* trie = (mqtt_trie_t*)rs_malloc(sizeof(mqtt_trie_t));
+  if (trie == nullptr) {
+    rlog_e(tagTRIE, "Failed to create subscription trie: out of memory!");
+    return nullptr;
+  };
+  memset(trie, 0, sizeof(mqtt_trie_t));
+  trie->handlerFree = TRIE_NONE;
+  // Root node
+  if (trieNode(trie) == TRIE_NONE) {
+    mqttTrieFree(trie);
+    return nullptr;
+  };
+  return trie;
+}
+
+void mqttTrieFree(mqtt_trie_t* trie)
+{
+  if (trie) {
+    rs_free(trie->nodes);
+    rs_free(trie->edges);
+    rs_free(trie->handlers);
+    rs_free(trie->text);
+    rs_free(trie);
+  };
+}
+
+/**
+ * Finds (or creates) the node of filter and returns the list of its handlers: the node's own list
+ * or the list of # subscriptions. NULL if the filter is invalid, not found or out of memory
+ * */
+static uint32_t* trieFilterList(mqtt_trie_t* trie, const char* filter, bool create)
+{
+  if ((trie == nullptr) || (filter == nullptr) || (*filter == '\0')) return nullptr;
+  uint32_t node = 0;
+  uint32_t depth = 0;
+  const char* level = filter;
+  while (true) {
+    // Deeper filters could not be reached by mqttTrieDispatch()
+    if (++depth > CONFIG_RSTRINGS_TRIE_MAX_LEVELS) {
+      rlog_e(tagTRIE, "Filter \"%s\" is deeper than %d levels", filter, CONFIG_RSTRINGS_TRIE_MAX_LEVELS);
+      return nullptr;
+    };
+    const char* end = strchr(level, '/');
+    size_t len = end ? (size_t)(end - level) : strlen(level);
+    if ((len == 1) && (level[0] == '#')) {
+      // # is allowed only as the last level
+      return end ? nullptr : &trie->nodes[node].wildcard;
+    } else if ((len == 1) && (level[0] == '+')) {
+      if (trie->nodes[node].plus == TRIE_NONE) {
+        if (!create) return nullptr;
+        uint32_t child = trieNode(trie);
+        if (child == TRIE_NONE) return nullptr;
+        trie->nodes[node].plus = child;
+      };
+      node = trie->nodes[node].plus;
+    } else {
+      if (memchr(level, '+', len) || memchr(level, '#', len)) return nullptr;
+      uint32_t hash = levelHash(node, level, len);
+      uint32_t child = edgeFind(trie, node, hash, level, len);
+      if (child == TRIE_NONE) {
+        if (!create) return nullptr;
+        child = edgeAdd(trie, node, hash, level, len);
+        if (child == TRIE_NONE) return nullptr;
+      };
+      node = child;
+    };
+    if (!end) break;
+    level = end + 1;
+  };
+  return &trie->nodes[node].handlers;
+}
+
+bool mqttTrieSubscribe(mqtt_trie_t* trie, const char* filter, mqtt_handler_t handler, void* ctx)
+{
+  if (handler == nullptr) return false;
+  // The handler entry is prepared first: the lists are inside the node array that may move
+  uint32_t entry = trie ? trie->handlerFree : TRIE_NONE;
+  if (trie && (entry == TRIE_NONE)) {
+    if (!trieGrow((void**)&trie->handlers, &trie->handlerCapacity, trie->handlerCount + 1, sizeof(trie_handler_t))) return false;
+    entry = trie->handlerCount;
+  };
+  uint32_t* list = trieFilterList(trie, filter, true);
+  if (list == nullptr) {
+    rlog_e(tagTRIE, "Failed to subscribe to \"%s\"", filter ? filter : "NULL");
+    return false;
+  };
+  if (entry == trie->handlerFree) {
+    trie->handlerFree = trie->handlers[entry].next;
+  } else {
+    trie->handlerCount++;
+  };
+  // Appended to the end: handlers are called in the order of subscription
+  trie->handlers[entry] = { handler, ctx, TRIE_NONE };
+  while (*list != TRIE_NONE) list = &trie->handlers[*list].next;
+  *list = entry;
+  trie->subscriptions++;
+  return true;
+}
+
+bool mqttTrieSubscribeHeader(mqtt_trie_t* trie, const bool primary, const bool local, const mqtt_header_t kind, const char* filter, mqtt_handler_t handler, void* ctx)
+{
+  if (filter == nullptr) return false;
+  // The header is copied while the table is held, subscribing itself does not need it
+  const topic_headers_t* headers = topicHeadersAcquire();
+  const topic_header_t* header = &headers->items[topicHeaderIndex(primary, local, kind)];
+  size_t header_len = header->len;
+  size_t filter_len = strlen(filter);
+  char buffer[128];
+  char* full = header_len + filter_len < sizeof(buffer) ? buffer : (char*)rs_malloc(header_len + filter_len + 1);
+  if (full) {
+    memcpy(full, header->text, header_len);
+    memcpy(full + header_len, filter, filter_len + 1);
+  };
+  topicHeadersRelease(headers);
+  if (full == nullptr) {
+    rlog_e(tagTRIE, "Failed to subscribe to \"%s\": out of memory!", filter);
+    return false;
+  };
+  bool ret = mqttTrieSubscribe(trie, full, handler, ctx);
+  if (full != buffer) rs_free(full);
+  return ret;
+}
+
+bool mqttTrieUnsubscribe(mqtt_trie_t* trie, const char* filter, mqtt_handler_t handler, void* ctx)
+{
+  uint32_t* list = trieFilterList(trie, filter, false);
+  if (list == nullptr) return false;
+  while (*list != TRIE_NONE) {
+    trie_handler_t* item = &trie->handlers[*list];
+    if ((item->handler == handler) && (item->ctx == ctx)) {
+      uint32_t entry = *list;
+      *list = item->next;
+      item->next = trie->handlerFree;
+      trie->handlerFree = entry;
+      trie->subscriptions--;
+      return true;
+    };
+    list = &item->next;
+  };
+  return false;
+}
+
+// -----------------------------------------------------------------------------------------------------------------------
+// ----------------------------------------------------- Dispatch --------------------------------------------------------
+// -----------------------------------------------------------------------------------------------------------------------
+
+static uint16_t trieCall(const mqtt_trie_t* trie, uint32_t entry, const char* topic, void* message)
+{
+  uint16_t count = 0;
+  while (entry != TRIE_NONE) {
+    const trie_handler_t* item = &trie->handlers[entry];
+    item->handler(topic, item->ctx, message);
+    entry = item->next;
+    count++;
+  };
+  return count;
+}
+
+uint16_t mqttTrieDispatch(const mqtt_trie_t* trie, const char* topic, void* message)
+{
+  if ((trie == nullptr) || (topic == nullptr)) return 0;
+  // Depth-first walk: every level adds at most two branches (the exact level and +)
+  struct { uint32_t node; uint32_t pos; } stack[CONFIG_RSTRINGS_TRIE_MAX_LEVELS + 1];
+  uint8_t top = 0;
+  uint16_t count = 0;
+  bool system = topic[0] == '$';
+  stack[top++] = { 0, 0 };
+  while (top > 0) {
+    --top;
+    uint32_t node = stack[top].node;
+    uint32_t pos = stack[top].pos;
+    const trie_node_t* item = &trie->nodes[node];
+    // No wildcards at the first level of $SYS topics
+    bool wildcards = !(system && (pos == 0));
+    if (wildcards) count += trieCall(trie, item->wildcard, topic, message);
+    const char* level = topic + pos;
+    const char* end = strchr(level, '/');
+    size_t len = end ? (size_t)(end - level) : strlen(level);
+    uint32_t next = end ? (uint32_t)(end - topic + 1) : TRIE_NONE;
+    uint32_t child = edgeFind(trie, node, levelHash(node, level, len), level, len);
+    uint32_t plus = wildcards ? item->plus : TRIE_NONE;
+    if (next == TRIE_NONE) {
+      // The last level: "a/b" also matches "a/b/#"
+      if (child != TRIE_NONE) count += trieCall(trie, trie->nodes[child].handlers, topic, message) + trieCall(trie, trie->nodes[child].wildcard, topic, message);
+      if (plus != TRIE_NONE) count += trieCall(trie, trie->nodes[plus].handlers, topic, message) + trieCall(trie, trie->nodes[plus].wildcard, topic, message);
+    } else if (top + 2 <= CONFIG_RSTRINGS_TRIE_MAX_LEVELS + 1) {
+      if (plus != TRIE_NONE) stack[top++] = { plus, next };
+      if (child != TRIE_NONE) stack[top++] = { child, next };
+    } else if ((plus != TRIE_NONE) || (child != TRIE_NONE)) {
+      // Not expected: subscriptions are limited to CONFIG_RSTRINGS_TRIE_MAX_LEVELS
+      rlog_w(tagTRIE, "Topic \"%s\" is deeper than %d levels, subscriptions below level %d are skipped", 
+        topic, CONFIG_RSTRINGS_TRIE_MAX_LEVELS, (int)top);
+    };
+  };
+  return count;
+}
+
+void mqttTrieGetStats(const mqtt_trie_t* trie, mqtt_trie_stats_t* stats)
+{
+  if (stats == nullptr) return;
+  memset(stats, 0, sizeof(mqtt_trie_stats_t));
+  if (trie) {
+    stats->subscriptions = trie->subscriptions;
+    stats->nodes = trie->nodeCount;
+    stats->bytes = sizeof(mqtt_trie_t)
+      + (size_t)trie->nodeCapacity * sizeof(trie_node_t)
+      + (size_t)trie->edgeCapacity * sizeof(trie_edge_t)
+      + (size_t)trie->handlerCapacity * sizeof(trie_handler_t)
+      + trie->textCapacity;
+  };
+}